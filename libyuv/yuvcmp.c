@@ -15,6 +15,7 @@
 *****************************************************************************/
 
 #include <limits.h>
+#include <stdlib.h>
 #include <string.h>
 #include <malloc.h>
 #include <stdio.h>
@@ -25,71 +26,119 @@
 #include "yuvcmp.h"
 
 
-double get_stat_psnr(dstat_t *s)
+/**
+ *  @param [in] nlsb bits of the compared samples, the peak is 2^nlsb - 1
+ */
+double get_stat_psnr(dstat_t *s, int nlsb)
 {
+    double peak = (double)((1 << nlsb) - 1);
+    
     if (s->ssd) {
-        return 10.0 * log10( (double)65025 * s->cnt / s->ssd );
+        return 10.0 * log10( peak * peak * s->cnt / s->ssd );
     } else {
         return 0;
     }
 }
 
+static void add_stat(dstat_t *dst, dstat_t *src)
+{
+    dst->cnt += src->cnt;
+    dst->sad += src->sad;
+    dst->ssd += src->ssd;
+    dst->max  = MAX(dst->max, src->max);
+}
 
+/**
+ *  @param [in] blk if not null, row @j of the plane adds to blocks 
+ *      blk[(j/bh)*nx, ...], each of @bw samples
+ */
 dstat_t b8_rect_diff(int w, int h, uint8_t *base[3], 
-                     int stride[3], dstat_t *stat)
+                     int stride[3], dstat_t *stat,
+                     int bw, int bh, int nx, dstat_t *blk)
 {
-    int i, j, k, d;
-    dstat_t st = {w*h, 0, 0};
+    int j, x;
+    uint64_t sum[3] = {0};
+    dstat_t st = {(uint64_t)w*h, 0, 0, 0};
     for (j=0; j<h; ++j) {
         uint8_t *base0 = base[0] + j * stride[0];
         uint8_t *base1 = base[1] + j * stride[1];
-        uint8_t *base2 = base[2] + j * stride[2];
-        for (i=0; i<w; ++i) {
-            d = (int)(*base0++) - (int)(*base1++);
-            d = d>0 ? d : -d;
-            (*base2++) = (uint8_t)d;
-            st.sad += d;
-            st.ssd += d*d;
+        uint8_t *base2 = base[2] ? base[2] + j * stride[2] : 0;
+        if (!blk) {
+            yuv_kern.b8_diff(base0, base1, base2, w, sum);
+            continue;
+        }
+        for (x=0; x<w; x+=bw) {
+            dstat_t *b = &blk[(j / bh) * nx + x / bw];
+            uint64_t bs[3] = {0, 0, b->max};
+            int n = MIN(bw, w - x);
+            yuv_kern.b8_diff(base0 + x, base1 + x, base2 ? base2 + x : 0, n, bs);
+            b->cnt += n;
+            b->sad += bs[0];
+            b->ssd += bs[1];
+            b->max  = bs[2];
+            sum[0] += bs[0];
+            sum[1] += bs[1];
+            sum[2]  = MAX(sum[2], bs[2]);
         }
     }
+    st.sad = sum[0];
+    st.ssd = sum[1];
+    st.max = sum[2];
     
     if (stat) {
-        stat->cnt += st.cnt;
-        stat->sad += st.sad;
-        stat->ssd += st.ssd;
+        add_stat(stat, &st);
     }
     return st;
 }
 
 dstat_t b16_rect_diff(int w, int h, uint8_t *base[3], 
-                      int stride[3], dstat_t *stat)
+                      int stride[3], dstat_t *stat,
+                      int bw, int bh, int nx, dstat_t *blk)
 {
-    int i, j, k, d;
-    dstat_t st = {w*h, 0, 0};
+    int j, x;
+    uint64_t sum[3] = {0};
+    dstat_t st = {(uint64_t)w*h, 0, 0, 0};
     for (j=0; j<h; ++j) {
         uint16_t *base0 = (uint16_t *)(base[0] + j * stride[0]);
         uint16_t *base1 = (uint16_t *)(base[1] + j * stride[1]);
-        uint16_t *base2 = (uint16_t *)(base[2] + j * stride[2]);
-        for (i=0; i<w; ++i) {
-            d = (int)(*base0++) - (int)(*base1++);
-            d = d>0 ? d : -d;
-            (*base2++) = (uint16_t)d;
-            st.sad += d;
-            st.ssd += d*d;
+        uint16_t *base2 = base[2] ? (uint16_t *)(base[2] + j * stride[2]) : 0;
+        if (!blk) {
+            yuv_kern.b16_diff(base0, base1, base2, w, sum);
+            continue;
+        }
+        for (x=0; x<w; x+=bw) {
+            dstat_t *b = &blk[(j / bh) * nx + x / bw];
+            uint64_t bs[3] = {0, 0, b->max};
+            int n = MIN(bw, w - x);
+            yuv_kern.b16_diff(base0 + x, base1 + x, base2 ? base2 + x : 0, n, bs);
+            b->cnt += n;
+            b->sad += bs[0];
+            b->ssd += bs[1];
+            b->max  = bs[2];
+            sum[0] += bs[0];
+            sum[1] += bs[1];
+            sum[2]  = MAX(sum[2], bs[2]);
         }
     }
+    st.sad = sum[0];
+    st.ssd = sum[1];
+    st.max = sum[2];
     
     if (stat) {
-        stat->cnt += st.cnt;
-        stat->sad += st.sad;
-        stat->ssd += st.ssd;
+        add_stat(stat, &st);
     }
     
     return st;
 }
 
+/**
+ *  @diff, if not null, takes the |seq1-seq2| image
+ *  @param [out] stat if not null, Y, U, V stats are added to stat[0..2]
+ *  @param [out] blk if not null, block stats are added to blk->st
+ *  @return stats of the whole frame
+ */
 dstat_t yuv_diff(yuv_seq_t *seq1, yuv_seq_t *seq2, 
-                 yuv_seq_t *diff, dstat_t *stat)
+                 yuv_seq_t *diff, dstat_t stat[3], blk_stat_t *blk)
 {
     yuv_seq_t*  seq[3] = {seq1, seq2, diff};
     uint8_t*    base[3] = {0};
@@ -98,56 +147,325 @@ dstat_t yuv_diff(yuv_seq_t *seq1, yuv_seq_t *seq2,
     int fmt = seq1->yuvfmt;
     int w   = seq1->width; 
     int h   = seq1->height;
-    int i;
+    int bw  = blk ? blk->blksz : 0;
+    int bh  = blk ? blk->blksz : 0;
+    int nx  = blk ? blk->nx : 0;
+    int i, k;
     dstat_t (*rect_diff)(int w, int h, uint8_t *base[3], 
-                         int stride[3], dstat_t *stat);
-    dstat_t st = {0};
+                         int stride[3], dstat_t *stat,
+                         int bw, int bh, int nx, dstat_t *blk);
+    dstat_t st[3] = {{0}};
+    dstat_t all   = {0};
     
     ENTER_FUNC();
     
     rect_diff = (seq1->nbit == 8) ? b8_rect_diff : b16_rect_diff;
     
-    for (i=0; i<3; ++i) {
+    for (i=0; i<2+!!diff; ++i) {
         base[i]   = seq[i]->pbuf;
         stride[i] = seq[i]->y_stride;
     }
 
     if      (fmt == YUVFMT_400P)
     {
-        rect_diff(w, h, base, stride, &st);
+        rect_diff(w, h, base, stride, &st[0], bw, bh, nx, blk ? blk->st : 0);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        rect_diff(w, h, base, stride, &st);
+        rect_diff(w, h, base, stride, &st[0], bw, bh, nx, blk ? blk->st : 0);
         
-        for (i=0; i<3; ++i) {
+        for (i=0; i<2+!!diff; ++i) {
             base[i]  += seq[i]->y_size;
             stride[i] = seq[i]->uv_stride;
         }
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (seq1);
+        h   = get_uv_height(seq1);
+        bw /= get_uv_ds_ratio_w(fmt);
+        bh /= get_uv_ds_ratio_h(fmt);
         
-        rect_diff(w, h, base, stride, &st);
+        rect_diff(w, h, base, stride, &st[1], bw, bh, nx, 
+                  blk ? blk->st + 1 * blk->nx * blk->ny : 0);
         
-        for (i=0; i<3; ++i) {
+        for (i=0; i<2+!!diff; ++i) {
             base[i]  += seq[i]->uv_size;
         }
         
-        rect_diff(w, h, base, stride, &st);
+        rect_diff(w, h, base, stride, &st[2], bw, bh, nx, 
+                  blk ? blk->st + 2 * blk->nx * blk->ny : 0);
     }
     else {
         xerr("Not support format (%d) in yuv_diff()\n", fmt);
     }
     
-    if (stat) {
-        stat->cnt += st.cnt;
-        stat->sad += st.sad;
-        stat->ssd += st.ssd;
+    for (k=0; k<3; ++k) {
+        add_stat(&all, &st[k]);
+        if (stat) {
+            add_stat(&stat[k], &st[k]);
+        }
     }
     
     LEAVE_FUNC();
     
-    return st;
+    return all;
+}
+
+/**
+ *  "name[:planes],..." with names of psnr, ssim, msssim and planes of
+ *  y, u, v letters, all planes if left out
+ *  @return -1 on unknown names or planes
+ */
+static int cmp_metric_parse(const char *list, int metric[CMP_METRIC_CNT])
+{
+    static const char *names[CMP_METRIC_CNT] = {"psnr", "ssim", "msssim"};
+    static const char planes[] = "yuv";
+    char buf[256], *item, *save = 0, *p, *c;
+    int m, mask;
+    
+    strncpy(buf, list, sizeof(buf) - 1);
+    buf[sizeof(buf) - 1] = 0;
+    memset(metric, 0, sizeof(int) * CMP_METRIC_CNT);
+    
+    for (item = strtok_r(buf, ",", &save); item; item = strtok_r(0, ",", &save)) 
+    {
+        mask = 7;
+        p = strchr(item, ':');
+        if (p) {
+            *p++ = 0;
+            for (mask=0; *p; ++p) {
+                c = strchr(planes, *p);
+                if (!c) {
+                    xerr("@cmdl>> unknown plane `%c` of metric `%s`\n", *p, item);
+                    return -1;
+                }
+                mask |= 1 << (c - planes);
+            }
+        }
+        for (m=0; m<CMP_METRIC_CNT && strcmp(item, names[m]); ++m);
+        if (m == CMP_METRIC_CNT || !mask) {
+            xerr("@cmdl>> unknown metric `%s`\n", item);
+            return -1;
+        }
+        metric[m] |= mask;
+    }
+    return 0;
+}
+
+/**
+ *  inputs compared as stored: both of one layout the mid type would 
+ *  convert, untiled, of LSB aligned samples at the compared depth; 
+ *  yuyv and the like of even width
+ */
+int is_native_cmp(yuv_seq_t *seq1, yuv_seq_t *seq2)
+{
+    int fmt = seq1->yuvfmt;
+    
+    if (fmt != seq2->yuvfmt || seq1->nbit != seq2->nbit || seq1->nlsb != seq2->nlsb ||
+        seq1->nlsb < 0 || seq1->btile || seq2->btile ||
+        (is_packed_bit(seq1->nbit) && seq1->nlsb != seq1->nbit) ||
+        fmt == YUVFMT_420SPA || fmt == YUVFMT_422SPA) {
+        return 0;
+    }
+    if (fmt == YUVFMT_V210 || is_semi_planar(fmt)) {
+        return 1;
+    }
+    if (is_mch_mixed(fmt)) {
+        return is_bit_aligned(1, seq1->width);
+    }
+    return is_packed_bit(seq1->nbit) && (fmt == YUVFMT_400P || is_mch_planar(fmt));
+}
+
+/**
+ *  a plane as stored, in rows of samples of one or more of Y, U, V
+ */
+typedef struct _cmp_rows
+{
+    int         n;          //!< samples of a row
+    int         h;          //!< rows
+    int         seg;        //!< samples of a row in a block
+    int         bh;         //!< rows of a block
+    int         map[4];     //!< sample x of a row is of plane map[x & 3]
+    
+} cmp_rows_t;
+
+/**
+ *  stored plane @k of @seq, not for v210
+ *  @param [in] blksz luma samples of a block side, 0 for no blocks
+ *  @return base of the plane in @seq, 0 past the last one
+ */
+static uint8_t *get_native_rows(yuv_seq_t *seq, int k, int blksz, 
+                                cmp_rows_t *r, int *stride)
+{
+    int fmt  = seq->yuvfmt;
+    int u    = is_uv_swapped(fmt) ? 2 : 1;
+    int v    = 3 - u;
+    int ds_w = is_mch_444(fmt) ? 1 : 2;
+    int ds_h = get_uv_ds_ratio_h(fmt);
+    int i;
+    
+    r->n   = seq->width;
+    r->h   = seq->height;
+    r->seg = blksz;
+    r->bh  = blksz;
+    *stride = seq->y_stride;
+    for (i=0; i<4; ++i) {
+        r->map[i] = 0;
+    }
+    
+    if (is_mch_mixed(fmt)) {
+        int yo = get_yuyv_yo(fmt);
+        r->n   = 4 * (seq->width / 2);
+        r->seg = 2 * blksz;
+        r->map[1 - yo] = u;
+        r->map[3 - yo] = v;
+        return k ? 0 : seq->pbuf;
+    }
+    if (k == 0) {
+        return seq->pbuf;
+    }
+    if (fmt == YUVFMT_400P || k > (is_semi_planar(fmt) ? 1 : 2)) {
+        return 0;
+    }
+    
+    r->h    = get_uv_height(seq);
+    r->bh   = blksz / ds_h;
+    *stride = seq->uv_stride;
+    if (is_semi_planar(fmt)) {
+        r->n   = get_uv_width(seq) & ~1;
+        r->seg = 2 * (blksz / ds_w);
+        r->map[0] = r->map[2] = u;
+        r->map[1] = r->map[3] = v;
+    } else {
+        r->n   = get_uv_width(seq);
+        r->seg = blksz / ds_w;
+        r->map[0] = r->map[1] = r->map[2] = r->map[3] = (k == 1) ? u : v;
+    }
+    return seq->pbuf + seq->y_size + (k - 1) * seq->uv_size;
+}
+
+/**
+ *  a row of a stored plane into @st of Y, U, V and, if @blk, into block
+ *  row @by
+ */
+static void native_row_diff(int b16, uint8_t *a, uint8_t *b, uint8_t *d, 
+                            cmp_rows_t *r, dstat_t st[3], blk_stat_t *blk, int by)
+{
+    int seg = blk ? r->seg : r->n;
+    int x, c, m;
+    
+    for (x=0; x<r->n; x+=seg) 
+    {
+        uint64_t sum[4][3] = {{0}};
+        m = MIN(seg, r->n - x);
+        if (b16) {
+            yuv_kern.b16_diff4((uint16_t *)a + x, (uint16_t *)b + x, 
+                               d ? (uint16_t *)d + x : 0, m, sum);
+        } else {
+            yuv_kern.b8_diff4(a + x, b + x, d ? d + x : 0, m, sum);
+        }
+        for (c=0; c<4; ++c) {
+            dstat_t cs = {(m - c + 3) / 4, sum[c][0], sum[c][1], sum[c][2]};
+            int     p  = r->map[(x + c) & 3];
+            add_stat(&st[p], &cs);
+            if (blk) {
+                add_stat(&blk->st[(p * blk->ny + by) * blk->nx + x / seg], &cs);
+            }
+        }
+    }
+}
+
+/**
+ *  yuv_diff() of frames of one layout as stored, see is_native_cmp(). 
+ *  Interleaved planes are split into Y, U, V stats by sample position; 
+ *  10-bit packed rows are unpacked into @tmp, and @diff rows packed back.
+ *  @param [in] tmp room of 6 * (width + 8) samples of 16 bits
+ */
+dstat_t yuv_diff_native(yuv_seq_t *seq1, yuv_seq_t *seq2, yuv_seq_t *diff, 
+                        dstat_t stat[3], blk_stat_t *blk, uint16_t *tmp)
+{
+    yuv_seq_t*  seq[3] = {seq1, seq2, diff};
+    uint8_t*    base[3] = {0};
+    uint8_t*    row[3] = {0};
+    int         stride[3] = {0};
+    
+    int nbit  = seq1->nbit;
+    int b_bn  = is_packed_bit(nbit) && seq1->yuvfmt != YUVFMT_V210;
+    int blksz = blk ? blk->blksz : 0;
+    int n_seq = 2 + !!diff;
+    int i, j, k;
+    dstat_t st[3] = {{0}};
+    dstat_t all   = {0};
+    cmp_rows_t r;
+    
+    ENTER_FUNC();
+    
+    if (seq1->yuvfmt == YUVFMT_V210)
+    {
+        int         w = seq1->width;
+        int         n_byte = sat_div(w, 6) * 16;
+        uint16_t   *p[3][3];    /* seq1, seq2, diff rows of Y, U, V */
+        cmp_rows_t  vr[3] = {
+            {w,     seq1->height, blksz,     blksz, {0, 0, 0, 0}},
+            {w / 2, seq1->height, blksz / 2, blksz, {1, 1, 1, 1}},
+            {w / 2, seq1->height, blksz / 2, blksz, {2, 2, 2, 2}},
+        };
+        
+        for (i=0; i<3; ++i) {
+            p[i][0] = tmp + i * 2 * (w + 8);
+            p[i][1] = p[i][0] + w + 4;
+            p[i][2] = p[i][1] + w / 2 + 2;
+        }
+        for (j=0; j<seq1->height; ++j) {
+            for (i=0; i<n_seq; ++i) {
+                row[i] = seq[i]->pbuf + j * seq[i]->y_stride;
+            }
+            for (i=0; i<2; ++i) {
+                yuv_kern.v210_unpack(row[i], p[i][0], p[i][1], p[i][2], w);
+            }
+            for (k=0; k<3; ++k) {
+                native_row_diff(1, (uint8_t *)p[0][k], (uint8_t *)p[1][k], 
+                                diff ? (uint8_t *)p[2][k] : 0, &vr[k], st, blk, blk ? j / blksz : 0);
+            }
+            if (diff) {
+                yuv_kern.v210_pack(row[2], p[2][0], p[2][1], p[2][2], w);
+                memset(row[2] + n_byte, 0, diff->y_stride - n_byte);
+            }
+        }
+    }
+    else for (k=0; (base[0] = get_native_rows(seq1, k, blksz, &r, &stride[0])); ++k)
+    {
+        for (i=1; i<n_seq; ++i) {
+            base[i] = get_native_rows(seq[i], k, blksz, &r, &stride[i]);
+        }
+        for (j=0; j<r.h; ++j) {
+            for (i=0; i<n_seq; ++i) {
+                row[i] = base[i] + j * stride[i];
+            }
+            if (b_bn) {
+                uint16_t *t[3] = {tmp, tmp + r.n, tmp + 2 * r.n};
+                yuv_kern.bn_unpack(row[0], stride[0], t[0], r.n, nbit);
+                yuv_kern.bn_unpack(row[1], stride[1], t[1], r.n, nbit);
+                native_row_diff(1, (uint8_t *)t[0], (uint8_t *)t[1], diff ? (uint8_t *)t[2] : 0, 
+                                &r, st, blk, blk ? j / r.bh : 0);
+                if (diff) {
+                    yuv_kern.bn_pack(row[2], stride[2], t[2], r.n, nbit);
+                }
+            } else {
+                native_row_diff(nbit > 8, row[0], row[1], row[2], 
+                                &r, st, blk, blk ? j / r.bh : 0);
+            }
+        }
+    }
+    
+    for (k=0; k<3; ++k) {
+        add_stat(&all, &st[k]);
+        if (stat) {
+            add_stat(&stat[k], &st[k]);
+        }
+    }
+    
+    LEAVE_FUNC();
+    
+    return all;
 }
 
 int cmp_arg_init (cmp_opt_t *cfg, int argc, char *argv[])
@@ -155,6 +473,7 @@ int cmp_arg_init (cmp_opt_t *cfg, int argc, char *argv[])
     set_yuv_prop(&cfg->seq[0], 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     set_yuv_prop(&cfg->seq[1], 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     set_yuv_prop(&cfg->seq[2], 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
+    cfg->metric[CMP_PSNR] = 7;
     cfg->frame_range[1] = INT_MAX;
 }
 
@@ -254,6 +573,9 @@ int cmp_arg_parse(cmp_opt_t *cfg, int argc, char *argv[])
         if (0==strcmp(arg, "b10")) {
             seq->nbit = 10;     seq->nlsb = 10;
         } else
+        if (0==strcmp(arg, "b12")) {
+            seq->nbit = 12;     seq->nlsb = 12;
+        } else
         if (0==strcmp(arg, "nbit") || 0==strcmp(arg, "b")) {
             i = arg_parse_int(i, argc, argv, &seq->nbit);
         } else
@@ -264,6 +586,33 @@ int cmp_arg_parse(cmp_opt_t *cfg, int argc, char *argv[])
             i = opt_parse_int(i, argc, argv, &seq->btile, 1);
             seq->btile ? (seq->yuvfmt = YUVFMT_420SP) : 0;
         } else
+        if (0==strcmp(arg, "tile-wxh")) {
+            i = arg_parse_wxh(i, argc, argv, &seq->tile.tw, &seq->tile.th);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-size")) {
+            i = arg_parse_int(i, argc, argv, &seq->tile.tsz);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-pad")) {
+            i = arg_parse_int(i, argc, argv, &seq->tile.pad);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-scan")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            seq->tile.scan = name ? yuv_tile_scan(name) : -1;
+            i = (seq->tile.scan < 0) ? -1 : i;
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "uv-tile-wxh")) {
+            i = arg_parse_wxh(i, argc, argv, &seq->uv_tile.tw, &seq->uv_tile.th);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "uv-tile-size")) {
+            i = arg_parse_int(i, argc, argv, &seq->uv_tile.tsz);
+            seq->btile = 1;
+        } else
         if (0==strcmp(arg, "stride")) {
             i = arg_parse_int(i, argc, argv, &seq->y_stride);
         } else
@@ -283,7 +632,50 @@ int cmp_arg_parse(cmp_opt_t *cfg, int argc, char *argv[])
             i = arg_parse_range(i, argc, argv, cfg->frame_range);
         } else
         if (0==strcmp(arg, "blksz")) {
-            i = arg_parse_range(i, argc, argv, &cfg->blksz);
+            i = arg_parse_int(i, argc, argv, &cfg->blksz);
+        } else
+        if (0==strcmp(arg, "blk-stat")) {
+            char *path;
+            i = arg_parse_str(i, argc, argv, &path);
+            ios_cfg(cfg->ios, CMP_IOS_BLK, path, "w");
+        } else
+        if (0==strcmp(arg, "metric")) {
+            char *list = 0;
+            i = arg_parse_str(i, argc, argv, &list);
+            i = (!list || cmp_metric_parse(list, cfg->metric) < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "io")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->io_mode = name ? yuv_io_mode(name) : -1;
+            i = (cfg->io_mode < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "threads") || 0==strcmp(arg, "j")) {
+            i = arg_parse_int(i, argc, argv, &cfg->n_thread);
+        } else
+        if (0==strcmp(arg, "cpu")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->cpu = name ? yuv_cpu_level(name) : -1;
+            i = (cfg->cpu < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "round")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->rnd = name ? yuv_rnd_mode(name) : -1;
+            i = (cfg->rnd < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "uv-filter")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->uv_filt = name ? yuv_uv_filt(name) : -1;
+            i = (cfg->uv_filt < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "uv-site")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->uv_site = name ? yuv_uv_site(name) : -1;
+            i = (cfg->uv_site < 0) ? -1 : i;
         } else
         if (0==strcmp(arg, "xnon")) {
             xlevel(SLOG_NON);
@@ -322,7 +714,8 @@ int cmp_arg_check(cmp_opt_t *cfg, int argc, char *argv[])
             return -1;
         }
         
-        if ((psrc->nbit!= 8 && psrc->nbit!=10 && psrc->nbit!=16) || 
+        resolve_named_fmt(psrc);
+        if ((psrc->nbit < 8 || psrc->nbit > 16) || 
             (psrc->nbit < psrc->nlsb)) {
             xerr("@cmdl>> invalid bitdepth (%d/%d) for input %d\n", 
                     psrc->nlsb, psrc->nbit, i);
@@ -343,7 +736,14 @@ int cmp_arg_check(cmp_opt_t *cfg, int argc, char *argv[])
         return -1;
     }
     
-    if (!ios_open(cfg->ios, CMP_IOS_CNT, 0)) {
+    cfg->blksz = cfg->blksz ? cfg->blksz : 16;
+    if (cfg->ios[CMP_IOS_BLK].path && 
+        (cfg->blksz < 2 || !is_bit_aligned(1, cfg->blksz))) {
+        xerr("@cmdl>> blksz %d is not even\n", cfg->blksz);
+        return -1;
+    }
+    
+    if (!yuv_ios_open(cfg->ios, CMP_IOS_CNT)) {
         ios_close(cfg->ios, CMP_IOS_CNT);
         return -1;
     }
@@ -372,6 +772,7 @@ int cmp_arg_help()
     printf("\t-wxh <%%dx%%d>\n");
     printf("\t-i0 name<%%s> {...yuv props...} \n");
     printf("\t-i1 name<%%s> {...yuv props...} \n");
+    printf("\t                     //name `-`: stdin, read in order\n");
     printf("\t ...frame range...   <%%d~%%d>\n");
 
     printf("\nset frame range as follow:\n");
@@ -379,13 +780,43 @@ int cmp_arg_help()
     printf("\t [-f-start    <%%d>]\n");
     printf("\t [-frame|-f   <%%d>]\n");
 
+    printf("\nset block stats as follow:\n");
+    printf("\t [-blk-stat name<%%s>]  //csv of frame,plane,bx,by,cnt,sad,ssd,max\n");
+    printf("\t [-blksz <%%d>]         //luma samples of a block side, even, 16 if unset\n");
+
+    printf("\nset reported metrics as follow:\n");
+    printf("\t [-metric <psnr,ssim,msssim>[:yuv],...]  //of planes y,u,v, all if unset, psnr if no -metric\n");
+
+    printf("\nset worker threads as follow:\n");
+    printf("\t [-threads|-j <%%d>]  //compare frames in parallel, logged in order\n");
+
+    printf("\nset input mode as follow:\n");
+    printf("\t [-io <stdio,mmap,pread,uring>]\n");
+
+    printf("\nset pixel kernels as follow:\n");
+    printf("\t [-cpu <auto,c,sse2,ssse3,sse41,avx2,avx512>]\n");
+
+    printf("\nset rounding of the compared depth as follow:\n");
+    printf("\t [-round <trunc,nearest,dither>]\n");
+
+    printf("\nset 420/422/444 chroma resampling of the compared format as follow:\n");
+    printf("\t [-uv-filter <nearest,bilinear,4tap>]\n");
+    printf("\t [-uv-site <center,top,bottom>]\n");
+
     printf("\n...yuv props...\n");
     printf("\t [-fmt <%%420p,%%420sp,%%uyvy,%%422p>]\n");
     printf("\t [-wxh <%%d>x<%%d>]\n");
     printf("\t [-stride <%%d>]\n");
     printf("\t [-fsize <%%d>]\n");
-    printf("\t [-b10]\n");
+    printf("\t [-b10|-b12]    //packed lte bitstream\n");
+    printf("\t [-nbit <%%d>]   //8, 16, or 9..15 packed\n");
     printf("\t [-btile]\n");
+    printf("\t [-tile-wxh <%%d>x<%%d>]\n");
+    printf("\t [-tile-size <%%d>]\n");
+    printf("\t [-tile-pad <%%d>]\n");
+    printf("\t [-tile-scan <raster,z,n>]\n");
+    printf("\t [-uv-tile-wxh <%%d>x<%%d>]\n");
+    printf("\t [-uv-tile-size <%%d>]\n");
     
     int j;
     printf("\n-wxh option can be short as follow:\n");
@@ -396,20 +827,310 @@ int cmp_arg_help()
     for (j=0; j<n_cmn_fmt; ++j) {
         printf("\t -%%%-7s = \"-fmt %d (%%%-7s)\"\n", cmn_fmt[j].name, cmn_fmt[j].val, cmn_fmt[j].name);
     }
+    printf("\t                    //v210 is 10-bit by itself; p010,p210,y210 imply\n");
+    printf("\t                    //`-nbit 16 -nlsb -10` (msb aligned), p016 `-nbit 16`\n");
     return 0;
 }
 
+/**
+ *  per worker state of the frame loop: a frame is read into a lane by the
+ *  calling thread, converted and diffed by any worker, and taken back by
+ *  the calling thread in frame order
+ */
+typedef struct _cmp_lane
+{
+    int         idx;        //!< frame index
+    cvt_plan_t  plan[3];    /* src1->mid, src2->mid, mid->diff */
+    yuv_seq_t   seq[4];     /* src1, src2, diff(mid or input type), mid type */
+    yuv_seq_t   in[2];      /* src1, src2 as read */
+    yuv_seq_t  *diff;       //!< diff frame in the output layout
+    dstat_t     stat[3];    //!< Y, U, V
+    blk_stat_t  blk;
+    ssim_pyr_t  pyr[3];     //!< Y, U, V; no scales if ssim is not taken
+    uint64_t  (*tmp)[4];    //!< ssim block rows of each band
+    sstat_t    *sst;        //!< [n_band][3][SSIM_NSCALE] of a frame
+    uint16_t   *row;        //!< 10-bit packed rows compared as stored
+    
+} cmp_lane_t;
+
+typedef struct _cmp_batch
+{
+    cmp_lane_t *lane;
+    int         b_diff;     //!< diff frames are written
+    int         b_blk;      //!< block stats are written
+    int         b_native;   //!< inputs compared as stored, see is_native_cmp()
+    int         n_band;     //!< ssim row bands of a frame, 0 if no ssim
+    int         n_tmp;      //!< ssim block row entries of a band
+    int         nlsb;       //!< of the mid type
+    
+} cmp_batch_t;
+
+/**
+ *  plane @k of a frame of the mid type
+ */
+static uint8_t *get_plane(yuv_seq_t *seq, int k, int *stride)
+{
+    *stride = k ? seq->uv_stride : seq->y_stride;
+    return seq->pbuf + (k ? seq->y_size + (k - 1) * seq->uv_size : 0);
+}
+
+static void cmp_lane_job(void *arg, int job)
+{
+    cmp_batch_t *batch = (cmp_batch_t *)arg;
+    cmp_lane_t  *lane  = &batch->lane[job];
+    yuv_seq_t   *spl[2];
+    int i, k;
+    
+    memset(lane->stat, 0, sizeof(lane->stat));
+    if (batch->b_blk) {
+        memset(lane->blk.st, 0, sizeof(dstat_t) * 3 * lane->blk.nx * lane->blk.ny);
+    }
+    if (batch->b_native) {
+        yuv_diff_native(&lane->in[0], &lane->in[1], batch->b_diff ? &lane->seq[2] : 0, 
+                        lane->stat, batch->b_blk ? &lane->blk : 0, lane->row);
+    } else {
+        for (i=0; i<2; ++i) {
+            spl[i] = cvt_plan_run(&lane->plan[i], &lane->in[i]);
+        }
+        yuv_diff(spl[0], spl[1], batch->b_diff ? &lane->seq[2] : 0, lane->stat, 
+                 batch->b_blk ? &lane->blk : 0);
+    }
+    if (batch->b_diff) {
+        lane->diff = cvt_plan_run(&lane->plan[2], &lane->seq[2]);
+    }
+    for (k=0; k<3; ++k) {
+        if (lane->pyr[k].n_scale) {
+            uint8_t *base[2];
+            int      stride[2];
+            for (i=0; i<2; ++i) {
+                base[i] = get_plane(spl[i], k, &stride[i]);
+            }
+            ssim_pyr_build(&lane->pyr[k], base, stride);
+        }
+    }
+}
+
+/**
+ *  ssim of row band (@job % n_band) of lane (@job / n_band), on the scales
+ *  cmp_lane_job() built
+ */
+static void cmp_ssim_job(void *arg, int job)
+{
+    cmp_batch_t *batch = (cmp_batch_t *)arg;
+    cmp_lane_t  *lane  = &batch->lane[job / batch->n_band];
+    int band = job % batch->n_band;
+    int k;
+    
+    for (k=0; k<3; ++k) {
+        ssim_pyr_band(&lane->pyr[k], batch->nlsb, band, batch->n_band,
+                      lane->tmp + band * batch->n_tmp, 
+                      &lane->sst[(band * 3 + k) * SSIM_NSCALE]);
+    }
+}
+
+static int cmp_lane_init(cmp_lane_t *lane, cmp_opt_t *cfg, int b_splice, cmp_batch_t *batch)
+{
+    int i, k, r = 0;
+    
+    /**
+     *  deeper samples are compared LSB aligned at the depth of input 0,
+     *  which gives the PSNR peak
+     */
+    set_yuv_prop(&lane->seq[3], 0, cfg->seq[0].width, cfg->seq[0].height, 
+            get_spl_fmt(cfg->seq[0].yuvfmt), 
+            cfg->seq[0].nbit>8 ? BIT_16 : BIT_8, 
+            cfg->seq[0].nbit>8 ? abs(cfg->seq[0].nlsb) : BIT_8, 
+            TILE_0, 0, 0);
+    lane->seq[3].rnd = cfg->rnd;
+    lane->seq[3].uv_filt = cfg->uv_filt;
+    lane->seq[3].uv_site = cfg->uv_site;
+
+    for (i=0; i<2; ++i) {
+        set_yuv_prop_by_copy(&lane->seq[i], 1, &cfg->seq[i]);
+        memcpy(&lane->in[i], &lane->seq[i], sizeof(yuv_seq_t));
+        if (!batch->b_native) {
+            r |= cvt_plan_init(&lane->plan[i], &lane->seq[3], &cfg->seq[i], 0);
+        }
+    }
+    if (cfg->ios[2].fp) {
+        set_yuv_prop_by_copy(&lane->seq[2], 1, batch->b_native ? &cfg->seq[0] : &lane->seq[3]);
+        r |= cvt_plan_init(&lane->plan[2], &cfg->seq[2], &lane->seq[2], CVT_PLAN_PAD_ON_WRITE |
+                           (b_splice ? CVT_PLAN_DOUBLE_OUT : 0));
+    }
+    if (cfg->ios[CMP_IOS_BLK].fp) {
+        lane->blk.blksz = cfg->blksz;
+        lane->blk.nx    = sat_div(cfg->seq[0].width,  cfg->blksz);
+        lane->blk.ny    = sat_div(cfg->seq[0].height, cfg->blksz);
+        lane->blk.st    = (dstat_t *)malloc(sizeof(dstat_t) * 3 * lane->blk.nx * lane->blk.ny);
+    }
+    /**
+     *  ms-ssim wants the coarser scales, ssim the frame only
+     */
+    for (k=0; k<3; ++k) {
+        int n_scale = (cfg->metric[CMP_MSSSIM] >> k & 1) ? SSIM_NSCALE : 
+                      (cfg->metric[CMP_SSIM  ] >> k & 1);
+        if (k && lane->seq[3].yuvfmt == YUVFMT_400P) {
+            n_scale = 0;
+        }
+        r |= ssim_pyr_init(&lane->pyr[k], k ? get_uv_width (&lane->seq[3]) : lane->seq[3].width,
+                           k ? get_uv_height(&lane->seq[3]) : lane->seq[3].height,
+                           lane->seq[3].nbit, n_scale);
+    }
+    if (batch->n_band) {
+        lane->tmp = (uint64_t (*)[4])malloc(sizeof(uint64_t) * 4 * batch->n_tmp * batch->n_band);
+        lane->sst = (sstat_t *)malloc(sizeof(sstat_t) * 3 * SSIM_NSCALE * batch->n_band);
+    }
+    if (batch->b_native) {
+        lane->row = (uint16_t *)malloc(sizeof(uint16_t) * 6 * (cfg->seq[0].width + 8));
+    }    if (r < 0 || !lane->seq[0].pbuf || !lane->seq[1].pbuf || 
+        (cfg->ios[2].fp && !lane->seq[2].pbuf) ||
+        (cfg->ios[CMP_IOS_BLK].fp && !lane->blk.st) ||
+        (batch->n_band && (!lane->tmp || !lane->sst)) ||
+        (batch->b_native && !lane->row)) {
+        return -1;
+    }
+    return 0;
+}
+
+static void cmp_lane_free(cmp_lane_t *lane)
+{
+    int i;
+    
+    for (i=0; i<3; ++i) {
+        cvt_plan_free(&lane->plan[i]);
+        yuv_buf_free(&lane->seq[i]);
+        ssim_pyr_free(&lane->pyr[i]);
+    }
+    free(lane->blk.st);
+    free(lane->tmp);
+    free(lane->sst);
+    free(lane->row);
+}
+
+/**
+ *  ssim and ms-ssim of the planes of a frame, the bands summed in order
+ */
+static void cmp_lane_ssim(cmp_lane_t *lane, int n_band, double ssim[3], double ms[3])
+{
+    sstat_t st[SSIM_NSCALE];
+    int b, k, s;
+    
+    for (k=0; k<3; ++k) {
+        memset(st, 0, sizeof(st));
+        for (b=0; b<n_band; ++b) {
+            for (s=0; s<lane->pyr[k].n_scale; ++s) {
+                add_sstat(&st[s], &lane->sst[(b * 3 + k) * SSIM_NSCALE + s]);
+            }
+        }
+        ssim[k] = get_stat_ssim(&st[0]);
+        ms[k]   = get_stat_msssim(st, lane->pyr[k].n_scale);
+    }
+}
+
+/**
+ *  "NAME = all, Y/U/V = y/u/v" of each metric taken on all planes, PSNR 
+ *  adding "6:1:1 = weighted"; "NAME Y/V = y/v" of some planes. For 400p
+ *  just "NAME = all". The metrics are "; " apart.
+ *  @param [in] st diff stats of Y, U, V, the counts weight ssim of all
+ */
+static const char *show_metric(char *str, int size, int metric[CMP_METRIC_CNT], 
+                               int n_plane, dstat_t st[3], double ssim[3], 
+                               double ms[3], int nlsb)
+{
+    static const char *names[CMP_METRIC_CNT] = {"PSNR", "SSIM", "MS-SSIM"};
+    int full = (1 << n_plane) - 1;
+    int m, k, n = 0, sep;
+    
+    str[0] = 0;
+    for (m=0; m<CMP_METRIC_CNT && n<size; ++m) 
+    {
+        int     mask = metric[m] & full;
+        int     prec = (m == CMP_PSNR) ? 2 : 5;
+        dstat_t all  = {0};
+        double  v[3], w = 0, a = 0;
+        
+        if (!mask) {
+            continue;
+        }
+        for (k=0; k<n_plane; ++k) {
+            add_stat(&all, &st[k]);
+            v[k] = (m == CMP_PSNR) ? get_stat_psnr(&st[k], nlsb) : 
+                   (m == CMP_SSIM) ? ssim[k] : ms[k];
+            a += v[k] * st[k].cnt;
+            w += st[k].cnt;
+        }
+        a = (m == CMP_PSNR) ? get_stat_psnr(&all, nlsb) : (w ? a / w : 0);
+        
+        n += snprintf(str + n, size - n, "%s%s", n ? "; " : "", names[m]);
+        if (mask == full) {
+            n += snprintf(str + n, MAX(size - n, 0), " = %.*f", prec, a);
+        } else {
+            for (k=0, sep=' '; k<n_plane; ++k) {
+                if (mask >> k & 1) {
+                    n += snprintf(str + n, MAX(size - n, 0), "%c%c", sep, "YUV"[k]);
+                    sep = '/';
+                }
+            }
+            n += snprintf(str + n, MAX(size - n, 0), " =");
+        }
+        if (mask == full && n_plane == 1) {
+            continue;
+        }
+        if (mask == full) {
+            n += snprintf(str + n, MAX(size - n, 0), ", Y/U/V =");
+        }
+        for (k=0, sep=' '; k<n_plane; ++k) {
+            if (mask >> k & 1) {
+                n += snprintf(str + n, MAX(size - n, 0), "%c%.*f", sep, prec, v[k]);
+                sep = '/';
+            }
+        }
+        if (mask == full && m == CMP_PSNR) {
+            n += snprintf(str + n, MAX(size - n, 0), ", 6:1:1 = %.2f", 
+                          (6 * v[0] + v[1] + v[2]) / 8);
+        }
+    }
+    return str;
+}
+
+/**
+ *  one csv line of each block, planes without samples left out
+ */
+static void blk_stat_write(FILE *fp, int idx, blk_stat_t *blk)
+{
+    dstat_t *b = blk->st;
+    int k, x, y;
+    
+    for (k=0; k<3; ++k) {
+        for (y=0; y<blk->ny; ++y) {
+            for (x=0; x<blk->nx; ++x, ++b) {
+                if (b->cnt) {
+                    fprintf(fp, "%d,%c,%d,%d,%llu,%llu,%llu,%llu\n", idx, "YUV"[k], x, y, 
+                            (unsigned long long)b->cnt, (unsigned long long)b->sad,
+                            (unsigned long long)b->ssd, (unsigned long long)b->max);
+                }
+            }
+        }
+    }
+}
+
 int yuv_cmp(int argc, char **argv)
 {
-    int         r, i, j;
+    int         r, i, j, k;
     cmp_opt_t   cfg;
-    yuv_seq_t   seq[4];
-    yuv_seq_t*  spl[2];
-    yuv_seq_t*  ptmp;
-    dstat_t     stat[2] = {{0}, {0}};
-    double      psnr = 0;
+    cmp_lane_t *lane = 0;
+    cmp_batch_t batch;
+    thr_pool_t  pool;
+    yuv_io_t    io[3];      /* src1, src2, diff */
+    dstat_t     stat[3] = {{0}};
+    double      ssim[3] = {0}, ms[3] = {0};
+    double      seq_ssim[3] = {0}, seq_ms[3] = {0};
+    char        str[512];
+    int         n_lane, n_read, n_frame = 0, i_stop, nlsb, n_plane;
+    FILE       *fblk;
     
-    memset(seq, 0, sizeof(seq));
+    memset(io, 0, sizeof(io));
+    memset(&pool, 0, sizeof(pool));
     memset(&cfg, 0, sizeof(cfg));
     cmp_arg_init (&cfg, argc, argv);
     
@@ -426,79 +1147,153 @@ int yuv_cmp(int argc, char **argv)
         // xerr("cmp_arg_check() failed\n");
         return 1;
     }
-
-    set_yuv_prop(&seq[3], 0, cfg.seq[0].width, cfg.seq[0].height, 
-            get_spl_fmt(cfg.seq[0].yuvfmt), 
-            cfg.seq[0].nbit>8 ? BIT_16 : BIT_8, 
-            cfg.seq[0].nbit>8 ? BIT_16 : BIT_8, 
-            TILE_0, 0, 0);
-    show_yuv_prop(&seq[3], SLOG_DBG, "@cfg>> mid type: ");
+    yuv_kern_init(cfg.cpu);
+    n_lane = MAX(cfg.n_thread, 1);
+    
+    /**
+     *  a batch of mapped frames is held until its last one is diffed
+     */
+    for (i=0; i<2; ++i) {
+        yuv_io_open(&io[i], cfg.ios[i].fp, cfg.io_mode, cfg.seq[i].io_size);
+        io[i].n_keep = n_lane;
+    }
+    if (cfg.ios[2].fp) {
+        yuv_io_open(&io[2], cfg.ios[2].fp, cfg.io_mode, cfg.seq[2].io_size);
+    }
+    
+    /**
+     *  ssim runs once all frames of a batch are converted, each frame in 
+     *  n_lane row bands, so a short batch still keeps the workers busy
+     */
+    batch.b_diff = !!cfg.ios[2].fp;
+    batch.b_blk  = !!cfg.ios[CMP_IOS_BLK].fp;
+    batch.n_band = (cfg.metric[CMP_SSIM] | cfg.metric[CMP_MSSSIM]) ? n_lane : 0;
+    batch.n_tmp  = 2 * (cfg.seq[0].width / 4);
+    
+    /**
+     *  ssim takes planes of the mid type, so only psnr skips converting
+     */
+    batch.b_native = !batch.n_band && is_native_cmp(&cfg.seq[0], &cfg.seq[1]);
+    
+    r = 0;
+    lane = (cmp_lane_t *)calloc(n_lane, sizeof(cmp_lane_t));
+    for (k=0; lane && k<n_lane && r==0; ++k) {
+        r = cmp_lane_init(&lane[k], &cfg, io[2].b_splice, &batch);
+    }
+    if (!lane || r < 0) {
+        xerr("@cmp>> buffer allocation failed\n");
+        r = 1;
+        goto cmp_exit;
+    }
+    if (batch.b_native) {
+        show_yuv_prop(&lane[0].seq[0], SLOG_DBG, "@cfg>> compared as stored: ");
+    } else {
+        show_yuv_prop(&lane[0].seq[3], SLOG_DBG, "@cfg>> mid type: ");
+    }
+    nlsb = lane[0].seq[3].nlsb;
+    n_plane = (lane[0].seq[3].yuvfmt == YUVFMT_400P) ? 1 : 3;
+    fblk = cfg.ios[CMP_IOS_BLK].fp;
+    if (fblk) {
+        fprintf(fblk, "frame,plane,bx,by,cnt,sad,ssd,max\n");
+    }
+    if (n_lane > 1) {
+        thr_pool_init(&pool, n_lane);
+        xlog(SLOG_CMDL, "@cfg>> ", "%d frames in parallel\n", n_lane);
+    }
+    batch.lane   = lane;
+    batch.nlsb   = nlsb;
 
     /*************************************************************************
      *                          frame loop
+     *  frames are read and diffed a batch of n_lane at a time, then logged,
+     *  summed and written in frame order, as a single lane would do
      ************************************************************************/
-    for (j=cfg.frame_range[0]; j<cfg.frame_range[1]; j++) 
+    for (j=cfg.frame_range[0]; j<cfg.frame_range[1]; j+=n_lane) 
     {
-        xdbg("@frm> **** %d ****\n", j);
-
-        for (i=0; i<2; ++i) 
+        i_stop = -1;
+        for (n_read=0; n_read<n_lane && j+n_read<cfg.frame_range[1]; ++n_read) 
         {
-            set_yuv_prop_by_copy(&seq[i], 1, &cfg.seq[i]);
-            r = fseek(cfg.ios[i].fp, seq[i].io_size * j, SEEK_SET);
-            if (r) {
-                xerr("%d: fseek %d error\n", i, seq[i].io_size * j);
-                return -1;
-            }
-            r = fread(seq[i].pbuf, seq[i].io_size, 1, cfg.ios[i].fp);
-            if (r<1) {
-                if ( ios_feof(cfg.ios, i) ) {
-                    xinfo("@seq>> $%d: reach file end, force stop\n", i);
-                } else {
-                    xerr("@seq>> $%d: error reading file\n", i);
+            cmp_lane_t *l = &lane[n_read];
+            l->idx = j + n_read;
+            for (i=0; i<2; ++i) {
+                l->in[i].pbuf = yuv_io_read(&io[i], l->idx, l->seq[i].pbuf);
+                if (!l->in[i].pbuf) {
+                    i_stop = i;
+                    break;
                 }
+            }
+            if (i_stop >= 0) {
                 break;
             }
-            
-            // get one buffer unused
-            ptmp = (i==0) ? &seq[2] : 
-                            (spl[0] == &seq[0] ? &seq[2] : &seq[0]);
-            set_yuv_prop_by_copy(ptmp, 1, &seq[3]);
-            spl[i] = yuv_cvt_frame(ptmp, &seq[i]);
         }
-        if ( ios_feof(cfg.ios, 0) || ios_feof(cfg.ios, 1) ) {
-            break;
+        
+        thr_pool_run(&pool, cmp_lane_job, &batch, n_read);
+        if (batch.n_band) {
+            thr_pool_run(&pool, cmp_ssim_job, &batch, n_read * batch.n_band);
         }
         
-        for (i=0; i<3; ++i) {
-            if (&seq[i] != spl[0] && &seq[i] != spl[1]) {
-                ptmp = &seq[i];
-                break;
+        for (k=0; k<n_read; ++k) 
+        {
+            cmp_lane_t *l = &lane[k];
+            xdbg("@frm> **** %d ****\n", l->idx);
+            
+            if (batch.n_band) {
+                cmp_lane_ssim(l, batch.n_band, ssim, ms);
+            }
+            for (i=0; i<3; ++i) {
+                add_stat(&stat[i], &l->stat[i]);
+                seq_ssim[i] += ssim[i];
+                seq_ms[i]   += ms[i];
+            }
+            ++n_frame;
+            xprint("@frm>> #%d: %s\n", l->idx, show_metric(str, sizeof(str), cfg.metric, 
+                   n_plane, l->stat, ssim, ms, nlsb));
+            if (fblk) {
+                blk_stat_write(fblk, l->idx, &l->blk);
+            }
+            
+            if (cfg.ios[2].fp) {
+                r = yuv_io_write(&io[2], l->diff, &l->plan[2].dst);
+                if (r<0) {
+                    xerr("error writing file\n");
+                    break;
+                }
             }
         }
-        set_yuv_prop_by_copy(ptmp, 1, &seq[3]);
-        stat[0] = yuv_diff(spl[0], spl[1], ptmp, &stat[1]);
-        
-        psnr = get_stat_psnr(&stat[0]);
-        xprint("@frm>> #%d: PSNR = %.2llf\n", j, psnr);
-        
-        if (cfg.ios[2].fp) {
-            set_yuv_prop_by_copy(spl[0], 1, &cfg.seq[2]);
-            yuv_seq_t* diff = yuv_cvt_frame(spl[0], ptmp);
-            r = fwrite(diff->pbuf, diff->io_size, 1, cfg.ios[2].fp);
-            if (r<1) {
-                xerr("error writing file\n");
-                break;
+        if (k < n_read) {
+            break;
+        }
+        if (i_stop >= 0) {
+            if (io[i_stop].b_eof) {
+                xinfo("@seq>> $%d: reach file end, force stop\n", i_stop);
+            } else {
+                xerr("@seq>> $%d: error reading file\n", i_stop);
             }
+            break;
         }
     }
     
-    psnr = get_stat_psnr(&stat[1]);
-    xinfo("@seq>> PSNR = %.2llf\n", psnr);
+    /**
+     *  ssim of the sequence is the mean of the frames
+     */
+    for (i=0; i<3; ++i) {
+        seq_ssim[i] /= MAX(n_frame, 1);
+        seq_ms[i]   /= MAX(n_frame, 1);
+    }
+    xinfo("@seq>> %s\n", show_metric(str, sizeof(str), cfg.metric, 
+          n_plane, stat, seq_ssim, seq_ms, nlsb));
+    r = !!(stat[0].ssd + stat[1].ssd + stat[2].ssd);
     
+cmp_exit:
+    yuv_io_close(&io[0]);
+    yuv_io_close(&io[1]);
+    yuv_io_close(&io[2]);
     cmp_arg_close(&cfg);
-    for (i=0; i<3; ++i) {
-        yuv_buf_free(&seq[i]);
+    thr_pool_free(&pool);
+    for (k=0; lane && k<n_lane; ++k) {
+        cmp_lane_free(&lane[k]);
     }
+    free(lane);
     
-    return !!stat[1].ssd;
+    return r;
 }
@@ -20,14 +20,32 @@
 
 enum cmp_ios_channel {
     CMP_IOS_DIFF = 2,
+    CMP_IOS_BLK  = 3,       //!< block stats, csv
     CMP_IOS_CNT,
 };
 
+enum cmp_metric {
+    CMP_PSNR    = 0,
+    CMP_SSIM    = 1,
+    CMP_MSSSIM  = 2,
+    CMP_METRIC_CNT,
+};
+
+#define SSIM_NSCALE     5       //!< ms-ssim scales at most
+#define SSIM_QBIT       30      //!< fixed point of the window sums
+
 typedef struct _yuv_cmp_opt
 {
-    ios_t       ios[3];
+    ios_t       ios[4];
     yuv_seq_t   seq[3];     /* src1,src2,diff */
-    int         blksz;
+    int         blksz;      //!< luma samples of a block side, for CMP_IOS_BLK
+    int         n_thread;   //!< frames compared in parallel
+    int         metric[CMP_METRIC_CNT]; //!< planes reported, bit k of plane k
+    int         io_mode;
+    int         cpu;
+    int         rnd;        //!< RND_*, for inputs deeper than compared
+    int         uv_filt;    //!< UV_FILT_*, for inputs of other chroma rows
+    int         uv_site;
     int     frame_range[2];
     
 } cmp_opt_t;
@@ -37,18 +55,73 @@ typedef struct _diff_stat
     uint64_t    cnt;
     uint64_t    sad;
     uint64_t    ssd;
+    uint64_t    max;        //!< max |error|
     
 }dstat_t;
 
+/**
+ *  stats of the blocks of a frame. Chroma blocks cover the same area as
+ *  the luma ones, so all planes share one grid.
+ */
+typedef struct _blk_stat
+{
+    int         blksz;      //!< luma samples of a block side, even
+    int         nx, ny;     //!< blocks of a row, rows of blocks
+    dstat_t    *st;         //!< [3][ny][nx] of Y, U, V
+    
+} blk_stat_t;
+
+/**
+ *  window sums of a plane at one scale, in 1/2^SSIM_QBIT
+ */
+typedef struct _ssim_stat
+{
+    int64_t     ssim;
+    int64_t     cs;         //!< contrast-structure term
+    uint64_t    cnt;        //!< 8x8 windows
+    
+} sstat_t;
+
+/**
+ *  a plane of both inputs and its 2x2 averaged scales; scale 0 refers to
+ *  the frames, the others to @buf
+ */
+typedef struct _ssim_pyr
+{
+    int         nbit;       //!< 8, or 16 of samples in 16 bits
+    int         n_scale;
+    int         w[SSIM_NSCALE], h[SSIM_NSCALE];
+    int         stride[SSIM_NSCALE][2];
+    uint8_t    *base[SSIM_NSCALE][2];
+    uint8_t    *buf;
+    
+} ssim_pyr_t;
+
+double get_stat_psnr(dstat_t *s, int nlsb);
+double get_stat_ssim(sstat_t *s);
+double get_stat_msssim(sstat_t *s, int n_scale);
+void   add_sstat(sstat_t *dst, sstat_t *src);
+
+int  ssim_pyr_init (ssim_pyr_t *p, int w, int h, int nbit, int n_scale);
+void ssim_pyr_free (ssim_pyr_t *p);
+void ssim_pyr_build(ssim_pyr_t *p, uint8_t *base[2], int stride[2]);
+void ssim_pyr_band (ssim_pyr_t *p, int nlsb, int band, int n_band,
+                    uint64_t (*tmp)[4], sstat_t st[SSIM_NSCALE]);
 
 dstat_t b8_rect_diff(int w, int h, uint8_t *base[3], 
-                     int stride[3], dstat_t *stat);
+                     int stride[3], dstat_t *stat,
+                     int bw, int bh, int nx, dstat_t *blk);
                      
 dstat_t b16_rect_diff(int w, int h, uint8_t *base[3], 
-                      int stride[3], dstat_t *stat);
+                      int stride[3], dstat_t *stat,
+                      int bw, int bh, int nx, dstat_t *blk);
                       
 dstat_t yuv_diff(yuv_seq_t *seq1, yuv_seq_t *seq2, 
-                 yuv_seq_t *diff, dstat_t *stat);
+                 yuv_seq_t *diff, dstat_t stat[3], blk_stat_t *blk);
+
+int is_native_cmp(yuv_seq_t *seq1, yuv_seq_t *seq2);
+dstat_t yuv_diff_native(yuv_seq_t *seq1, yuv_seq_t *seq2, yuv_seq_t *diff, 
+                        dstat_t stat[3], blk_stat_t *blk, uint16_t *tmp);
                  
 int cmp_arg_init (cmp_opt_t *cfg, int argc, char *argv[]);
 int cmp_arg_parse(cmp_opt_t *cfg, int argc, char *argv[]);
@@ -0,0 +1,232 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcmp_ssim.c
+ *  @brief SSIM of 8x8 windows stepped by 4, and MS-SSIM over 2x2 averaged
+ *      scales. The integer sums of each 4x4 block come from yuv_kern and
+ *      are shared by the four windows covering it; a window then takes
+ *      its ratios in double, summed in SSIM_QBIT fixed point so a plane
+ *      gives the same result in any number of row bands.
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+#include "yuvcmp.h"
+
+/**
+ *  scale weights of Wang et al.; fewer scales take the first ones,
+ *  renormalized
+ */
+static const double msssim_w[SSIM_NSCALE] = {
+    0.0448, 0.2856, 0.3001, 0.2363, 0.1333,
+};
+
+static void b8_half(uint8_t *dst, int w, int h, uint8_t *src, int s)
+{
+    int x, y;
+    for (y=0; y<h; ++y, dst+=w, src+=2*s) {
+        uint8_t *r0 = src;
+        uint8_t *r1 = src + s;
+        for (x=0; x<w; ++x) {
+            dst[x] = (uint8_t)((r0[2*x] + r0[2*x+1] + r1[2*x] + r1[2*x+1] + 2) >> 2);
+        }
+    }
+}
+
+static void b16_half(uint16_t *dst, int w, int h, uint16_t *src, int s)
+{
+    int x, y;
+    for (y=0; y<h; ++y, dst+=w, src=(uint16_t *)((uint8_t *)src + 2*s)) {
+        uint16_t *r0 = src;
+        uint16_t *r1 = (uint16_t *)((uint8_t *)src + s);
+        for (x=0; x<w; ++x) {
+            dst[x] = (uint16_t)((r0[2*x] + r0[2*x+1] + r1[2*x] + r1[2*x+1] + 2) >> 2);
+        }
+    }
+}
+
+/**
+ *  @param [in] n_scale scales wanted, kept while a scale holds a window
+ *  @return -1 if the scales are not allocated
+ */
+int ssim_pyr_init(ssim_pyr_t *p, int w, int h, int nbit, int n_scale)
+{
+    int k, size = 0;
+    int nbyte = (nbit > 8) ? 2 : 1;
+
+    memset(p, 0, sizeof(ssim_pyr_t));
+    p->nbit = nbit;
+    for (k=0; k<n_scale && w>=8 && h>=8; ++k, w/=2, h/=2) {
+        p->w[k] = w;
+        p->h[k] = h;
+        p->stride[k][0] = p->stride[k][1] = w * nbyte;
+        size += k ? 2 * w * h * nbyte : 0;
+    }
+    p->n_scale = k;
+
+    if (size) {
+        p->buf = (uint8_t *)malloc(size);
+        if (!p->buf) {
+            return -1;
+        }
+    }
+    for (k=1, size=0; k<p->n_scale; ++k) {
+        p->base[k][0] = p->buf + size;
+        p->base[k][1] = p->buf + size + p->w[k] * p->h[k] * nbyte;
+        size += 2 * p->w[k] * p->h[k] * nbyte;
+    }
+    return 0;
+}
+
+void ssim_pyr_free(ssim_pyr_t *p)
+{
+    free(p->buf);
+    p->buf = 0;
+}
+
+/**
+ *  scale 0 takes the planes of both inputs, the others are averaged down
+ */
+void ssim_pyr_build(ssim_pyr_t *p, uint8_t *base[2], int stride[2])
+{
+    int i, k;
+
+    for (i=0; i<2; ++i) {
+        p->base[0][i]   = base[i];
+        p->stride[0][i] = stride[i];
+        for (k=1; k<p->n_scale; ++k) {
+            if (p->nbit > 8) {
+                b16_half((uint16_t *)p->base[k][i], p->w[k], p->h[k],
+                         (uint16_t *)p->base[k-1][i], p->stride[k-1][i]);
+            } else {
+                b8_half(p->base[k][i], p->w[k], p->h[k],
+                        p->base[k-1][i], p->stride[k-1][i]);
+            }
+        }
+    }
+}
+
+/**
+ *  4x4 block sums of block row @y of scale @k
+ */
+static void ssim_blk_row(ssim_pyr_t *p, int k, int y, uint64_t (*s)[4])
+{
+    uint8_t *a = p->base[k][0] + 4 * y * p->stride[k][0];
+    uint8_t *b = p->base[k][1] + 4 * y * p->stride[k][1];
+
+    if (p->nbit > 8) {
+        yuv_kern.b16_ssim_4x4((uint16_t *)a, p->stride[k][0],
+                              (uint16_t *)b, p->stride[k][1], p->w[k] / 4, s);
+    } else {
+        yuv_kern.b8_ssim_4x4(a, p->stride[k][0], b, p->stride[k][1], p->w[k] / 4, s);
+    }
+}
+
+/**
+ *  windows of band @band out of @n_band, split by window rows, of each
+ *  scale into st[0..n_scale)
+ *  @param [in] nlsb bits of the samples, giving the constants
+ *  @param [in] tmp room of 2 block rows of scale 0, 2*(w/4) entries
+ */
+void ssim_pyr_band(ssim_pyr_t *p, int nlsb, int band, int n_band,
+                   uint64_t (*tmp)[4], sstat_t st[SSIM_NSCALE])
+{
+    double peak = (double)((1 << nlsb) - 1);
+    double c1 = 64 * 64 * (.01 * peak) * (.01 * peak);
+    double c2 = 64 * 64 * (.03 * peak) * (.03 * peak);
+    int k, x, y;
+
+    for (k=0; k<p->n_scale; ++k)
+    {
+        int nb = p->w[k] / 4;
+        int nr = p->h[k] / 4 - 1;
+        int y0 = nr * band / n_band;
+        int y1 = nr * (band + 1) / n_band;
+        uint64_t (*row[2])[4];
+
+        memset(&st[k], 0, sizeof(sstat_t));
+        if (y0 >= y1) {
+            continue;
+        }
+
+        ssim_blk_row(p, k, y0, tmp + (y0 & 1) * nb);
+        for (y=y0; y<y1; ++y) {
+            row[0] = tmp + ( y    & 1) * nb;
+            row[1] = tmp + ((y+1) & 1) * nb;
+            ssim_blk_row(p, k, y+1, row[1]);
+
+            for (x=0; x+1<nb; ++x) {
+                double s1  = (double)(row[0][x][0] + row[0][x+1][0] + row[1][x][0] + row[1][x+1][0]);
+                double s2  = (double)(row[0][x][1] + row[0][x+1][1] + row[1][x][1] + row[1][x+1][1]);
+                double ss  = (double)(row[0][x][2] + row[0][x+1][2] + row[1][x][2] + row[1][x+1][2]);
+                double s12 = (double)(row[0][x][3] + row[0][x+1][3] + row[1][x][3] + row[1][x+1][3]);
+                double vars  = 64 * ss  - s1 * s1 - s2 * s2;
+                double covar = 64 * s12 - s1 * s2;
+                double cs    = (2 * covar + c2) / (vars + c2);
+                double ssim  = cs * (2 * s1 * s2 + c1) / (s1 * s1 + s2 * s2 + c1);
+
+                st[k].cs   += llrint(cs   * (1 << SSIM_QBIT));
+                st[k].ssim += llrint(ssim * (1 << SSIM_QBIT));
+            }
+            st[k].cnt += nb - 1;
+        }
+    }
+}
+
+void add_sstat(sstat_t *dst, sstat_t *src)
+{
+    dst->ssim += src->ssim;
+    dst->cs   += src->cs;
+    dst->cnt  += src->cnt;
+}
+
+double get_stat_ssim(sstat_t *s)
+{
+    if (s->cnt) {
+        return (double)s->ssim / s->cnt / (1 << SSIM_QBIT);
+    } else {
+        return 0;
+    }
+}
+
+/**
+ *  contrast-structure of the finer scales, full SSIM of the coarsest; a
+ *  negative term counts as 0
+ */
+double get_stat_msssim(sstat_t *s, int n_scale)
+{
+    double wsum = 0, ms = 1, v;
+    int k;
+
+    if (!n_scale || !s[0].cnt) {
+        return 0;
+    }
+    for (k=0; k<n_scale; ++k) {
+        wsum += msssim_w[k];
+    }
+    for (k=0; k<n_scale; ++k) {
+        v  = (k+1 < n_scale) ? (double)s[k].cs / s[k].cnt / (1 << SSIM_QBIT)
+                             : get_stat_ssim(&s[k]);
+        ms *= pow(MAX(v, 0), msssim_w[k] / wsum);
+    }
+    return ms;
+}
@@ -50,6 +50,18 @@ const opt_enum_t cmn_fmt[] = {
     {"422spa",  YUVFMT_422SPA   },
     {"uyvy",    YUVFMT_UYVY     },
     {"yuyv",    YUVFMT_YUYV     },
+    {"444p",    YUVFMT_444P     },
+    {"444sp",   YUVFMT_444SP    },
+    {"yv12",    YUVFMT_YV12     },
+    {"nv21",    YUVFMT_NV21     },
+    {"nv61",    YUVFMT_NV61     },
+    {"yvyu",    YUVFMT_YVYU     },
+    {"vyuy",    YUVFMT_VYUY     },
+    {"v210",    YUVFMT_V210     },
+    {"p010",    YUVFMT_P010     },
+    {"p210",    YUVFMT_P210     },
+    {"p016",    YUVFMT_P016     },
+    {"y210",    YUVFMT_Y210     },
 };
 
 const int n_cmn_res = ARRAY_SIZE(cmn_res);
@@ -158,8 +170,8 @@ int b8_mch_p2p(yuv_seq_t *pdst, yuv_seq_t *psrc)
     show_yuv_prop(pdst, SLOG_DBG, "dst ");
     
     assert((psrc->nbit==8 && pdst->nbit==8) || (psrc->nbit==16 && pdst->nbit==16));
-    assert(is_mch_planar(src_fmt));
-    assert(is_mch_planar(dst_fmt));
+    assert(is_mch_planar(src_fmt) || is_mono_planar(src_fmt));
+    assert(is_mch_planar(dst_fmt) || is_mono_planar(dst_fmt));
     
     for (y=0; y<h; ++y) {
         memcpy(dst_y, src_y, linesize);
@@ -178,16 +190,16 @@ int b8_mch_p2p(yuv_seq_t *pdst, yuv_seq_t *psrc)
         memcpy(dst_u, src_u, linesize);
         memcpy(dst_v, src_v, linesize);
         
+        if (dst_uv_shift>0) 
+        {
+            memcpy(dst_u + dst_uv_shift, src_u, linesize);
+            memcpy(dst_v + dst_uv_shift, src_v, linesize);
+        }
+        
         dst_u += pdst->uv_stride + dst_uv_shift;
         src_u += psrc->uv_stride + src_uv_shift;
         dst_v += pdst->uv_stride + dst_uv_shift;
         src_v += psrc->uv_stride + src_uv_shift;
-        
-        if (dst_uv_shift>0) 
-        {
-            memcpy(dst_u + dst_uv_shift, src_u + src_uv_shift, linesize);
-            memcpy(dst_v + dst_uv_shift, src_v + src_uv_shift, linesize);
-        }
     }
     
     LEAVE_FUNC();
@@ -201,33 +213,41 @@ int b8_mch_p2p(yuv_seq_t *pdst, yuv_seq_t *psrc)
  */
 int b8_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
 {
-    int fmt = itl->yuvfmt;
-    
     uint8_t* itl_y_base = itl->pbuf;
     uint8_t* itl_u_base = itl_y_base + itl->y_size;
     
     uint8_t* spl_y_base = spl->pbuf;
-    uint8_t* spl_u_base = spl_y_base + spl->y_size;
-    uint8_t* spl_v_base = spl_u_base + spl->uv_size;
+    uint8_t* spl_u_base;
+    uint8_t* spl_v_base;
     
     int w   = itl->width; 
     int h   = itl->height; 
-    int x, y;
+    int y;
 
     ENTER_FUNC();
     
     assert(itl->nbit==8 && spl->nbit==8);
     assert(is_semi_planar(itl->yuvfmt));
     assert(is_mch_planar(spl->yuvfmt));
+    assert(get_spl_fmt(itl->yuvfmt) == get_spl_fmt(spl->yuvfmt));
+    
+    get_uv_planes(spl, &spl_u_base, &spl_v_base);
+    if (is_uv_swapped(itl->yuvfmt)) {
+        swap_uv(&spl_u_base, &spl_v_base);
+    }
     
     for (y=0; y<h; ++y) {
         uint8_t* itl_y = itl_y_base + y * itl->y_stride;
         uint8_t* spl_y = spl_y_base + y * spl->y_stride;
-        memcpy(spl_y, itl_y, w);
+        if (b_interlacing == INTERLACING) {
+            memcpy(itl_y, spl_y, w);
+        } else {
+            memcpy(spl_y, itl_y, w);
+        }
     }
 
-    w   = w/2;
-    h   = is_mch_422(fmt) ? h : h/2;
+    w   = get_uv_width (spl);
+    h   = get_uv_height(spl);
     
     for (y=0; y<h; ++y) {
         uint8_t* itl_u = itl_u_base + y * itl->uv_stride;
@@ -235,15 +255,9 @@ int b8_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
         uint8_t* spl_v = spl_v_base + y * spl->uv_stride;
 
         if (b_interlacing == INTERLACING) {
-            for (x=0; x<w; ++x) {
-                *(itl_u++) = *(spl_u++);
-                *(itl_u++) = *(spl_v++);
-            }
+            yuv_kern.b8_uv_merge(itl_u, spl_u, spl_v, w);
         } else {
-            for (x=0; x<w; ++x) {
-                *(spl_u++) = *(itl_u++);
-                *(spl_v++) = *(itl_u++);
-            }
+            yuv_kern.b8_uv_split(spl_u, spl_v, itl_u, w);
         }
     }
     
@@ -253,7 +267,7 @@ int b8_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
 }
 
 /**
- *  @itl : luma & chroma is interlaced (here uyvy or yuyv)
+ *  @itl : luma & chroma is interlaced (yuyv, uyvy, yvyu or vyuy)
  *  @spl : luma & chroma is splitted
  */
 int b8_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
@@ -261,12 +275,13 @@ int b8_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
     uint8_t* itl_y_base = itl->pbuf;
     
     uint8_t* spl_y_base = spl->pbuf;
-    uint8_t* spl_u_base = spl_y_base + spl->y_size;
-    uint8_t* spl_v_base = spl_u_base + spl->uv_size;
+    uint8_t* spl_u_base;
+    uint8_t* spl_v_base;
 
     int w   = itl->width; 
     int h   = itl->height; 
-    int x, y;
+    int yo  = get_yuyv_yo(itl->yuvfmt);
+    int y;
 
     ENTER_FUNC();
     show_yuv_prop(itl, SLOG_DBG, "itl ");
@@ -274,7 +289,12 @@ int b8_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
     
     assert(itl->nbit==8 && spl->nbit==8);
     assert(is_mch_mixed(itl->yuvfmt));
-    assert(is_mch_planar(spl->yuvfmt));
+    assert(spl->yuvfmt == YUVFMT_422P);
+    
+    get_uv_planes(spl, &spl_u_base, &spl_v_base);
+    if (is_uv_swapped(itl->yuvfmt)) {
+        swap_uv(&spl_u_base, &spl_v_base);
+    }
 
     w   = w/2;
 
@@ -286,37 +306,9 @@ int b8_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
         uint8_t* spl_v  = spl_v_base + y * spl->uv_stride;
 
         if (b_interlacing == INTERLACING) {
-            if (itl->yuvfmt == YUVFMT_YUYV) {
-                for (x=0; x<w; ++x) {
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_u++);
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_v++);
-                }
-            } else {
-                for (x=0; x<w; ++x) {
-                    *(itl_y++) = *(spl_u++);
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_v++);
-                    *(itl_y++) = *(spl_y++);
-                }
-            }
+            yuv_kern.b8_yuyv_merge(itl_y, spl_y, spl_u, spl_v, w, yo);
         } else {
-            if (itl->yuvfmt == YUVFMT_YUYV) {
-                for (x=0; x<w; ++x) {
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_u++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_v++) = *(itl_y++);
-                }
-            } else {
-                for (x=0; x<w; ++x) {
-                    *(spl_u++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_v++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                }
-            }
+            yuv_kern.b8_yuyv_split(spl_y, spl_u, spl_v, itl_y, w, yo);
         }
     }   /* end for y*/
 
@@ -336,33 +328,41 @@ int b16_mch_p2p(yuv_seq_t *pdst, yuv_seq_t *psrc)
  */
 int b16_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
 {
-    int fmt = itl->yuvfmt;
-    
     uint8_t* itl_y_base = itl->pbuf;
     uint8_t* itl_u_base = itl_y_base + itl->y_size;
     
     uint8_t* spl_y_base = spl->pbuf;
-    uint8_t* spl_u_base = spl_y_base + spl->y_size;
-    uint8_t* spl_v_base = spl_u_base + spl->uv_size;
+    uint8_t* spl_u_base;
+    uint8_t* spl_v_base;
     
     int w   = itl->width; 
     int h   = itl->height; 
-    int x, y;
+    int y;
 
     ENTER_FUNC();
     
     assert(itl->nbit==16 && spl->nbit==16);
     assert(is_semi_planar(itl->yuvfmt));
     assert(is_mch_planar(spl->yuvfmt));
+    assert(get_spl_fmt(itl->yuvfmt) == get_spl_fmt(spl->yuvfmt));
+    
+    get_uv_planes(spl, &spl_u_base, &spl_v_base);
+    if (is_uv_swapped(itl->yuvfmt)) {
+        swap_uv(&spl_u_base, &spl_v_base);
+    }
     
     for (y=0; y<h; ++y) {
         uint16_t* itl_y = (uint16_t*)(itl_y_base + y * itl->y_stride);
         uint16_t* spl_y = (uint16_t*)(spl_y_base + y * spl->y_stride);
-        memcpy(spl_y, itl_y, w*sizeof(uint16_t));
+        if (b_interlacing == INTERLACING) {
+            memcpy(itl_y, spl_y, w*sizeof(uint16_t));
+        } else {
+            memcpy(spl_y, itl_y, w*sizeof(uint16_t));
+        }
     }
 
-    w   = w/2;
-    h   = is_mch_422(fmt) ? h : h/2;
+    w   = get_uv_width (spl);
+    h   = get_uv_height(spl);
     
     for (y=0; y<h; ++y) {
         uint16_t* itl_u = (uint16_t*)(itl_u_base + y * itl->uv_stride);
@@ -370,15 +370,9 @@ int b16_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
         uint16_t* spl_v = (uint16_t*)(spl_v_base + y * spl->uv_stride);
 
         if (b_interlacing == INTERLACING) {
-            for (x=0; x<w; ++x) {
-                *(itl_u++) = *(spl_u++);
-                *(itl_u++) = *(spl_v++);
-            }
+            yuv_kern.b16_uv_merge(itl_u, spl_u, spl_v, w);
         } else {
-            for (x=0; x<w; ++x) {
-                *(spl_u++) = *(itl_u++);
-                *(spl_v++) = *(itl_u++);
-            }
+            yuv_kern.b16_uv_split(spl_u, spl_v, itl_u, w);
         }
     }
     
@@ -388,7 +382,7 @@ int b16_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
 }
 
 /**
- *  @itl : luma & chroma is interlaced (here uyvy or yuyv)
+ *  @itl : luma & chroma is interlaced (yuyv, uyvy, yvyu or vyuy)
  *  @spl : luma & chroma is splitted
  */
 int b16_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
@@ -396,18 +390,24 @@ int b16_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
     uint8_t* itl_y_base = itl->pbuf;
     
     uint8_t* spl_y_base = spl->pbuf;
-    uint8_t* spl_u_base = spl_y_base + spl->y_size;
-    uint8_t* spl_v_base = spl_u_base + spl->uv_size;
+    uint8_t* spl_u_base;
+    uint8_t* spl_v_base;
 
     int w   = itl->width; 
     int h   = itl->height; 
-    int x, y;
+    int yo  = get_yuyv_yo(itl->yuvfmt);
+    int y;
 
     ENTER_FUNC();
     
     assert(itl->nbit==16 && spl->nbit==16);
     assert(is_mch_mixed(itl->yuvfmt));
-    assert(is_mch_planar(spl->yuvfmt));
+    assert(spl->yuvfmt == YUVFMT_422P);
+    
+    get_uv_planes(spl, &spl_u_base, &spl_v_base);
+    if (is_uv_swapped(itl->yuvfmt)) {
+        swap_uv(&spl_u_base, &spl_v_base);
+    }
 
     w   = w/2;
 
@@ -419,37 +419,9 @@ int b16_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
         uint16_t* spl_v = (uint16_t*)(spl_v_base + y * spl->uv_stride);
 
         if (b_interlacing == INTERLACING) {
-            if (itl->yuvfmt == YUVFMT_YUYV) {
-                for (x=0; x<w; ++x) {
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_u++);
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_v++);
-                }
-            } else {
-                for (x=0; x<w; ++x) {
-                    *(itl_y++) = *(spl_u++);
-                    *(itl_y++) = *(spl_y++);
-                    *(itl_y++) = *(spl_v++);
-                    *(itl_y++) = *(spl_y++);
-                }
-            }
+            yuv_kern.b16_yuyv_merge(itl_y, spl_y, spl_u, spl_v, w, yo);
         } else {
-            if (itl->yuvfmt == YUVFMT_YUYV) {
-                for (x=0; x<w; ++x) {
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_u++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_v++) = *(itl_y++);
-                }
-            } else {
-                for (x=0; x<w; ++x) {
-                    *(spl_u++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                    *(spl_v++) = *(itl_y++);
-                    *(spl_y++) = *(itl_y++);
-                }
-            }
+            yuv_kern.b16_yuyv_split(spl_y, spl_u, spl_v, itl_y, w, yo);
         }
     }   /* end for y*/
 
@@ -458,34 +430,163 @@ int b16_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing)
     return 0;
 }
 
+/**
+ *  sample positions of (y0, u, y1, v) in a group of yuyv, uyvy, yvyu, vyuy;
+ *  the first two also stand for (u0, v0, u1, v1) of uv and vu interleaved
+ */
+static const uint8_t grp_pos[4][4] = {
+    {0, 1, 2, 3}, {1, 0, 3, 2}, {0, 3, 2, 1}, {1, 2, 3, 0},
+};
+
+/**
+ *  @brief shuffle of yuv_kern_t.b8_shuf4 taking @src_fmt rows to @dst_fmt, 
+ *      for formats of the same layout and sampling: mixed among each 
+ *      other, or semi-planar of other uv order
+ *  @return 1 if @perm is set, 0 if the formats differ in more
+ */
+int get_uv_shuf4(int dst_fmt, int src_fmt, uint8_t perm[4])
+{
+    const uint8_t *d, *s;
+    int k;
+    
+    if (is_mch_mixed(dst_fmt) && is_mch_mixed(src_fmt)) {
+        d = grp_pos[get_yuyv_yo(dst_fmt) + 2 * is_uv_swapped(dst_fmt)];
+        s = grp_pos[get_yuyv_yo(src_fmt) + 2 * is_uv_swapped(src_fmt)];
+    } else if (is_semi_planar(dst_fmt) && is_semi_planar(src_fmt) 
+            && get_spl_fmt(dst_fmt) == get_spl_fmt(src_fmt)
+            && dst_fmt != YUVFMT_420SPA && dst_fmt != YUVFMT_422SPA
+            && src_fmt != YUVFMT_420SPA && src_fmt != YUVFMT_422SPA) {
+        d = grp_pos[is_uv_swapped(dst_fmt)];
+        s = grp_pos[is_uv_swapped(src_fmt)];
+    } else {
+        return 0;
+    }
+    
+    for (k=0; k<4; ++k) {
+        perm[d[k]] = s[k];
+    }
+    return 1;
+}
+
+/**
+ *  @brief yuyv <-> uyvy/yvyu/vyuy, or nv12 <-> nv21 (422sp <-> nv61),
+ *      a shuffle of every row in 4-sample groups
+ */
+int yuv_uv_reorder(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* src = psrc->pbuf;
+    uint8_t* dst = pdst->pbuf;
+    uint8_t  perm[4];
+    int src_stride = psrc->y_stride;
+    int dst_stride = pdst->y_stride;
+    int w   = 2 * psrc->width;
+    int h   = psrc->height;
+    int y;
+    
+    ENTER_FUNC();
+    
+    assert(psrc->nbit == pdst->nbit && (psrc->nbit == 8 || psrc->nbit == 16));
+    assert(psrc->width == pdst->width && psrc->height == pdst->height);
+    
+    if (!get_uv_shuf4(pdst->yuvfmt, psrc->yuvfmt, perm)) {
+        xerr("%s(): no reorder of %s to %s\n", __FUNCTION__, 
+             show_fmt(psrc->yuvfmt), show_fmt(pdst->yuvfmt));
+        return -1;
+    }
+    
+    if (is_semi_planar(psrc->yuvfmt)) 
+    {
+        yuv_copy_rect(psrc->width * psrc->nbit / 8, h, 
+                dst, dst_stride, src, src_stride);
+        
+        src += psrc->y_size;
+        dst += pdst->y_size;
+        src_stride = psrc->uv_stride;
+        dst_stride = pdst->uv_stride;
+        w   = get_uv_width (psrc);
+        h   = get_uv_height(psrc);
+    }
+    
+    for (y=0; y<h; ++y) 
+    {
+        if (psrc->nbit == 8) {
+            yuv_kern.b8_shuf4(dst + y * dst_stride, src + y * src_stride, w, perm);
+        } else {
+            yuv_kern.b16_shuf4((uint16_t*)(dst + y * dst_stride), 
+                               (uint16_t*)(src + y * src_stride), w, perm);
+        }
+    }
+    
+    LEAVE_FUNC();
+    
+    return 0;
+}
+
+/**
+ *  4x4 ordered dither, the threshold of (x,y) is (2*b+1)/32 of a step
+ */
+static const uint8_t bayer4[4][4] = {
+    { 0,  8,  2, 10},
+    {12,  4, 14,  6},
+    { 3, 11,  1,  9},
+    {15,  7, 13,  5},
+};
+
+/**
+ *  @brief bias row of yuv_kern_t.b16_to_b8/b16_shift to drop @rshift bits 
+ *      of row @y as @rnd says
+ */
+void get_rnd_bias(uint16_t bias[4], int rnd, int rshift, int y)
+{
+    int x;
+    for (x=0; x<4; ++x) {
+        if (rshift <= 0 || rnd == RND_TRUNC) {
+            bias[x] = 0;
+        } else if (rnd == RND_NEAREST) {
+            bias[x] = 1 << (rshift-1);
+        } else {
+            bias[x] = ((2*bayer4[y&3][x] + 1) << rshift) >> 5;
+        }
+    }
+}
+
+/**
+ *  @param [in] lshift, rshift see yuv_kern_t.b16_shift
+ */
 int b16_rect_scale
 (
-    int w, int h, int lshift,
+    int w, int h, int lshift, int rshift, int rnd,
     void* src_base, int src_stride,
     void* dst_base, int dst_stride
 )
 {
-    int x, y;
-    int rshift = -lshift;
+    uint16_t bias[4];
+    int y;
     
     for (y=0; y<h; ++y) 
     {
         uint16_t* src = (uint16_t*)((uint8_t*)src_base + y * src_stride);
         uint16_t* dst = (uint16_t*)((uint8_t*)dst_base + y * dst_stride);
         
-        if (lshift > 0) {
-            for (x=0; x<w; ++x) {
-                *dst++ = *src++ << lshift;
-            }
-        } else {
-            for (x=0; x<w; ++x) {
-                *dst++ = *src++ >> rshift;
-            }
-        }
+        get_rnd_bias(bias, rnd, rshift, y);
+        yuv_kern.b16_shift(dst, src, w, lshift, rshift, bias);
     }
     return 0;
 }
 
+/**
+ *  @brief shifts of yuv_kern_t.b16_shift from @src_nlsb to @dst_nlsb valid
+ *      bits; widening is a plain shift, narrowing rounds from the msb
+ */
+void get_b16_scale(int dst_nlsb, int src_nlsb, int *lshift, int *rshift)
+{
+    int sl = (src_nlsb > 0) ? src_nlsb : 16;
+    int dl = (dst_nlsb > 0) ? dst_nlsb : 16;
+    
+    *lshift = (dl >= sl) ? (dl - sl) : (16 - sl);
+    *rshift = (dl >= sl) ? 0         : (16 - dl);
+}
+
 int b16_mch_scale(yuv_seq_t *pdst, yuv_seq_t *psrc)
 {
     uint8_t* src_base = psrc->pbuf;
@@ -498,57 +599,56 @@ int b16_mch_scale(yuv_seq_t *pdst, yuv_seq_t *psrc)
     int h   = psrc->height; 
     int x, y;
     
-    int lshift = (psrc->nlsb > 0) ? (16 - psrc->nlsb) : 0;
-    int rshift = (pdst->nlsb > 0) ? (16 - pdst->nlsb) : 0;
-    lshift -= rshift;
+    int rnd    = pdst->rnd;
+    int lshift, rshift;
     
     ENTER_FUNC();
     
+    get_b16_scale(pdst->nlsb, psrc->nlsb, &lshift, &rshift);
+    
     assert(psrc->nbit==16 && pdst->nbit==16);
     assert(psrc->nlsb!=0  && pdst->nlsb!=0 );
-    assert(psrc->yuvfmt   == pdst->yuvfmt  );
+    assert(psrc->yuvfmt   == pdst->yuvfmt  || is_planar_swap(pdst->yuvfmt, psrc->yuvfmt));
     assert(psrc->width    == pdst->width   );
     assert(psrc->height   == pdst->height  );
 
     if      (fmt == YUVFMT_400P)
     {
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_base, src_stride, dst_base, dst_stride);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        uint8_t *src_u, *src_v, *dst_u, *dst_v;
         
-        src_base   += psrc->y_size;
-        dst_base   += pdst->y_size; 
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_base, src_stride, dst_base, dst_stride);
+        
+        get_uv_planes(psrc, &src_u, &src_v);
+        get_uv_planes(pdst, &dst_u, &dst_v);
         src_stride  = psrc->uv_stride;
         dst_stride  = pdst->uv_stride;
+        w   = get_uv_width (psrc);
+        h   = get_uv_height(psrc);
         
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
-        
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
-        
-        src_base   += psrc->uv_size;
-        dst_base   += pdst->uv_size;
-        
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_u, src_stride, dst_u, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_v, src_stride, dst_v, dst_stride);
     }
     else if (is_semi_planar(fmt))
     {
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_base, src_stride, dst_base, dst_stride);
         
         src_base   += psrc->y_size;
         dst_base   += pdst->y_size; 
         src_stride  = psrc->uv_stride;
         dst_stride  = pdst->uv_stride;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (psrc);
+        h   = get_uv_height(psrc);
         
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_base, src_stride, dst_base, dst_stride);
     }
-    else if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    else if (is_mch_mixed(fmt))
     {
         w   = w*2;
-        b16_rect_scale(w, h, lshift, src_base, src_stride, dst_base, dst_stride);
+        b16_rect_scale(w, h, lshift, rshift, rnd, src_base, src_stride, dst_base, dst_stride);
     }
     
     LEAVE_FUNC();
@@ -556,52 +656,21 @@ int b16_mch_scale(yuv_seq_t *pdst, yuv_seq_t *psrc)
     return 0;
 }
 
-int b16_rect_transpose(uint8_t* rect_base, int dstw, int dsth)
-{
-    #define TR_BUF_SIZE 4094
-    static uint8_t tr_buf[TR_BUF_SIZE];
-    uint16_t *tr_base = (uint16_t*)tr_buf;
-    int size_needed = dstw * dsth * sizeof(uint16_t);
-    if (size_needed>TR_BUF_SIZE)
-    {
-        tr_base = (uint16_t*) malloc ( size_needed );
-        if (tr_base==0) {
-            xerr("%s : malloc fail!\n", __FUNCTION__);
-            return 0;
-        }
-    }
-    memcpy(tr_base, rect_base, size_needed);
-
-    int x, y;
-    uint16_t* p16_base = (uint16_t*)rect_base;
-    static uint16_t m;
-    for(y=0; y<dsth; ++y)
-    {
-        for(x=0; x<dstw; ++x)
-        {
-            p16_base[y*dstw+x] = tr_base[x*dsth+y];
-        }
-    }
-    
-    if (size_needed>TR_BUF_SIZE)
-    {
-        free(tr_base);
-    }
-}
-
 /** bitdepth conversion
  *  @param [in] b08_stride byte stride
  *  @param [in] b16_stride byte stride
  *  @param [in] nlsb       valid bit is at MSB if nlsb < 0
+ *  @param [in] rnd        RND_*, as 16 bits go to 8
  */
 int b16_n_b8_cvt
 (
     void* b16_base, int b16_stride, int nlsb,
     void* b08_base, int b08_stride, int b_clip8,
-    int w,  int h
+    int w,  int h,  int rnd
 )
 {
-    int x, y;
+    uint16_t bias[4];
+    int y;
     int nshift = (nlsb > 0) ? (nlsb - 8) : 8;
 
     for (y=0; y<h; ++y) 
@@ -610,13 +679,10 @@ int b16_n_b8_cvt
         uint8_t*  p08 = (uint8_t* )((uint8_t*)b08_base + y * b08_stride);
         
         if (b_clip8 == B16_2_B8) {
-            for (x=0; x<w; ++x) {
-                *(p08 ++) = (uint8_t )(*(p16++) >> nshift);
-            }
+            get_rnd_bias(bias, rnd, 8, y);
+            yuv_kern.b16_to_b8(p08, p16, w, 8 - nshift, bias);
         } else {
-            for (x=0; x<w; ++x) {
-                *(p16++) = (uint16_t)(*(p08 ++) << nshift);
-            }
+            yuv_kern.b8_to_b16(p16, p08, w, nshift);
         }
     }
     
@@ -630,6 +696,7 @@ int b16_n_b8_cvt_mch(yuv_seq_t *rect16, yuv_seq_t *rect08, int b_clip8)
     uint8_t* b16_base   = rect16->pbuf; 
     uint8_t* b08_base   = rect08->pbuf; 
     int nlsb        = rect16->nlsb;
+    int rnd         = rect08->rnd;
     int b16_stride  = rect16->y_stride; 
     int b08_stride  = rect08->y_stride;
     int w   = rect16->width; 
@@ -638,51 +705,49 @@ int b16_n_b8_cvt_mch(yuv_seq_t *rect16, yuv_seq_t *rect08, int b_clip8)
     ENTER_FUNC();
     
     assert (rect16->nbit  == 16);
-    assert (rect16->nlsb  >= 8);
+    assert (rect16->nlsb  >= 8 || rect16->nlsb < 0);
     assert (rect08->nbit  == 8);
-    assert (rect16->yuvfmt  == rect08->yuvfmt);
+    assert (rect16->yuvfmt  == rect08->yuvfmt || is_planar_swap(rect16->yuvfmt, rect08->yuvfmt));
     assert (rect16->width   == rect08->width);
     assert (rect16->height  == rect08->height);
     
     if      (fmt == YUVFMT_400P)
     {
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h, rnd);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        uint8_t *b16_u, *b16_v, *b08_u, *b08_v;
         
-        b16_base   += rect16->y_size;
-        b08_base   += rect08->y_size; 
+        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h, rnd);
+        
+        get_uv_planes(rect16, &b16_u, &b16_v);
+        get_uv_planes(rect08, &b08_u, &b08_v);
         b16_stride  = rect16->uv_stride;
         b08_stride  = rect08->uv_stride;
+        w   = get_uv_width (rect16);
+        h   = get_uv_height(rect16);
         
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
-        
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
-        
-        b16_base   += rect16->uv_size;
-        b08_base   += rect08->uv_size;
-        
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        b16_n_b8_cvt(b16_u, b16_stride, nlsb, b08_u, b08_stride, b_clip8, w, h, rnd);
+        b16_n_b8_cvt(b16_v, b16_stride, nlsb, b08_v, b08_stride, b_clip8, w, h, rnd);
     }
     else if (is_semi_planar(fmt))
     {
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h, rnd);
         
         b16_base   += rect16->y_size;
         b08_base   += rect08->y_size; 
         b16_stride  = rect16->uv_stride;
         b08_stride  = rect08->uv_stride;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (rect16);
+        h   = get_uv_height(rect16);
         
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h, rnd);
     }
-    else if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    else if (is_mch_mixed(fmt))
     {
         w   = w*2;
-        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h);
+        b16_n_b8_cvt(b16_base, b16_stride, nlsb, b08_base, b08_stride, b_clip8, w, h, rnd);
     }
     
     LEAVE_FUNC();
@@ -697,7 +762,7 @@ int yuv_copy_rect(int w, int h, uint8_t *dst, int dst_stride, uint8_t *src, int
     w = w ? w : stride;
     w = MIN(w, stride);
     for (i=0; i<h; ++i) {
-        memcpy(dst, src, stride);
+        memcpy(dst, src, w);
         dst += dst_stride;
         src += src_stride;
     }
@@ -711,12 +776,14 @@ int yuv_copy_frame(yuv_seq_t *pdst, yuv_seq_t *psrc)
     show_yuv_prop(pdst, SLOG_DBG, "dst ");
 
     #define CMP(prop) (psrc->prop != pdst->prop)
-    if (CMP(yuvfmt) || CMP(width) || CMP(height) || CMP(nbit) || CMP(btile)) 
+    if ((CMP(yuvfmt) && !is_planar_swap(psrc->yuvfmt, pdst->yuvfmt)) || 
+        CMP(width) || CMP(height) || CMP(nbit) || CMP(btile)) 
     {
         xerr("%s(): diff in basic info\n", __FUNCTION__);
         return -1;
     }
-    if (pdst->btile && (CMP(tile.tw) || CMP(tile.th) || CMP(tile.tsz))) 
+    if (pdst->btile && (memcmp(&psrc->tile,    &pdst->tile,    sizeof(tile_t)) ||
+                        memcmp(&psrc->uv_tile, &pdst->uv_tile, sizeof(tile_t)))) 
     {
         xerr("%s(): diff in tile mode\n", __FUNCTION__);
         return -1;
@@ -725,29 +792,30 @@ int yuv_copy_frame(yuv_seq_t *pdst, yuv_seq_t *psrc)
     uint8_t* src_base = psrc->pbuf;
     uint8_t* dst_base = pdst->pbuf;
     int fmt = psrc->yuvfmt;
-    int h   = psrc->height; 
+    int h;
     
-    yuv_copy_rect(0, h, 
+    yuv_copy_rect(0, get_y_rows(psrc), 
             dst_base, pdst->y_stride, 
             src_base, psrc->y_stride);
 
-    if (is_mch_420(fmt) || is_mch_422(fmt))
+    if (is_mch_planar(fmt))
+    {
+        uint8_t *src_u, *src_v, *dst_u, *dst_v;
+        
+        h = get_uv_rows(psrc);
+        get_uv_planes(psrc, &src_u, &src_v);
+        get_uv_planes(pdst, &dst_u, &dst_v);
+        yuv_copy_rect(0, h, dst_u, pdst->uv_stride, src_u, psrc->uv_stride);
+        yuv_copy_rect(0, h, dst_v, pdst->uv_stride, src_v, psrc->uv_stride);
+    }
+    else if (is_semi_planar(fmt))
     {
-        h /= get_uv_ds_ratio_h(fmt); 
+        h = get_uv_rows(psrc);
         src_base   += psrc->y_size;
         dst_base   += pdst->y_size; 
         yuv_copy_rect(0, h, 
                 dst_base, pdst->uv_stride, 
                 src_base, psrc->uv_stride);
-        
-        if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
-        {
-            src_base   += psrc->uv_size;
-            dst_base   += pdst->uv_size;
-            yuv_copy_rect(0, h, 
-                    dst_base, pdst->uv_stride, 
-                    src_base, psrc->uv_stride);
-        }
     }
     
     LEAVE_FUNC();
@@ -827,7 +895,7 @@ int yuv_copy_roi(yuv_seq_t *pdst, yuv_seq_t *psrc)
             dst_base, pdst->y_stride, 
             src_base, psrc->y_stride);
 
-    if (is_mch_420(fmt) || is_mch_422(fmt))
+    if (is_mch_420(fmt) || is_mch_422(fmt) || is_mch_444(fmt))
     {
         roi_w /= get_uv_ds_ratio_w(fmt);
         roi_h /= get_uv_ds_ratio_h(fmt);
@@ -839,7 +907,7 @@ int yuv_copy_roi(yuv_seq_t *pdst, yuv_seq_t *psrc)
                 dst_base, pdst->y_stride, 
                 src_base, psrc->y_stride);
                 
-        if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+        if (is_mch_planar(fmt))
         {
             src_base += psrc->uv_size;
             dst_base += pdst->uv_size;
@@ -873,180 +941,12 @@ int is_valid_roi(int w, int h, rect_t *roi)
     return 0;
 }
 
-/**
- *  @param [in] pdst description for target yuv format
- *      The buffer @pdst bound is just for median used. "pdst->pbuf"
- *      is not guaranteed to hold the target yuv data at any point.
- *  @param [in] psrc hold yuv buffer compliant to source yuv format (@psrc itself)
- *  @return either @pdst or @psrc which hold yuv buffer compliant to @pdst
- */
-yuv_seq_t *yuv_cvt_frame(yuv_seq_t *pdst, yuv_seq_t *psrc)
-{
-    yuv_seq_t cfg_src, cfg_dst;
-    
-    ENTER_FUNC();
-    show_yuv_prop(pdst, SLOG_DBG, "dst ");
-    show_yuv_prop(psrc, SLOG_DBG, "src ");
-
-    memcpy(&cfg_src, psrc, sizeof(yuv_seq_t));
-    memcpy(&cfg_dst, pdst, sizeof(yuv_seq_t));
-    
-    #define SWAP_SRC_DST()  do { \
-        yuv_seq_t *ptmp=psrc; psrc=pdst; pdst=ptmp; \
-    } while(0)
-    
-    SWAP_SRC_DST();
-    
-    /**
-     *  b10-untile/unpack, b8-untile
-     */
-    if (cfg_src.nbit==10) 
-    {
-        SWAP_SRC_DST();
-        set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                cfg_src.yuvfmt, BIT_16, BIT_10, TILE_0, 0, 0);
-        if (cfg_src.btile) {
-            b10_tile_unpack_mch(psrc, pdst, B10_2_B16);
-        } else {
-            b10_rect_unpack_mch(psrc, pdst, B10_2_B16);
-        }
-    } 
-    else if (cfg_src.nbit==8)
-    {
-        if (cfg_src.btile) {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_src.yuvfmt, BIT_8, BIT_8, TILE_0, 0, 0);
-            b8_tile_2_mch(psrc, pdst, TILE2RECT);
-        }
-    }
-
-    /**
-     *  bit-shift
-     */
-    if (pdst->nbit != cfg_dst.nbit) {
-        if (pdst->nbit==16 && cfg_dst.nbit==8) {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_src.yuvfmt, BIT_8, BIT_8, TILE_0, 0, 0);
-            b16_n_b8_cvt_mch(psrc, pdst, B16_2_B8);
-        } 
-        else if (pdst->nbit==8 && cfg_dst.nbit>8) {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_src.yuvfmt, BIT_16, cfg_dst.nbit, TILE_0, 0, 0);
-            pdst->nlsb = cfg_dst.nlsb;
-            b16_n_b8_cvt_mch(pdst, psrc, B8_2_B16);
-        }
-    } else if (cfg_dst.nbit == 16) {
-        if (pdst->nlsb != cfg_dst.nlsb) {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_src.yuvfmt, BIT_16, BIT_16, TILE_0, 0, 0);
-            b16_mch_scale(pdst, psrc);
-        } 
-    }
-
-    /**
-     * fmt convertion.
-     */        
-    if (cfg_src.yuvfmt  != cfg_dst.yuvfmt)
-    {
-        int nbit = pdst->nbit;
-        int nlsb = pdst->nlsb;
-        assert(nbit == 8 || nbit == 16);
-        int (*mch_p2p   )(yuv_seq_t*, yuv_seq_t*);
-        int (*mch_sp2p  )(yuv_seq_t*, yuv_seq_t*, int);
-        int (*mch_yuyv2p)(yuv_seq_t*, yuv_seq_t*, int);
-        mch_p2p    = (nbit==8) ? b8_mch_p2p    : b16_mch_p2p    ;
-        mch_sp2p   = (nbit==8) ? b8_mch_sp2p   : b16_mch_sp2p   ;
-        mch_yuyv2p = (nbit==8) ? b8_mch_yuyv2p : b16_mch_yuyv2p ;
-
-        // uv de-interlace
-        if (cfg_src.yuvfmt != get_spl_fmt(cfg_src.yuvfmt)) { 
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    get_spl_fmt(cfg_src.yuvfmt), nbit, nlsb, TILE_0, 0, 0);
-            if (is_semi_planar(cfg_src.yuvfmt)) {
-                mch_sp2p(psrc, pdst, SPLITTING);
-            } else if (cfg_src.yuvfmt == YUVFMT_UYVY || cfg_src.yuvfmt == YUVFMT_YUYV) {
-                mch_yuyv2p(psrc, pdst, SPLITTING);
-            }
-        }
-        
-        // uv re-sample
-        if (pdst->yuvfmt != get_spl_fmt(cfg_dst.yuvfmt) )
-        {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    get_spl_fmt(cfg_dst.yuvfmt), nbit, nlsb, TILE_0, 0, 0);
-            mch_p2p(pdst, psrc); 
-        }
-
-        // uv interlace
-        if (pdst->yuvfmt != cfg_dst.yuvfmt)
-        {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_dst.yuvfmt, nbit, nlsb, TILE_0, 0, 0);
-            if (is_semi_planar(cfg_dst.yuvfmt)) {
-                mch_sp2p(pdst, psrc, INTERLACING);
-            } else if (cfg_dst.yuvfmt == YUVFMT_UYVY  || cfg_dst.yuvfmt == YUVFMT_YUYV ) {
-                mch_yuyv2p(pdst, psrc, INTERLACING);
-            }
-        }
-    }
-
-    /**
-     *  b10-tile/pack, b8-tile
-     */
-    if (cfg_dst.nbit==10) 
-    {
-        SWAP_SRC_DST();
-        if (cfg_dst.btile) {
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_dst.yuvfmt, BIT_10, BIT_10, TILE_1, 0, 0);
-            b10_tile_unpack_mch(pdst, psrc, B16_2_B10);
-        } else {
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_dst.yuvfmt, BIT_10, BIT_10, TILE_0, 
-                    cfg_dst.y_stride, cfg_dst.io_size);
-            b10_rect_unpack_mch(pdst, psrc, B16_2_B10);
-        }
-    }
-    else if (cfg_dst.nbit==8)
-    {
-        if (cfg_dst.btile) {
-            SWAP_SRC_DST();
-            set_yuv_prop(pdst, 1, cfg_src.width, cfg_src.height, 
-                    cfg_dst.yuvfmt, BIT_8, BIT_8, TILE_1, 0, 0);
-            b8_tile_2_mch(pdst, psrc, RECT2TILE);
-        }
-    }
-    else if (cfg_dst.nbit==16)
-    {
-        //TODO: 
-    }
-
-    // buf re-placement
-    if (pdst->y_stride != cfg_dst.y_stride || 
-        pdst->io_size  != cfg_dst.io_size  )
-    {
-        SWAP_SRC_DST();
-        set_yuv_prop_by_copy(pdst, 1, &cfg_dst);
-        yuv_copy_frame(pdst, psrc); 
-    }
-    
-    LEAVE_FUNC();
-    
-    return pdst;
-}
-
 int cvt_arg_init (cvt_opt_t *cfg, int argc, char *argv[])
 {
     set_yuv_prop(&cfg->src, 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     set_yuv_prop(&cfg->dst, 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     cfg->frame_range[1] = INT_MAX;
+    cfg->n_thread = 1;
 }
 
 int cvt_arg_parse(cvt_opt_t *cfg, int argc, char *argv[])
@@ -1134,12 +1034,24 @@ int cvt_arg_parse(cvt_opt_t *cfg, int argc, char *argv[])
         if (0==strcmp(arg, "wxh")) {
             i = arg_parse_wxh(i, argc, argv, &src->width, &src->height);
         } else
+        if (0==strcmp(arg, "scale")) {
+            i = arg_parse_wxh(i, argc, argv, &dst->width, &dst->height);
+        } else
+        if (0==strcmp(arg, "scale-filter")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->dst.scl_filt = name ? yuv_scl_filt(name) : -1;
+            i = (cfg->dst.scl_filt < 0) ? -1 : i;
+        } else
         if (0==strcmp(arg, "fmt")) {
             i = arg_parse_fmt(i, argc, argv, &seq->yuvfmt);
         } else
         if (0==strcmp(arg, "b10")) {
             seq->nbit = 10;     seq->nlsb = 10;
         } else
+        if (0==strcmp(arg, "b12")) {
+            seq->nbit = 12;     seq->nlsb = 12;
+        } else
         if (0==strcmp(arg, "nbit") || 0==strcmp(arg, "b")) {
             i = arg_parse_int(i, argc, argv, &seq->nbit);
         } else
@@ -1150,6 +1062,33 @@ int cvt_arg_parse(cvt_opt_t *cfg, int argc, char *argv[])
             i = opt_parse_int(i, argc, argv, &seq->btile, 1);
             seq->btile ? (seq->yuvfmt = YUVFMT_420SP) : 0;
         } else  
+        if (0==strcmp(arg, "tile-wxh")) {
+            i = arg_parse_wxh(i, argc, argv, &seq->tile.tw, &seq->tile.th);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-size")) {
+            i = arg_parse_int(i, argc, argv, &seq->tile.tsz);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-pad")) {
+            i = arg_parse_int(i, argc, argv, &seq->tile.pad);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "tile-scan")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            seq->tile.scan = name ? yuv_tile_scan(name) : -1;
+            i = (seq->tile.scan < 0) ? -1 : i;
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "uv-tile-wxh")) {
+            i = arg_parse_wxh(i, argc, argv, &seq->uv_tile.tw, &seq->uv_tile.th);
+            seq->btile = 1;
+        } else
+        if (0==strcmp(arg, "uv-tile-size")) {
+            i = arg_parse_int(i, argc, argv, &seq->uv_tile.tsz);
+            seq->btile = 1;
+        } else
         if (0==strcmp(arg, "n-frame") || 0==strcmp(arg, "nframe") ||
             0==strcmp(arg, "f")       || 0==strcmp(arg, "frame")) {
             int nframe = 0;
@@ -1168,6 +1107,42 @@ int cvt_arg_parse(cvt_opt_t *cfg, int argc, char *argv[])
         if (0==strcmp(arg, "iosize")) {
             i = arg_parse_int(i, argc, argv, &seq->io_size);
         } else
+        if (0==strcmp(arg, "threads") || 0==strcmp(arg, "j")) {
+            i = arg_parse_int(i, argc, argv, &cfg->n_thread);
+        } else
+        if (0==strcmp(arg, "pipe")) {
+            i = arg_parse_int(i, argc, argv, &cfg->n_pipe);
+        } else
+        if (0==strcmp(arg, "io")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->io_mode = name ? yuv_io_mode(name) : -1;
+            i = (cfg->io_mode < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "cpu")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->cpu = name ? yuv_cpu_level(name) : -1;
+            i = (cfg->cpu < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "round")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->dst.rnd = name ? yuv_rnd_mode(name) : -1;
+            i = (cfg->dst.rnd < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "uv-filter")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->dst.uv_filt = name ? yuv_uv_filt(name) : -1;
+            i = (cfg->dst.uv_filt < 0) ? -1 : i;
+        } else
+        if (0==strcmp(arg, "uv-site")) {
+            char *name = 0;
+            i = arg_parse_str(i, argc, argv, &name);
+            cfg->dst.uv_site = name ? yuv_uv_site(name) : -1;
+            i = (cfg->dst.uv_site < 0) ? -1 : i;
+        } else
         if (0==strcmp(arg, "xnon")) {
             xlevel(SLOG_NON);
         } else
@@ -1211,29 +1186,46 @@ int cvt_arg_check(cvt_opt_t *cfg, int argc, char *argv[])
         xerr("@cmdl>> Invalid resolution for src\n");
         return -1;
     }
-    if ((psrc->nbit != 8 && psrc->nbit!=10 && psrc->nbit!=16) ||
+    resolve_named_fmt(psrc);
+    resolve_named_fmt(pdst);
+    if ((psrc->yuvfmt == YUVFMT_V210 && psrc->btile) ||
+        (pdst->yuvfmt == YUVFMT_V210 && pdst->btile)) {
+        xerr("@cmdl>> v210 is not tiled\n");
+        return -1;
+    }
+    if ((psrc->nbit < 8 || psrc->nbit > 16) ||
         (psrc->nbit < psrc->nlsb)) {
         xerr("@cmdl>> Invalid bitdepth (%d/%d) for src\n", 
                 psrc->nlsb, psrc->nbit);
         return -1;
     }
-    if ((pdst->nbit != 8 && pdst->nbit!=10 && pdst->nbit!=16) ||
+    if ((pdst->nbit < 8 || pdst->nbit > 16) ||
         (pdst->nbit < pdst->nlsb)) {
         xerr("@cmdl>> Invalid bitdepth (%d/%d) for dst\n", 
                 pdst->nlsb, pdst->nbit);
         return -1;
     }
     
+    if (pdst->width && pdst->height &&
+        (pdst->width != psrc->width || pdst->height != psrc->height) &&
+        (is_mch_420(psrc->yuvfmt) || is_mch_420(pdst->yuvfmt)) &&
+        !is_bit_aligned(1, pdst->height)) {
+        xerr("@cmdl>> 420 not resized to odd height %d\n", pdst->height);
+        return -1;
+    }
+    
     psrc->nlsb = psrc->nlsb ? psrc->nlsb : psrc->nbit;
     pdst->nlsb = pdst->nlsb ? pdst->nlsb : pdst->nbit;
     
-    if (!ios_open(cfg->ios, CVT_IOS_CNT, 0)) {
+    if (!yuv_ios_open(cfg->ios, CVT_IOS_CNT)) {
         ios_close(cfg->ios, CVT_IOS_CNT);
         return -1;
     }
     
-    pdst->width  = psrc->width;
-    pdst->height = psrc->height;
+    if (!pdst->width || !pdst->height) {
+        pdst->width  = psrc->width;
+        pdst->height = psrc->height;
+    }
     set_yuv_prop_by_copy(psrc, 0, psrc);
     set_yuv_prop_by_copy(pdst, 0, pdst);
     show_yuv_prop(psrc, SLOG_CMDL, "@cfg>> src: ");
@@ -1254,6 +1246,7 @@ int cvt_arg_help()
     printf("yuv format convertor. Options:\n");
     printf("\t -i|-dst name<%%s> {...props...}\n");
     printf("\t -o|-src name<%%s> {...props...}\n");
+    printf("\t                     //name `-`: stdin/stdout, read in order\n");
     printf("\t ...frame range...   <%%d~%%d>\n");
 
     printf("\nset frame range as follow:\n");
@@ -1261,14 +1254,45 @@ int cvt_arg_help()
     printf("\t [-f-start    <%%d>]\n");
     printf("\t [-frame|-f   <%%d>]\n");
     
+    printf("\nset worker threads as follow:\n");
+    printf("\t [-threads|-j <%%d>]  //convert each frame in row bands\n");
+    printf("\t [-pipe <%%d>]        //read, convert and write frames concurrently\n");
+    
+    printf("\nset io mode as follow:\n");
+    printf("\t [-io <stdio,mmap,pread,uring>]  //mmap: convert straight from the mapped file\n");
+    printf("\t                                 //pread,uring: read ahead, -direct suffix for O_DIRECT\n");
+    
+    printf("\nset pixel kernels as follow:\n");
+    printf("\t [-cpu <auto,c,sse2,ssse3,sse41,avx2,avx512>]  //auto: best the cpu supports\n");
+    
+    printf("\nset rounding as bits are dropped as follow:\n");
+    printf("\t [-round <trunc,nearest,dither>]  //dither: 4x4 ordered\n");
+    
+    printf("\nset 420/422/444 chroma resampling as follow:\n");
+    printf("\t [-uv-filter <nearest,bilinear,4tap>]  //4tap: cubic up, [1 3 3 1] down\n");
+    printf("\t [-uv-site <center,top,bottom>]        //vertical siting of the 420 chroma\n");
+    
+    printf("\nset resizing as follow:\n");
+    printf("\t [-scale <%%dx%%d>]                          //dst size, src size if unset\n");
+    printf("\t [-scale-filter <bicubic,bilinear,lanczos3>]  //separable polyphase\n");
+    
     printf("\nset yuv props as follow:\n");
     printf("\t [-wxh <%%dx%%d>]\n");
     printf("\t [-fmt <%%420p,%%420sp,%%uyvy,%%422p>]\n");
     printf("\t [-stride <%%d>]\n");
     printf("\t [-iosize <%%d>]  //frame buf size\n");
-    printf("\t [-b10]\n");
+    printf("\t [-b10|-b12]    //packed lte bitstream\n");
+    printf("\t [-nbit <%%d>]   //8, 16, or 9..15 packed\n");
     printf("\t [-btile|-tile|-t]\n");
     
+    printf("\nset tile layout as follow, each implies -tile:\n");
+    printf("\t [-tile-wxh <%%dx%%d>]      //tile width(samples) x height, 3x4 (b10), 8x4 (b8, b9..b15) if unset\n");
+    printf("\t [-tile-size <%%d>]        //bytes of a tile, tight if unset\n");
+    printf("\t [-tile-pad <%%d>]         //bytes after each tile row\n");
+    printf("\t [-tile-scan <raster,z,n>] //z,n: 2x2 tile groups over tile row pairs\n");
+    printf("\t [-uv-tile-wxh <%%dx%%d>]   //chroma tiles, same as luma if unset\n");
+    printf("\t [-uv-tile-size <%%d>]\n");
+    
     int j;
     printf("\n-wxh option can be short as follow:\n");
     for (j=0; j<n_cmn_res; ++j) {
@@ -1278,6 +1302,8 @@ int cvt_arg_help()
     for (j=0; j<n_cmn_fmt; ++j) {
         printf("\t -%%%-7s = \"-fmt %d (%%%-7s)\"\n", cmn_fmt[j].name, cmn_fmt[j].val, cmn_fmt[j].name);
     }
+    printf("\t                    //v210 is 10-bit by itself; p010,p210,y210 imply\n");
+    printf("\t                    //`-nbit 16 -nlsb -10` (msb aligned), p016 `-nbit 16`\n");
     return 0;
 }
 
@@ -1285,9 +1311,11 @@ int yuv_cvt(int argc, char **argv)
 {
     int         r, i;
     cvt_opt_t   cfg;
-    yuv_seq_t   seq[2];
+    cvt_plan_t  plan;
+    yuv_io_t    io, out_io;
+    yuv_seq_t   seq, in;
 
-    memset(seq, 0, sizeof(seq));
+    memset(&seq, 0, sizeof(seq));
     memset(&cfg, 0, sizeof(cfg));
     cvt_arg_init (&cfg, argc, argv);
     
@@ -1304,18 +1332,43 @@ int yuv_cvt(int argc, char **argv)
         // xerr("cvt_arg_check() failed\n");
         return 1;
     }
+    yuv_kern_init(cfg.cpu);
+    yuv_io_open(&io, cfg.ios[CVT_IOS_SRC].fp, cfg.io_mode, cfg.src.io_size);
+    yuv_io_open(&out_io, cfg.ios[CVT_IOS_DST].fp, cfg.io_mode, cfg.dst.io_size);
     
-    int w_align = bit_sat(6, cfg.src.width);
-    int h_align = bit_sat(6, cfg.src.height);
-    int nbyte   = 1 + (cfg.src.nbit > 8 || cfg.src.nbit > 8);
-    for (i=0; i<2; ++i) {
-        seq[i].buf_size = w_align * h_align * 3 * nbyte;
-        seq[i].pbuf = (uint8_t *)malloc(seq[i].buf_size);
-        if(!seq[i].pbuf) {
-            xerr("malloc for seq[%d] failed\n", i);
-            return -1;
+    if (cfg.n_pipe > 0) {
+        if (cfg.n_thread > 1) {
+            xinfo("@cmdl>> -threads is ignored with -pipe\n");
         }
+        r = cvt_pipe_run(&io, &out_io, cfg.frame_range, 
+                         &cfg.dst, &cfg.src, cfg.n_pipe);
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        cvt_arg_close(&cfg);
+        return (r < 0) ? 1 : 0;
+    }
+    
+    r = cvt_plan_init(&plan, &cfg.dst, &cfg.src, CVT_PLAN_PAD_ON_WRITE |
+                      (out_io.b_splice ? CVT_PLAN_DOUBLE_OUT : 0));
+    if (r < 0) {
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        cvt_arg_close(&cfg);
+        return 1;
+    }
+    if (cfg.n_thread > 1) {
+        cvt_plan_threads(&plan, cfg.n_thread);
+    }
+    set_yuv_prop_by_copy(&seq, 1, &cfg.src);
+    if (!seq.pbuf) {
+        xerr("malloc for src frame failed\n");
+        cvt_plan_free(&plan);
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        cvt_arg_close(&cfg);
+        return 1;
     }
+    memcpy(&in, &seq, sizeof(yuv_seq_t));
 
     /*************************************************************************
      *                          frame loop
@@ -1323,38 +1376,29 @@ int yuv_cvt(int argc, char **argv)
     for (i=cfg.frame_range[0]; i<cfg.frame_range[1]; i++) 
     {
         xprint("@frm> #%d +\n", i);
-        r=fseek(cfg.ios[CVT_IOS_SRC].fp, cfg.src.io_size * i, SEEK_SET);
-        if (r) {
-            xerr("fseek %d error\n", cfg.src.io_size * i);
-            return -1;
-        }
-        
-        set_yuv_prop_by_copy(&seq[0], 1, &cfg.src);
-        r = fread(seq[0].pbuf, cfg.src.io_size, 1, cfg.ios[CVT_IOS_SRC].fp);
-        if (r<1) {
-            if ( ios_feof(cfg.ios, CVT_IOS_SRC) ) {
+        in.pbuf = yuv_io_read(&io, i, seq.pbuf);
+        if (!in.pbuf) {
+            if (io.b_eof) {
                 xinfo("@seq> reach file end, force stop\n");
-            } else {
-                xerr("error reading file\n");
             }
             break;
         }
 
-        set_yuv_prop_by_copy(&seq[1], 1, &cfg.dst);
-        yuv_seq_t *pdst = yuv_cvt_frame(&seq[1], &seq[0]);
+        yuv_seq_t *pdst = cvt_plan_run(&plan, &in);
         
-        r = fwrite(pdst->pbuf, pdst->io_size, 1, cfg.ios[CVT_IOS_DST].fp);
-        if (r<1) {
+        r = yuv_io_write(&out_io, pdst, &plan.dst);
+        if (r<0) {
             xerr("error writing file\n");
             break;
         }
         xprint("@frm> #%d -\n", i);
     } // end frame loop
     
+    yuv_io_close(&out_io);
+    yuv_io_close(&io);
     cvt_arg_close(&cfg);
-    for (i=0; i<2; ++i) {
-        yuv_buf_free(&seq[i]);
-    }
+    cvt_plan_free(&plan);
+    yuv_buf_free(&seq);
 
     return 0;
 }
@@ -17,6 +17,10 @@
 #ifndef __YUVCVT_H__
 #define __YUVCVT_H__
 
+#include "yuvthr.h"
+#include "yuvio.h"
+#include "yuvkern.h"
+
 enum {
     B10_2_B16   = 0,
     B16_2_B10   = 1,
@@ -63,6 +67,10 @@ typedef struct _yuv_cvt_opt
 {
     ios_t   ios[2];
     int     frame_range[2];
+    int     n_thread;
+    int     n_pipe;
+    int     io_mode;
+    int     cpu;
 
     yuv_seq_t   src;
     yuv_seq_t   dst;
@@ -71,6 +79,101 @@ typedef struct _yuv_cvt_opt
 
 yuv_seq_t *yuv_cvt_frame(yuv_seq_t *pdst, yuv_seq_t *psrc);
 
+#define CVT_MAX_STAGE   8
+#define CVT_BUF_PAD     256     //!< slack for kernels writing past a row
+
+#define CVT_PLAN_PAD_ON_WRITE   1   //!< leave dst stride/iosize to the writer
+#define CVT_PLAN_DOUBLE_OUT     2   //!< keep the previous output intact
+
+typedef int (*cvt_stage_fp)(yuv_seq_t *pdst, yuv_seq_t *psrc);
+typedef int (*cvt_rows_fp) (yuv_seq_t *pdst, yuv_seq_t *psrc, int y0, int h, void *ctx);
+
+typedef struct _cvt_stage
+{
+    const char     *name;
+    cvt_stage_fp    fp;
+    cvt_rows_fp     fp_rows;    //!< band entry of stages reading rows around
+                                //!< the band, given the whole frames
+    int             b_band;     //!< output rows only depend on the same input rows
+    void           *ctx;        //!< fp_rows state built with the plan, e.g. taps
+    yuv_seq_t       out;        //!< output layout, pbuf bound by the plan
+    
+} cvt_stage_t;
+
+typedef struct _cvt_plan
+{
+    yuv_seq_t   src;
+    yuv_seq_t   dst;
+    int         n_stage;
+    cvt_stage_t stage[CVT_MAX_STAGE];
+    yuv_seq_t   buf[3];         //!< ping-pong buffers owned by the plan,
+                                //!< and the second one of CVT_PLAN_DOUBLE_OUT
+    int         flags;
+    unsigned    n_run;
+    int         band_align;     //!< luma rows a band starts at a multiple of
+    thr_pool_t  pool;
+    
+} cvt_plan_t;
+
+int  cvt_plan_init(cvt_plan_t *plan, yuv_seq_t *pdst, yuv_seq_t *psrc, int flags);
+int  cvt_plan_threads(cvt_plan_t *plan, int n_thread);
+yuv_seq_t *cvt_plan_run(cvt_plan_t *plan, yuv_seq_t *psrc);
+void cvt_plan_free(cvt_plan_t *plan);
+void show_cvt_plan(cvt_plan_t *plan, int level, const char *prompt);
+
+int  cvt_pipe_run(yuv_io_t *in, yuv_io_t *out, int frame_range[2], 
+                  yuv_seq_t *pdst, yuv_seq_t *psrc, int n_lane);
+
+typedef struct _cvt_fused
+{
+    const char *name;
+    int (*match)(yuv_seq_t *pdst, yuv_seq_t *psrc);
+    int (*cvt  )(yuv_seq_t *pdst, yuv_seq_t *psrc);
+    
+} cvt_fused_t;
+
+const cvt_fused_t *get_fused_cvt(yuv_seq_t *pdst, yuv_seq_t *psrc);
+
+int b10_tile_2_b8_mch(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b8_sp_2_p_mch    (yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b8_yuyv_2_sp_mch (yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b16_yuyv_2_sp_mch(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b16_sp_2_b8_p_mch(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b16_sp_n_p_scale_mch(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b8_p_2_b16_sp_mch(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int v210_2_b8_p_mch  (yuv_seq_t *pdst, yuv_seq_t *psrc);
+
+int b8_mch_p2p (yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b16_mch_p2p(yuv_seq_t *pdst, yuv_seq_t *psrc);
+int b8_mch_sp2p (yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing);
+int b16_mch_sp2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing);
+int b8_mch_yuyv2p (yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing);
+int b16_mch_yuyv2p(yuv_seq_t *itl, yuv_seq_t *spl, int b_interlacing);
+int get_uv_shuf4   (int dst_fmt, int src_fmt, uint8_t perm[4]);
+int yuv_uv_reorder (yuv_seq_t *pdst, yuv_seq_t *psrc);
+int yuv_uv_resample(yuv_seq_t *pdst, yuv_seq_t *psrc, int y0, int h);
+int yuv_uv_hresample(yuv_seq_t *pdst, yuv_seq_t *psrc);
+typedef struct _yuv_scaler yuv_scaler_t;
+yuv_scaler_t *yuv_scaler_init(yuv_seq_t *pdst, yuv_seq_t *psrc);
+void yuv_scaler_free(yuv_scaler_t *scl);
+int yuv_scale_rows(yuv_seq_t *pdst, yuv_seq_t *psrc, int y0, int h, yuv_scaler_t *scl);
+int b16_mch_scale(yuv_seq_t *pdst, yuv_seq_t *psrc);
+void get_b16_scale(int dst_nlsb, int src_nlsb, int *lshift, int *rshift);
+int b16_n_b8_cvt_mch(yuv_seq_t *rect16, yuv_seq_t *rect08, int b_clip8);
+void get_rnd_bias(uint16_t bias[4], int rnd, int rshift, int y);
+void bn_linear_unpack_lte(void* bn_base, int n_byte, void* b16_base, int n16, int nbit);
+void bn_linear_pack_lte  (void* bn_base, int n_byte, void* b16_base, int n16, int nbit);
+void bn_tile_row_unpack(uint8_t *t, int tw, int th, int tsz, uint16_t *r, int w, int h, int s, int nbit);
+void bn_tile_row_pack  (uint8_t *t, int tw, int th, int tsz, uint16_t *r, int w, int h, int s, int nbit);
+int bn_rect_unpack_mch(yuv_seq_t *rectn, yuv_seq_t *rect16, int b_pack);
+int bn_tile_unpack_mch(yuv_seq_t *tilen, yuv_seq_t *rect16, int b_pack);
+void v210_row_unpack(uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w);
+void v210_row_pack  (uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w);
+int v210_unpack_mch(yuv_seq_t *v210, yuv_seq_t *p16, int b_pack);
+void b8_tile_2_mch(yuv_seq_t *tile, yuv_seq_t *rect, int b_t2r);
+void b8_tile_2_rect_edge(int dir, uint8_t* line, uint8_t* rect, 
+                         int w, int h, int s, int nx, int ny);
+
 int cvt_arg_init (cvt_opt_t *cfg, int argc, char *argv[]);
 int cvt_arg_parse(cvt_opt_t *cfg, int argc, char *argv[]);
 int cvt_arg_check(cvt_opt_t *cfg, int argc, char *argv[]);
@@ -15,180 +15,316 @@
 *****************************************************************************/
 
 #include <assert.h>
-#include <malloc.h>
+#include <string.h>
 #include "yuvdef.h"
 #include "yuvcvt.h"
 
 
 /**
- * unpack 10-bit compact pixels to 16 (low 10-bit)
- *      - i32_0 is used for bitop
- *      - i32_1 is used for reading 
- *
- *   high (10-rbit)|00000000000000|- rbit -| 
- *    bit      high------------------------> low
- *    byte         |  3  |  2  |  1  |  0  | 
- *  
- *                  high (10-rbit)|00000000|- (32-rbit) --|
- *    bit      high------------------------> low
- *  
+ *  unpack an N-bit compact bitstream (lte: sample k at bit N*k, LSB first)
+ *  to 16 bits (low N bits). It stops at @n16 samples or the end of the
+ *  @n_byte bytes, whichever comes first; a row may end mid-word.
  */
-void b10_linear_unpack_lte(void* b10_base, int n_byte, void* b16_base, int n16)
+void bn_linear_unpack_lte(void* bn_base, int n_byte, void* b16_base, int n16, int nbit)
 {
-    register i64_pack_t bp;
-    
-    bp.i64   = 0;
-    uint16_t v16;
-    int rbit = 0;
-    int i32  = 0;
-    int n32  = n_byte >> 2;
-    int i16  = 0;
-    uint32_t* pb10 = (uint32_t*)b10_base;
+    uint8_t*  pbn  = (uint8_t*)bn_base;
     uint16_t* pb16 = (uint16_t*)b16_base;
-
-    //assert( (n_byte & 0x08) == 0 );
-    //assert( n_byte > (n16*5+3)/4 );
+    uint32_t  mask = (1u << nbit) - 1;
+    uint32_t  acc  = 0;
+    int nacc = 0;                               //!< valid bits in acc
+    int ib   = 0;
+    int i16;
     
-    while (1) 
+    for (i16=0; i16<n16; ++i16) 
     {
-        if (rbit<10) {
-            if (i32 < n32 && i16 < n16) {
-                bp.i32_1 = pb10[i32++];
-            } else {
-                break;
+        while (nacc < nbit) {
+            if (ib >= n_byte) {
+                return;
             }
-            v16  = (bp.i32_0 & 0x3ff);  bp.i64 >>= (32-rbit);   // low   rbit
-            v16 += (bp.i32_0 & 0x3ff);  bp.i64 >>= 10;          // high (10-rbit)
-            rbit += 22;                                         // rbit=32-(10-rbit)
-        } else {
-            v16 = (bp.i32_0 & 0x3ff);   bp.i64 >>= 10; 
-            rbit -= 10;
+            acc  |= (uint32_t)pbn[ib++] << nacc;
+            nacc += 8;
         }
-        pb16[i16++] = v16;
+        pb16[i16] = (uint16_t)(acc & mask);
+        acc  >>= nbit;
+        nacc  -= nbit;
     }
 }
 
 /**
- * pack low 10-bit in 16 to 10-bit compact format
- *
- *                 |xxxxxxxxxxxxxx|- rbit -| 
- *    bit      high------------------------> low
- *    byte         |  3  |  2  |  1  |  0  | 
- *  
+ *  pack low N bits in 16 to the compact bitstream. The bits after the last 
+ *  sample in its byte are zeroed; bytes after it are not written.
  */
-void b10_linear_pack_lte(void* b10_base, int n_byte, void* b16_base, int n16)
+void bn_linear_pack_lte(void* bn_base, int n_byte, void* b16_base, int n16, int nbit)
 {
-    uint32_t v16 = 0;
-    uint32_t v32 = 0;
-    int rbit = 0;
-    int i32  = 0;
-    int n32  = n_byte >> 2;
-    int i16  = 0;
-    uint32_t* pb10 = (uint32_t*)b10_base;
+    uint8_t*  pbn  = (uint8_t*)bn_base;
     uint16_t* pb16 = (uint16_t*)b16_base;
+    uint32_t  mask = (1u << nbit) - 1;
+    uint32_t  acc  = 0;
+    int nacc = 0;
+    int ib   = 0;
+    int i16;
+    
+    for (i16=0; i16<n16; ++i16) 
+    {
+        acc  |= (pb16[i16] & mask) << nacc;
+        nacc += nbit;
+        while (nacc >= 8) {
+            if (ib >= n_byte) {
+                return;
+            }
+            pbn[ib++] = (uint8_t)acc;
+            acc  >>= 8;
+            nacc  -= 8;
+        }
+    }
+    if (nacc > 0 && ib < n_byte) {
+        pbn[ib] = (uint8_t)acc;
+    }
+}
+
+/**
+ *  one row of tiles <-> raster, see yuv_kern_t.bn_tile_unpack.
+ *  A sample spans 3 bytes at most (bit offset in the byte 0..7, N <= 15),
+ *  so no bitstream state is kept; the third byte is only touched if the
+ *  sample reaches it, as it may be past the tile.
+ */
+void bn_tile_row_unpack(uint8_t *t, int tw, int th, int tsz, 
+                        uint16_t *r, int w, int h, int s, int nbit)
+{
+    uint32_t mask = (1u << nbit) - 1;
+    uint32_t v;
+    int tx, x, y, k, nx;
+    
+    for (tx=0; tx<w; tx+=tw, t+=tsz) {
+        nx = MIN(tw, w-tx);
+        for (x=0; x<nx; ++x) {
+            for (y=0; y<h; ++y) {
+                uint16_t *p16 = (uint16_t*)((uint8_t*)r + y*s) + tx + x;
+                uint8_t  *b   = t + ((nbit * (x*th + y)) >> 3);
+                k = (nbit * (x*th + y)) & 7;
+                v = b[0] | (b[1] << 8);
+                if (k + nbit > 16) {
+                    v |= b[2] << 16;
+                }
+                *p16 = (uint16_t)((v >> k) & mask);
+            }
+        }
+    }
+}
+
+void bn_tile_row_pack(uint8_t *t, int tw, int th, int tsz, 
+                      uint16_t *r, int w, int h, int s, int nbit)
+{
+    uint32_t mask = (1u << nbit) - 1;
+    uint32_t v;
+    int tx, x, y, k, nx;
+    
+    for (tx=0; tx<w; tx+=tw, t+=tsz) {
+        nx = MIN(tw, w-tx);
+        memset(t, 0, tsz);
+        for (x=0; x<nx; ++x) {
+            for (y=0; y<h; ++y) {
+                uint16_t *p16 = (uint16_t*)((uint8_t*)r + y*s) + tx + x;
+                uint8_t  *b   = t + ((nbit * (x*th + y)) >> 3);
+                k = (nbit * (x*th + y)) & 7;
+                v = (*p16 & mask) << k;
+                b[0] |= (uint8_t)(v     );
+                b[1] |= (uint8_t)(v >> 8);
+                if (k + nbit > 16) {
+                    b[2] |= (uint8_t)(v >> 16);
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  v210: 6 pixels of 422 in 4 little-endian words, 3 samples each at 
+ *  bit 0, 10, 20:
+ *      u0 y0 v0 | y1 u1 y2 | v1 y3 u2 | y4 v2 y5
+ *  stream sample i of a block is y, u or v by the tables below
+ */
+static const uint8_t v210_y[6] = {1, 3, 5, 7, 9, 11};
+static const uint8_t v210_u[3] = {0, 4, 8};
+static const uint8_t v210_v[3] = {2, 6, 10};
+
+/**
+ *  one row of v210 <-> 10-bit in 16 planes, see yuv_kern_t.v210_unpack
+ */
+void v210_row_unpack(uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w)
+{
+    uint16_t s[12];
+    uint32_t d;
+    int x, k, n;
     
-    //assert( (n_byte & 0x08) == 0 );
-    //assert( n_byte > (n16*5+3)/4 );
+    for (x=0; x<w; x+=6, p+=16) {
+        for (k=0; k<4; ++k) {
+            d = p[4*k] | (p[4*k+1] << 8) | (p[4*k+2] << 16) | ((uint32_t)p[4*k+3] << 24);
+            s[3*k  ] = (d      ) & 0x3ff;
+            s[3*k+1] = (d >> 10) & 0x3ff;
+            s[3*k+2] = (d >> 20) & 0x3ff;
+        }
+        n = MIN(6, w-x);
+        for (k=0; k<n; ++k) {
+            y[x+k] = s[v210_y[k]];
+        }
+        for (k=0; k<n/2; ++k) {
+            u[x/2+k] = s[v210_u[k]];
+            v[x/2+k] = s[v210_v[k]];
+        }
+    }
+}
+
+void v210_row_pack(uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w)
+{
+    uint16_t s[12];
+    uint32_t d;
+    int x, k, n;
+    
+    for (x=0; x<w; x+=6, p+=16) {
+        memset(s, 0, sizeof(s));
+        n = MIN(6, w-x);
+        for (k=0; k<n; ++k) {
+            s[v210_y[k]] = y[x+k] & 0x3ff;
+        }
+        for (k=0; k<n/2; ++k) {
+            s[v210_u[k]] = u[x/2+k] & 0x3ff;
+            s[v210_v[k]] = v[x/2+k] & 0x3ff;
+        }
+        for (k=0; k<4; ++k) {
+            d = s[3*k] | (s[3*k+1] << 10) | ((uint32_t)s[3*k+2] << 20);
+            p[4*k  ] = (uint8_t)(d      );
+            p[4*k+1] = (uint8_t)(d >>  8);
+            p[4*k+2] = (uint8_t)(d >> 16);
+            p[4*k+3] = (uint8_t)(d >> 24);
+        }
+    }
+}
+
+/**
+ *  @brief v210 <-> 422p of 10-bit in 16, row by row. Packing zeroes the
+ *      padding of the rows.
+ *  @param [in] b_pack B16_2_B10 to pack @p16 into @v210
+ */
+int v210_unpack_mch(yuv_seq_t *v210, yuv_seq_t *p16, int b_pack)
+{
+    uint8_t *u, *v;
+    int n_byte = sat_div(v210->width, 6) * 16;     //!< the rest pads the row
+    int y;
+    
+    ENTER_FUNC();
+    
+    assert (v210->yuvfmt == YUVFMT_V210);
+    assert (p16->yuvfmt == YUVFMT_422P);
+    assert (p16->nbit == 16 && p16->nlsb == 10);
+    assert (v210->width == p16->width && v210->height == p16->height);
     
-    while (i32 < n32 && i16 < n16) 
+    get_uv_planes(p16, &u, &v);
+    for (y=0; y<v210->height; ++y) 
     {
-        v16 = pb16[i16++];
+        uint8_t  *p  = v210->pbuf + y * v210->y_stride;
+        uint16_t *py = (uint16_t*)(p16->pbuf + y * p16->y_stride);
+        uint16_t *pu = (uint16_t*)(u + y * p16->uv_stride);
+        uint16_t *pv = (uint16_t*)(v + y * p16->uv_stride);
         
-        if (rbit>=22) {
-            v32  += (v16 & 0x3ff) << rbit;                      // low (32-rbit)
-            pb10[i32++] = v32;
-            v32   = (v16 & 0x3ff) >> (32-rbit);                 // high 10-(32-rbit)
-            rbit -= 22;                                         // rbit=10-(32-rbit)
+        if (b_pack == B16_2_B10) {
+            yuv_kern.v210_pack  (p, py, pu, pv, v210->width);
+            memset(p + n_byte, 0, v210->y_stride - n_byte);
         } else {
-            v32  += (v16 & 0x3ff) << rbit;
-            rbit += 10;
+            yuv_kern.v210_unpack(p, py, pu, pv, v210->width);
         }
     }
+    
+    LEAVE_FUNC();
+    
+    return 0;
 }
 
-void b10_rect_unpack
+void bn_rect_unpack
 (
-    int   b_pack,
-    void* b10_base, int b10_stride,
+    int   b_pack,   int nbit,
+    void* bn_base,  int bn_stride,
     void* b16_base, int b16_stride,
     int   rect_w,   int rect_h
 )
 {
-    int x, y;
-    void (*b10_pack_unpack_fp)(void* b10_base, int n_byte, void* b16_base, int n16);
+    int y;
+    void (*bn_pack_unpack_fp)(void* bn_base, int n_byte, void* b16_base, int n16, int nbit);
     
-    b10_pack_unpack_fp = (b_pack == B16_2_B10) ? b10_linear_pack_lte : b10_linear_unpack_lte;
+    bn_pack_unpack_fp = (b_pack == B16_2_B10) ? yuv_kern.bn_pack : yuv_kern.bn_unpack;
     
     for (y=0; y<rect_h; ++y) 
     {
-        b10_pack_unpack_fp(b10_base, b10_stride, b16_base, rect_w);
-        b10_base += b10_stride;
+        bn_pack_unpack_fp(bn_base, bn_stride, b16_base, rect_w, nbit);
+        bn_base += bn_stride;
         b16_base += b16_stride;
     }
     
     return;
 }
 
-int b10_rect_unpack_mch(yuv_seq_t *rect10, yuv_seq_t *rect16, int b_pack)
+int bn_rect_unpack_mch(yuv_seq_t *rectn, yuv_seq_t *rect16, int b_pack)
 {
-    int fmt = rect10->yuvfmt;
+    int fmt  = rectn->yuvfmt;
+    int nbit = rectn->nbit;
     
-    uint8_t* b10_base   = rect10->pbuf; 
+    uint8_t* bn_base    = rectn->pbuf; 
     uint8_t* b16_base   = rect16->pbuf; 
-    int b10_stride  = rect10->y_stride; 
+    int bn_stride   = rectn->y_stride; 
     int b16_stride  = rect16->y_stride;
-    int w   = rect10->width; 
-    int h   = rect10->height; 
+    int w   = rectn->width; 
+    int h   = rectn->height; 
 
     ENTER_FUNC();
     
-    assert (rect10->nbit == 10);
+    assert (rectn->nbit > 8 && rectn->nbit < 16);
     assert (rect16->nbit == 16);
-    assert (rect16->nlsb == 10);
-    assert (rect10->width == rect16->width);
-    assert (rect10->height == rect16->height);
-    assert (rect10->yuvfmt == rect16->yuvfmt);
+    assert (rect16->nlsb == nbit);
+    assert (rectn->width == rect16->width);
+    assert (rectn->height == rect16->height);
+    assert (rectn->yuvfmt == rect16->yuvfmt);
     
     if      (fmt == YUVFMT_400P)
     {
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
         
-        b10_base   += rect10->y_size;
+        bn_base    += rectn->y_size;
         b16_base   += rect16->y_size; 
-        b10_stride  = rect10->uv_stride;
+        bn_stride   = rectn->uv_stride;
         b16_stride  = rect16->uv_stride;
         
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (rectn);
+        h   = get_uv_height(rectn);
         
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
         
-        b10_base   += rect10->uv_size;
+        bn_base    += rectn->uv_size;
         b16_base   += rect16->uv_size;
         
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
     }
     else if (is_semi_planar(fmt))
     {
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
         
-        b10_base   += rect10->y_size;
+        bn_base    += rectn->y_size;
         b16_base   += rect16->y_size; 
-        b10_stride  = rect10->uv_stride;
+        bn_stride   = rectn->uv_stride;
         b16_stride  = rect16->uv_stride;
         
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (rectn);
+        h   = get_uv_height(rectn);
         
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
     }
-    else if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    else if (is_mch_mixed(fmt))
     {
         w   = w*2;
-        b10_rect_unpack(b_pack, b10_base, b10_stride, b16_base, b16_stride, w, h);
+        bn_rect_unpack(b_pack, nbit, bn_base, bn_stride, b16_base, b16_stride, w, h);
     }
     
     LEAVE_FUNC();
@@ -196,122 +332,120 @@ int b10_rect_unpack_mch(yuv_seq_t *rect10, yuv_seq_t *rect16, int b_pack)
     return;
 }
 
-int b10_tile_unpack
+int bn_tile_unpack
 (
-    int      b_pack,
-    uint8_t* tile10_base, int tw, int th, int tsz, int ts, 
+    int      b_pack,   int nbit,
+    uint8_t* tilen_base, tile_t *t, int ts, 
     uint8_t* rect16_base, int w,  int h,  int s
 )
 {
     int x, y, tx, ty;
+    int tw  = t->tw;
+    int th  = t->th;
+    int tsz = t->tsz;
+    int ntx = sat_div(w, tw);
+    int nty = sat_div(h, th);
     
     assert( (tsz & 7) == 0 );
-    assert( ts >= (w*th*5+3)/4 );
-    
-    #define UNPACK_BUF_SIZE 4094
-    uint8_t  unpack_buf[UNPACK_BUF_SIZE];
-    uint8_t *unpack_base = unpack_buf;
-    int size_needed = tw * th * sizeof(uint16_t);
-    if (size_needed > UNPACK_BUF_SIZE)
-    {
-        unpack_base = (uint8_t*) malloc ( size_needed );
-        if (unpack_base==0) {
-            xerr("%s : malloc fail!\n", __FUNCTION__);
-            return 0;
-        }
-    }
+    assert( ts >= ntx * tsz );
     
+    /**
+     *  a tile row at a time, straight between the tiles and the raster.
+     *  Z/N scans break the row into tiles.
+     */
     for (ty=0, y=0; y<h; y+=th, ++ty) 
     {
-        for (tx=0, x=0; x<w; x+=tw, ++tx) 
-        {
-            uint8_t* p10 = &tile10_base[ts*ty + tsz*tx];
-            uint8_t* p16 = &rect16_base[s * y + sizeof(uint16_t) * x];
-            
+        uint16_t* p16 = (uint16_t*)(rect16_base + s * y);
+        int ny = MIN(th, h-y);
+        
+        if (t->scan == TILE_SCAN_RASTER) {
+            uint8_t *row = tilen_base + ts * ty;
             if (b_pack==B16_2_B10) {
-                b8_linear_2_rect(RECT2LINE, unpack_base, p16, tw*2, th, s);
-                b16_rect_transpose(unpack_base, tw, th);
-                b10_linear_pack_lte(p10, tsz, unpack_base, tw*th);
+                yuv_kern.bn_tile_pack  (row, tw, th, tsz, p16, w, ny, s, nbit);
             } else {
-                b10_linear_unpack_lte(p10, tsz, unpack_base, tw*th);
-                b16_rect_transpose(unpack_base, tw, th);
-                b8_linear_2_rect(LINE2RECT, unpack_base, p16, tw*2, th, s);
+                yuv_kern.bn_tile_unpack(row, tw, th, tsz, p16, w, ny, s, nbit);
+            }
+            continue;
+        }
+        for (tx=0, x=0; x<w; x+=tw, ++tx) {
+            uint8_t *tile = tilen_base + get_tile_offset(t, ts, ntx, nty, tx, ty);
+            int nx = MIN(tw, w-x);
+            if (b_pack==B16_2_B10) {
+                yuv_kern.bn_tile_pack  (tile, tw, th, tsz, p16 + x, nx, ny, s, nbit);
+            } else {
+                yuv_kern.bn_tile_unpack(tile, tw, th, tsz, p16 + x, nx, ny, s, nbit);
             }
         }
-    }
-    
-    if (size_needed>UNPACK_BUF_SIZE)
-    {
-        free(unpack_base);
     }
     
     return w*h;
 }
 
-int b10_tile_unpack_mch(yuv_seq_t *tile10, yuv_seq_t *rect16, int b_pack)
+int bn_tile_unpack_mch(yuv_seq_t *tilen, yuv_seq_t *rect16, int b_pack)
 {
-    int fmt = tile10->yuvfmt;
+    int fmt  = tilen->yuvfmt;
+    int nbit = tilen->nbit;
 
     ENTER_FUNC();
     
-    int tw  = tile10->tile.tw;
-    int th  = tile10->tile.th;
-    int tsz = tile10->tile.tsz;
-    int ts  = tile10->y_stride;
+    tile_t *t  = &tilen->tile;
+    tile_t *tc = &tilen->uv_tile;
+    int ts  = tilen->y_stride;
     int w   = rect16->width;
     int h   = rect16->height;
     int s   = rect16->y_stride;
-    uint8_t *pt = tile10->pbuf;
+    uint8_t *pt = tilen->pbuf;
     uint8_t *pl = rect16->pbuf;
     
-    assert (tile10->btile == 1);
-    assert (tile10->nbit == 10);
+    assert (tilen->btile == 1);
+    assert (tilen->nbit > 8 && tilen->nbit < 16);
     assert (rect16->nbit == 16);
-    assert (rect16->nlsb == 10);
-    assert (tile10->width == rect16->width);
-    assert (tile10->height == rect16->height);
-    assert (tile10->yuvfmt == rect16->yuvfmt);
+    assert (rect16->nlsb == nbit);
+    assert (tilen->width == rect16->width);
+    assert (tilen->height == rect16->height);
+    assert (tilen->yuvfmt == rect16->yuvfmt);
     
     if      (fmt == YUVFMT_400P)
     {
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, t, ts, pl, w, h, s);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, t, ts, pl, w, h, s);
         
-        ts  = tile10->uv_stride;
+        ts  = tilen->uv_stride;
         s   = rect16->uv_stride;
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (tilen);
+        h   = get_uv_height(tilen);
         
-        pt += tile10->y_size;
+        pt += tilen->y_size;
         pl += rect16->y_size;
         
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, tc, ts, pl, w, h, s);
         
-        pt += tile10->uv_size;
+        pt += tilen->uv_size;
         pl += rect16->uv_size;
         
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, tc, ts, pl, w, h, s);
     }
     else if (is_semi_planar(fmt))
     {
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, t, ts, pl, w, h, s);
         
-        ts  = tile10->uv_stride;
+        ts  = tilen->uv_stride;
         s   = rect16->uv_stride;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (tilen);
+        h   = get_uv_height(tilen);
 
-        pt += tile10->y_size;
+        pt += tilen->y_size;
         pl += rect16->y_size;
         
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, tc, ts, pl, w, h, s);
     }
-    else if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    else if (is_mch_mixed(fmt))
     {
         w   = w*2;
-        b10_tile_unpack(b_pack, pt, tw, th, tsz, ts, pl, w, h, s);
+        bn_tile_unpack(b_pack, nbit, pt, t, ts, pl, w, h, s);
     }
     
     LEAVE_FUNC();
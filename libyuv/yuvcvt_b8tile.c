@@ -15,150 +15,124 @@
 *****************************************************************************/
 
 #include <assert.h>
+#include <string.h>
 #include "yuvdef.h"
 #include "yuvcvt.h"
 
 
-void b8_linear_2_rect_align_0(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; ++i) {
-            *((uint8_t*)(rect+i)) = *((uint8_t*)(line+i));
-        }
-        line += w;
-        rect += s;
-    }
+#define B8_TILE_CHUNK   64      //!< tiles mapped per pass over the lines
+
+/**
+ *  one line across @n tiles at @off from @t: tile line <-> rect line @r.
+ *  The fixed widths let memcpy() become plain loads and stores.
+ */
+#define B8_TILE_LINE(TW)                                                    \
+static void b8_tile_line_##TW(int b_t2r, uint8_t *t, const int *off,        \
+                              uint8_t *r, int n, int tw)                    \
+{                                                                           \
+    int i;                                                                  \
+    if (b_t2r == TILE2RECT) {                                               \
+        for (i=0; i<n; ++i) {                                               \
+            memcpy(r + TW*i, t + off[i], TW);                               \
+        }                                                                   \
+    } else {                                                                \
+        for (i=0; i<n; ++i) {                                               \
+            memcpy(t + off[i], r + TW*i, TW);                               \
+        }                                                                   \
+    }                                                                       \
 }
 
-void b8_linear_2_rect_align_4(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; i+=4) {
-            *((uint32_t*)(rect+i)) = *((uint32_t*)(line+i));
-        }
-        line += w;
-        rect += s;
-    }
-}
-
-void b8_linear_2_rect_align_8(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; i+=8) {
-            *((uint64_t*)(rect+i)) = *((uint64_t*)(line+i));
-        }
-        line += w;
-        rect += s;
-    }
-}
-
-void b8_linear_2_rect_width_8(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        *((uint64_t*)(rect)) = *((uint64_t*)(line));
-        line += w;
-        rect += s;
-    }
-}
-
-
-void b8_rect_2_linear_align_0(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; ++i) {
-            *((uint8_t*)(line+i)) = *((uint8_t*)(rect+i));
-        }
-        line += w;
-        rect += s;
-    }
-}
+B8_TILE_LINE(8)
+B8_TILE_LINE(16)
+B8_TILE_LINE(32)
+B8_TILE_LINE(64)
 
-void b8_rect_2_linear_align_4(uint8_t* line, uint8_t* rect, int w, int h, int s)
+static void b8_tile_line_n(int b_t2r, uint8_t *t, const int *off, 
+                           uint8_t *r, int n, int tw)
 {
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; i+=4) {
-            *((uint32_t*)(line+i)) = *((uint32_t*)(rect+i));
+    int i;
+    if (b_t2r == TILE2RECT) {
+        for (i=0; i<n; ++i) {
+            memcpy(r + tw*i, t + off[i], tw);
         }
-        line += w;
-        rect += s;
-    }
-}
-
-void b8_rect_2_linear_align_8(uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    int i, j;
-    for (j=0; j<h; ++j) {
-        for (i=0; i<w; i+=8) {
-            *((uint64_t*)(line+i)) = *((uint64_t*)(rect+i));
+    } else {
+        for (i=0; i<n; ++i) {
+            memcpy(t + off[i], r + tw*i, tw);
         }
-        line += w;
-        rect += s;
     }
 }
 
-void b8_rect_2_linear_width_8(uint8_t* line, uint8_t* rect, int w, int h, int s)
+/**
+ *  partial tile at the right/bottom edge: only the @nx x @ny pixels inside
+ *  the plane are touched on the rect side, the rest of the tile is zeroed
+ */
+void b8_tile_2_rect_edge(int dir, uint8_t* line, uint8_t* rect, 
+                         int w, int h, int s, int nx, int ny)
 {
-    int i, j;
-    for (j=0; j<h; ++j) {
-        *((uint64_t*)(line)) = *((uint64_t*)(rect));
-        line += w;
-        rect += s;
-    }
-}
-
-void b8_linear_2_rect(int dir, uint8_t* line, uint8_t* rect, int w, int h, int s)
-{
-    void (*map_func_p)(uint8_t* line, uint8_t* rect, int w, int h, int s);
-    int b_l2r = (dir==LINE2RECT);
-    
-    if        ( ((int)line&3) || (w&3) || ((int)rect&3) || (s&3) ) {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_0 : b8_rect_2_linear_align_0;
-    } else if ( ((int)line&7) || (w&7) || ((int)rect&7) || (s&7) ) {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_4 : b8_rect_2_linear_align_4;
-    } else if ( w == 8 )  {
-        map_func_p = b_l2r ? b8_linear_2_rect_width_8 : b8_rect_2_linear_width_8; 
+    if (dir == LINE2RECT) {
+        yuv_copy_rect(nx, ny, rect, s, line, w);
     } else {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_8 : b8_rect_2_linear_align_8;
+        memset(line, 0, w*h);
+        yuv_copy_rect(nx, ny, line, w, rect, s);
     }
-    
-    map_func_p(line, rect, w, h, s);
 }
 
+/**
+ *  @brief map a plane between tiles of @t and the raster, a chunk of a tile
+ *      row at a time and line by line within it, so both sides are walked 
+ *      forward
+ */
 void b8_tile_2_rect
 (
     int b_t2r, 
-    uint8_t* pt, int tw, int th, int tsz, int ts, 
+    uint8_t* pt, tile_t *t, int ts, 
     uint8_t* pl, int w,  int h,  int s
 )
 {
-    int x, y, tx, ty;
-    void (*map_func_p)(uint8_t* line, uint8_t* rect, int w, int h, int s);
-    int b_l2r = (b_t2r == TILE2RECT);
-
-    if        ( ((int)pt&3) || (tw&3) || (tsz&3) || (ts&3) || ((int)pl&3) || (s&3) ) {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_0 : b8_rect_2_linear_align_0;
-    } else if ( ((int)pl&7) || (tw&7) || (tsz&7) || (ts&7) || ((int)pl&7) || (s&7) ) {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_4 : b8_rect_2_linear_align_4;
-    } else if ( tw == 8 ) {
-        map_func_p = b_l2r ? b8_linear_2_rect_width_8 : b8_rect_2_linear_width_8;  
-    } else {
-        map_func_p = b_l2r ? b8_linear_2_rect_align_8 : b8_rect_2_linear_align_8;    
-    } 
+    int x, y, tx, ty, i, j;
+    int tw  = t->tw;
+    int th  = t->th;
+    int ntx = sat_div(w, tw);
+    int nty = sat_div(h, th);
+    int nfx = w / tw;               //!< full tiles in a tile row
+    int off[B8_TILE_CHUNK];
+    void (*line_fp)(int b_t2r, uint8_t *t, const int *off, 
+                    uint8_t *r, int n, int tw);
+    
+    switch (tw) {
+    case 8:     line_fp = b8_tile_line_8;   break;
+    case 16:    line_fp = b8_tile_line_16;  break;
+    case 32:    line_fp = b8_tile_line_32;  break;
+    case 64:    line_fp = b8_tile_line_64;  break;
+    default:    line_fp = b8_tile_line_n;   break;
+    }
     
     for (ty=0, y=0; y<h; y+=th, ++ty) 
     {
-        for (tx=0, x=0; x<w; x+=tw, ++tx) 
+        int ny = MIN(th, h-y);
+        
+        for (tx=0; tx<nfx; tx+=B8_TILE_CHUNK) 
         {
-            uint8_t* src = &pt[ts*ty + tsz*tx];
-            uint8_t* dst = &pl[s * y + x];
-
-            map_func_p(src, dst, tw, th, s);
+            int n = MIN(B8_TILE_CHUNK, nfx-tx);
+            uint8_t *r = &pl[s * y + tw * tx];
+            
+            for (i=0; i<n; ++i) {
+                off[i] = get_tile_offset(t, ts, ntx, nty, tx+i, ty);
+            }
+            for (j=0; j<ny; ++j) {
+                line_fp(b_t2r, pt + tw*j, off, r + s*j, n, tw);
+            }
+            if (b_t2r == RECT2TILE && ny < th) {
+                for (i=0; i<n; ++i) {
+                    memset(pt + off[i] + tw*ny, 0, tw*(th-ny));
+                }
+            }
+        }
+        
+        if (nfx < ntx) {
+            x  = nfx * tw;
+            b8_tile_2_rect_edge(b_t2r, pt + get_tile_offset(t, ts, ntx, nty, nfx, ty), 
+                    &pl[s * y + x], tw, th, s, w-x, ny);
         }
     } 
     
@@ -169,9 +143,8 @@ void b8_tile_2_mch(yuv_seq_t *tile, yuv_seq_t *rect, int b_t2r)
 {
     int fmt = tile->yuvfmt;
     
-    int tw  = tile->tile.tw;
-    int th  = tile->tile.th;
-    int tsz = tile->tile.tsz;
+    tile_t *t  = &tile->tile;
+    tile_t *tc = &tile->uv_tile;
     int ts  = tile->y_stride;
     int w   = rect->width;
     int h   = rect->height;
@@ -187,44 +160,45 @@ void b8_tile_2_mch(yuv_seq_t *tile, yuv_seq_t *rect, int b_t2r)
     assert (tile->height == rect->height);
     
     if (fmt == YUVFMT_400P) {
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, t, ts, pl, w, h, s);
     }
-    else if (fmt == YUVFMT_420P || fmt == YUVFMT_422P)
+    else if (is_mch_planar(fmt))
     {
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, t, ts, pl, w, h, s);
         
         ts  = tile->uv_stride;
         s   = rect->uv_stride;
-        w   = w/2;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (tile);
+        h   = get_uv_height(tile);
         
         pt += tile->y_size;
         pl += rect->y_size;
         
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, tc, ts, pl, w, h, s);
         
         pt += tile->uv_size;
         pl += rect->uv_size;
         
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, tc, ts, pl, w, h, s);
     }
     else if (is_semi_planar(fmt))
     {
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, t, ts, pl, w, h, s);
         
         ts  = tile->uv_stride;
         s   = rect->uv_stride;
-        h   = is_mch_422(fmt) ? h : h/2;
+        w   = get_uv_width (tile);
+        h   = get_uv_height(tile);
 
         pt += tile->y_size;
         pl += rect->y_size;
         
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, tc, ts, pl, w, h, s);
     }
-    else if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    else if (is_mch_mixed(fmt))
     {
         w   = w*2;
-        b8_tile_2_rect(b_t2r, pt, tw, th, tsz, ts, pl, w, h, s);
+        b8_tile_2_rect(b_t2r, pt, t, ts, pl, w, h, s);
     }
     
     LEAVE_FUNC();
@@ -0,0 +1,238 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcvt_chroma.c
+ *  @brief Chroma resampling. 420 <-> 422: a vertical filter of up to 4
+ *      taps per output row, picked by filter and siting of the 420 chroma.
+ *      Rows are filtered in place of their layout, so planar and 
+ *      semi-planar chroma take the same path. 422 <-> 444: the same taps
+ *      along the row, for chroma co-sited with the even luma columns.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+/**
+ *  output row <- rows y0..y0+3 around the source row it lands on: 2j for
+ *  420 row j (down), j/2 for 422 row j (up). Taps are 6-bit, a lone 64
+ *  is a row copy.
+ */
+typedef struct _uv_taps
+{
+    int         y0;
+    int16_t     c[4];
+    
+} uv_taps_t;
+
+static const uv_taps_t uv_down[3][3] = 
+{
+    /* center: 2j+0.5 */
+    {{ 0, {64,  0,  0,  0}}, { 0, {32, 32,  0,  0}}, {-1, { 8, 24, 24,  8}}},
+    /* top:    2j */
+    {{ 0, {64,  0,  0,  0}}, { 0, {64,  0,  0,  0}}, {-1, {16, 32, 16,  0}}},
+    /* bottom: 2j+1 */
+    {{ 1, {64,  0,  0,  0}}, { 1, {64,  0,  0,  0}}, { 0, {16, 32, 16,  0}}},
+};
+
+/**
+ *  [site][filter][row parity]. 4-tap up is the 6-bit cubic of the 
+ *  quarter/half sample phase.
+ */
+static const uv_taps_t uv_up[3][3][2] = 
+{
+    /* center: 422 rows 2k, 2k+1 at k-1/4, k+1/4 */
+    {
+        {{ 0, {64,  0,  0,  0}}, { 0, {64,  0,  0,  0}}},
+        {{-1, {16, 48,  0,  0}}, { 0, {48, 16,  0,  0}}},
+        {{-2, {-2, 16, 54, -4}}, {-1, {-4, 54, 16, -2}}},
+    },
+    /* top: at k, k+1/2 */
+    {
+        {{ 0, {64,  0,  0,  0}}, { 0, {64,  0,  0,  0}}},
+        {{ 0, {64,  0,  0,  0}}, { 0, {32, 32,  0,  0}}},
+        {{ 0, {64,  0,  0,  0}}, {-1, {-4, 36, 36, -4}}},
+    },
+    /* bottom: at k-1/2, k */
+    {
+        {{ 0, {64,  0,  0,  0}}, { 0, {64,  0,  0,  0}}},
+        {{-1, {32, 32,  0,  0}}, { 0, {64,  0,  0,  0}}},
+        {{-2, {-4, 36, 36, -4}}, { 0, {64,  0,  0,  0}}},
+    },
+};
+
+/**
+ *  @brief 420 <-> 422 resampling of luma rows [@y0, @y0+@h), 8 or 16 bits,
+ *      with chroma planar or semi-planar on both sides. Filter and siting
+ *      (of the 420 side, either way) are taken from @pdst. @pdst and @psrc
+ *      are whole frames, as the filter reads chroma rows around the band;
+ *      rows past the frame edge repeat the edge row.
+ *  @return 0 on success
+ */
+int yuv_uv_resample(yuv_seq_t *pdst, yuv_seq_t *psrc, int y0, int h)
+{
+    int b_up  = is_mch_420(psrc->yuvfmt);
+    int site  = pdst->uv_site;
+    int filt  = pdst->uv_filt;
+    int nbyte = psrc->nbit / 8;
+    int n_uv  = is_mch_planar(psrc->yuvfmt) ? 2 : 1;
+    int n     = get_uv_width(psrc);
+    int ns    = get_uv_height(psrc);
+    int nd    = get_uv_height(pdst);
+    int ds    = get_uv_ds_ratio_h(pdst->yuvfmt);
+    int j0    = y0 / ds;
+    int j1    = MIN(sat_div(y0 + h, ds), nd);
+    uint8_t *src_uv[2], *dst_uv[2];
+    int p, j, k, r;
+
+    ENTER_FUNC();
+    
+    assert(psrc->nbit == pdst->nbit && (psrc->nbit == 8 || psrc->nbit == 16));
+    assert(is_mch_420(psrc->yuvfmt) != is_mch_420(pdst->yuvfmt));
+    assert(is_mch_422(psrc->yuvfmt) != is_mch_422(pdst->yuvfmt));
+    assert(is_mch_planar(psrc->yuvfmt) == is_mch_planar(pdst->yuvfmt));
+    assert(!is_mch_mixed(psrc->yuvfmt) && !is_mch_mixed(pdst->yuvfmt));
+    assert(n_uv == 2 || is_uv_swapped(psrc->yuvfmt) == is_uv_swapped(pdst->yuvfmt));
+    assert(y0 % ds == 0);
+    
+    if ((unsigned)site > UV_SITE_BOTTOM || (unsigned)filt > UV_FILT_4TAP) {
+        xerr("%s(): bad chroma siting (%d) or filter (%d)\n", __FUNCTION__, site, filt);
+        return -1;
+    }
+    
+    yuv_copy_rect(psrc->width * nbyte, h, 
+            pdst->pbuf + y0 * pdst->y_stride, pdst->y_stride, 
+            psrc->pbuf + y0 * psrc->y_stride, psrc->y_stride);
+    
+    /**
+     *  planes in u,v order on both sides, whichever is stored first
+     */
+    get_uv_planes(psrc, &src_uv[0], &src_uv[1]);
+    get_uv_planes(pdst, &dst_uv[0], &dst_uv[1]);
+    
+    for (p=0; p<n_uv; ++p) 
+    {
+        uint8_t *src = src_uv[p];
+        uint8_t *dst = dst_uv[p];
+        
+        for (j=j0; j<j1; ++j) 
+        {
+            const uv_taps_t *t = b_up ? &uv_up[site][filt][j&1] : &uv_down[site][filt];
+            uint8_t *d = dst + j * pdst->uv_stride;
+            uint8_t *rows[4];
+            
+            r = (b_up ? j/2 : 2*j) + t->y0;
+            for (k=0; k<4; ++k) {
+                rows[k] = src + MAX(MIN(r + k, ns - 1), 0) * psrc->uv_stride;
+            }
+            
+            if (t->c[0] == 64) {
+                memcpy(d, rows[0], n * nbyte);
+            } else if (nbyte == 1) {
+                yuv_kern.b8_vfilt(d, rows, t->c, n);
+            } else {
+                yuv_kern.b16_vfilt((uint16_t *)d, (uint16_t **)rows, t->c, n, 
+                                   (1 << psrc->nlsb) - 1);
+            }
+        }
+    }
+    
+    LEAVE_FUNC();
+    
+    return 0;
+}
+
+/**
+ *  @brief 422 <-> 444 resampling, 8 or 16 bits, planar or semi-planar on 
+ *      both sides, in either uv order; the filter is taken from @pdst. Rows stand alone, so a
+ *      band of rows is a valid call. Samples past the row ends repeat the
+ *      edge ones.
+ *  @return 0 on success
+ */
+int yuv_uv_hresample(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    int b_up  = is_mch_422(psrc->yuvfmt);
+    int filt  = pdst->uv_filt;
+    int nbyte = psrc->nbit / 8;
+    int b_sp  = is_semi_planar(psrc->yuvfmt);
+    int n_uv  = b_sp ? 1 : 2;
+    int step  = b_sp ? 2 : 1;
+    int swap  = b_sp && is_uv_swapped(psrc->yuvfmt) != is_uv_swapped(pdst->yuvfmt);
+    int ns    = get_uv_width(psrc) / step;
+    int nd    = get_uv_width(pdst) / step;
+    int h     = get_uv_height(psrc);
+    int max   = (nbyte == 1) ? 255 : (1 << psrc->nlsb) - 1;
+    uint8_t *src_uv[2], *dst_uv[2];
+    int p, c, x, y, k, r, v;
+
+    ENTER_FUNC();
+    
+    assert(psrc->nbit == pdst->nbit && (psrc->nbit == 8 || psrc->nbit == 16));
+    assert(is_mch_444(psrc->yuvfmt) != is_mch_444(pdst->yuvfmt));
+    assert(is_mch_422(psrc->yuvfmt) != is_mch_422(pdst->yuvfmt));
+    assert(b_sp == is_semi_planar(pdst->yuvfmt) && b_sp != is_mch_planar(pdst->yuvfmt));
+    
+    if ((unsigned)filt > UV_FILT_4TAP) {
+        xerr("%s(): bad chroma filter (%d)\n", __FUNCTION__, filt);
+        return -1;
+    }
+    
+    yuv_copy_rect(psrc->width * nbyte, psrc->height, 
+            pdst->pbuf, pdst->y_stride, 
+            psrc->pbuf, psrc->y_stride);
+    
+    get_uv_planes(psrc, &src_uv[0], &src_uv[1]);
+    get_uv_planes(pdst, &dst_uv[0], &dst_uv[1]);
+    
+    for (p=0; p<n_uv; ++p) 
+    for (y=0; y<h; ++y) 
+    {
+        uint8_t *src = src_uv[p] + y * psrc->uv_stride;
+        uint8_t *dst = dst_uv[p] + y * pdst->uv_stride;
+        
+        for (x=0; x<nd; ++x) 
+        {
+            const uv_taps_t *t = b_up ? &uv_up[UV_SITE_TOP][filt][x&1] 
+                                      : &uv_down[UV_SITE_TOP][filt];
+            r = (b_up ? x/2 : 2*x) + t->y0;
+            
+            for (c=0; c<step; ++c) 
+            {
+                v = 32;
+                for (k=0; k<4; ++k) {
+                    int i = MAX(MIN(r + k, ns - 1), 0) * step + (c ^ swap);
+                    v += t->c[k] * ((nbyte == 1) ? src[i] : ((uint16_t *)src)[i]);
+                }
+                v = v<0 ? 0 : MIN(v>>6, max);
+                
+                if (nbyte == 1) {
+                    dst[x*step + c] = (uint8_t)v;
+                } else {
+                    ((uint16_t *)dst)[x*step + c] = (uint16_t)v;
+                }
+            }
+        }
+    }
+    
+    LEAVE_FUNC();
+    
+    return 0;
+}
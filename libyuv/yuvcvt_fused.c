@@ -0,0 +1,577 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcvt_fused.c
+ *  @brief Single-pass kernels for common (src, dst) pairs. Each kernel reads
+ *      the source frame once and writes @pdst (laid out as the final target,
+ *      stride/iosize included) once, instead of going through the
+ *      intermediate frames of the yuv_cvt_frame() chain.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+/**
+ *  fetch the 12 samples of a 3x4 10-bit tile (16 bytes, lte bitstream).
+ *  samples are in column order: smp[x*4+y]
+ */
+static void b10_tile_fetch(uint8_t *tile, uint16_t smp[12])
+{
+    uint64_t lo, hi;
+    int k;
+
+    memcpy(&lo, tile,     8);
+    memcpy(&hi, tile + 8, 8);
+
+    for (k=0; k<6; ++k) {
+        smp[k] = (uint16_t)(lo >> (10*k)) & 0x3ff;
+    }
+    smp[6] = (uint16_t)((lo >> 60) | (hi << 4)) & 0x3ff;
+    for (k=7; k<12; ++k) {
+        smp[k] = (uint16_t)(hi >> (10*k - 64)) & 0x3ff;
+    }
+}
+
+/**
+ *  10-bit 3x4 tiles -> 8-bit raster, one plane
+ */
+static void b10_tile_2_b8_rect
+(
+    uint8_t* pt, int ts,
+    uint8_t* pl, int s, int w, int h
+)
+{
+    uint16_t smp[12];
+    int x, y, i, j, nx, ny;
+
+    for (y=0; y<h; y+=4, pt+=ts)
+    {
+        uint8_t* tile = pt;
+        ny = MIN(4, h-y);
+        for (x=0; x<w; x+=3, tile+=16)
+        {
+            b10_tile_fetch(tile, smp);
+            nx = MIN(3, w-x);
+            for (j=0; j<ny; ++j) {
+                uint8_t *p08 = pl + (y+j) * s + x;
+                for (i=0; i<nx; ++i) {
+                    p08[i] = (uint8_t)(smp[i*4+j] >> 2);
+                }
+            }
+        }
+    }
+}
+
+/**
+ *  the only tiling of the fused kernel: 3x4 in 16 bytes, raster scan
+ */
+static int is_b10_tile_3x4(tile_t *t)
+{
+    return t->tw == 3 && t->th == 4 && t->tsz == 16 
+        && t->scan == TILE_SCAN_RASTER;
+}
+
+int b10_tile_2_b8_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    int fmt = psrc->yuvfmt;
+
+    uint8_t *pt = psrc->pbuf;
+    uint8_t *pl = pdst->pbuf;
+    int ts  = psrc->y_stride;
+    int s   = pdst->y_stride;
+    int w   = psrc->width;
+    int h   = psrc->height;
+
+    ENTER_FUNC();
+
+    assert (psrc->btile && psrc->nbit == 10);
+    assert (is_b10_tile_3x4(&psrc->tile) && is_b10_tile_3x4(&psrc->uv_tile));
+    assert (pdst->nbit == 8 && !pdst->btile);
+    assert (pdst->yuvfmt == fmt);
+
+    if (is_mch_mixed(fmt)) {
+        w  *= 2;
+    }
+    b10_tile_2_b8_rect(pt, ts, pl, s, w, h);
+
+    if (is_mch_planar(fmt) || is_semi_planar(fmt))
+    {
+        pt += psrc->y_size;
+        pl += pdst->y_size;
+        ts  = psrc->uv_stride;
+        s   = pdst->uv_stride;
+        w   = get_uv_width (psrc);
+        h   = get_uv_height(psrc);
+
+        b10_tile_2_b8_rect(pt, ts, pl, s, w, h);
+
+        if (is_mch_planar(fmt)) {
+            pt += psrc->uv_size;
+            pl += pdst->uv_size;
+            b10_tile_2_b8_rect(pt, ts, pl, s, w, h);
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  8-bit semi-planar -> planar of the same chroma sampling, in either 
+ *  uv order
+ */
+int b8_sp_2_p_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* src_y_base = psrc->pbuf;
+    uint8_t* src_u_base = src_y_base + psrc->y_size;
+
+    uint8_t* dst_y_base = pdst->pbuf;
+    uint8_t* dst_u_base;
+    uint8_t* dst_v_base;
+
+    int w   = psrc->width;
+    int h   = psrc->height;
+    int y;
+
+    ENTER_FUNC();
+
+    assert (psrc->nbit == 8 && pdst->nbit == 8);
+    assert (is_semi_planar(psrc->yuvfmt));
+    assert (is_planar_swap(pdst->yuvfmt, get_spl_fmt(psrc->yuvfmt)));
+
+    get_uv_planes(pdst, &dst_u_base, &dst_v_base);
+    if (is_uv_swapped(psrc->yuvfmt)) {
+        swap_uv(&dst_u_base, &dst_v_base);
+    }
+
+    for (y=0; y<h; ++y) {
+        memcpy(dst_y_base + y * pdst->y_stride,
+               src_y_base + y * psrc->y_stride, w);
+    }
+
+    w   = get_uv_width (pdst);
+    h   = get_uv_height(pdst);
+
+    for (y=0; y<h; ++y) {
+        uint8_t* src_u = src_u_base + y * psrc->uv_stride;
+        uint8_t* dst_u = dst_u_base + y * pdst->uv_stride;
+        uint8_t* dst_v = dst_v_base + y * pdst->uv_stride;
+        yuv_kern.b8_uv_split(dst_u, dst_v, src_u, w);
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  yuyv/uyvy -> 420sp/422sp, yvyu/vyuy -> nv21/nv61.
+ *  For 420sp, chroma of odd lines is dropped, which is the nearest
+ *  resampling of center or top sited chroma.
+ */
+static int yuyv_2_sp(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* src_base   = psrc->pbuf;
+    uint8_t* dst_y_base = pdst->pbuf;
+    uint8_t* dst_u_base = dst_y_base + pdst->y_size;
+
+    int b_420 = is_mch_420(pdst->yuvfmt);
+    int yo  = get_yuyv_yo(psrc->yuvfmt);
+    int w   = psrc->width / 2;
+    int h   = psrc->height;
+    int y;
+
+    ENTER_FUNC();
+
+    assert (psrc->nbit == pdst->nbit);
+    assert (is_mch_mixed(psrc->yuvfmt));
+    assert (is_semi_planar(pdst->yuvfmt) && !is_mch_444(pdst->yuvfmt));
+    assert (is_uv_swapped(pdst->yuvfmt) == is_uv_swapped(psrc->yuvfmt));
+
+    for (y=0; y<h; ++y)
+    {
+        uint8_t* src   = src_base   + y * psrc->y_stride;
+        uint8_t* dst_y = dst_y_base + y * pdst->y_stride;
+        uint8_t* dst_u = 0;
+
+        if (!b_420 || !(y & 1)) {
+            dst_u = dst_u_base + (b_420 ? y/2 : y) * pdst->uv_stride;
+        }
+        if (psrc->nbit == 8) {
+            yuv_kern.b8_yuyv_split_sp(dst_y, dst_u, src, w, yo);
+        } else {
+            yuv_kern.b16_yuyv_split_sp((uint16_t*)dst_y, (uint16_t*)dst_u, 
+                                       (uint16_t*)src, w, yo);
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+int b8_yuyv_2_sp_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    assert (psrc->nbit == 8);
+    return yuyv_2_sp(pdst, psrc);
+}
+
+int b16_yuyv_2_sp_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    assert (psrc->nbit == 16);
+    return yuyv_2_sp(pdst, psrc);
+}
+
+/**
+ *  16-bit semi-planar -> 8-bit planar, same rounding as b16_n_b8_cvt(),
+ *  chroma through a row chunk of 8-bit uv
+ */
+#define B16_SP_CHUNK    256
+
+int b16_sp_2_b8_p_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* src_y_base = psrc->pbuf;
+    uint8_t* src_u_base = src_y_base + psrc->y_size;
+
+    uint8_t* dst_y_base = pdst->pbuf;
+    uint8_t* dst_u_base;
+    uint8_t* dst_v_base;
+
+    uint8_t  uv[2*B16_SP_CHUNK];
+    uint16_t bias[4];
+    int lshift = (psrc->nlsb > 0) ? (16 - psrc->nlsb) : 0;
+    int w   = psrc->width;
+    int h   = psrc->height;
+    int x, y, n;
+
+    ENTER_FUNC();
+
+    assert (psrc->nbit == 16 && pdst->nbit == 8);
+    assert (psrc->nlsb >= 8 || psrc->nlsb < 0);
+    assert (is_semi_planar(psrc->yuvfmt));
+    assert (is_planar_swap(pdst->yuvfmt, get_spl_fmt(psrc->yuvfmt)));
+
+    get_uv_planes(pdst, &dst_u_base, &dst_v_base);
+    if (is_uv_swapped(psrc->yuvfmt)) {
+        swap_uv(&dst_u_base, &dst_v_base);
+    }
+
+    for (y=0; y<h; ++y) {
+        uint16_t* src_y = (uint16_t*)(src_y_base + y * psrc->y_stride);
+        uint8_t*  dst_y = dst_y_base + y * pdst->y_stride;
+        get_rnd_bias(bias, pdst->rnd, 8, y);
+        yuv_kern.b16_to_b8(dst_y, src_y, w, lshift, bias);
+    }
+
+    w   = get_uv_width (pdst);
+    h   = get_uv_height(pdst);
+
+    for (y=0; y<h; ++y) {
+        uint16_t* src_u = (uint16_t*)(src_u_base + y * psrc->uv_stride);
+        uint8_t*  dst_u = dst_u_base + y * pdst->uv_stride;
+        uint8_t*  dst_v = dst_v_base + y * pdst->uv_stride;
+        get_rnd_bias(bias, pdst->rnd, 8, y);
+        for (x=0; x<w; x+=n) {
+            n = MIN(B16_SP_CHUNK, w-x);
+            yuv_kern.b16_to_b8(uv, src_u + 2*x, 2*n, lshift, bias);
+            yuv_kern.b8_uv_split(dst_u + x, dst_v + x, uv, n);
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  16-bit semi-planar <-> planar of other valid bits, P010 <-> 10-bit 
+ *  planar say. Scales as b16_mch_scale() on the source, as the chain does,
+ *  chroma through a row chunk of scaled samples.
+ */
+int b16_sp_n_p_scale_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    int b_itl = is_semi_planar(pdst->yuvfmt);
+    yuv_seq_t *sp = b_itl ? pdst : psrc;
+    yuv_seq_t *pl = b_itl ? psrc : pdst;
+
+    uint8_t* sp_uv_base = sp->pbuf + sp->y_size;
+    uint8_t* pl_u_base;
+    uint8_t* pl_v_base;
+
+    uint16_t c0[2*B16_SP_CHUNK];
+    uint16_t c1[B16_SP_CHUNK];
+    uint16_t bias[4];
+    int lshift, rshift;
+    int w   = psrc->width;
+    int h   = psrc->height;
+    int x, y, n;
+
+    ENTER_FUNC();
+
+    assert (psrc->nbit == 16 && pdst->nbit == 16);
+    assert (is_semi_planar(sp->yuvfmt));
+    assert (is_planar_swap(pl->yuvfmt, get_spl_fmt(sp->yuvfmt)));
+
+    get_b16_scale(pdst->nlsb, psrc->nlsb, &lshift, &rshift);
+    get_uv_planes(pl, &pl_u_base, &pl_v_base);
+    if (is_uv_swapped(sp->yuvfmt)) {
+        swap_uv(&pl_u_base, &pl_v_base);
+    }
+
+    for (y=0; y<h; ++y) {
+        uint16_t* src_y = (uint16_t*)(psrc->pbuf + y * psrc->y_stride);
+        uint16_t* dst_y = (uint16_t*)(pdst->pbuf + y * pdst->y_stride);
+        get_rnd_bias(bias, pdst->rnd, rshift, y);
+        yuv_kern.b16_shift(dst_y, src_y, w, lshift, rshift, bias);
+    }
+
+    w   = get_uv_width (pl);
+    h   = get_uv_height(pl);
+
+    for (y=0; y<h; ++y) {
+        uint16_t* uv = (uint16_t*)(sp_uv_base + y * sp->uv_stride);
+        uint16_t* u  = (uint16_t*)(pl_u_base  + y * pl->uv_stride);
+        uint16_t* v  = (uint16_t*)(pl_v_base  + y * pl->uv_stride);
+        get_rnd_bias(bias, pdst->rnd, rshift, y);
+        for (x=0; x<w; x+=n) {
+            n = MIN(B16_SP_CHUNK, w-x);
+            if (b_itl) {
+                yuv_kern.b16_shift(c0, u + x, n, lshift, rshift, bias);
+                yuv_kern.b16_shift(c1, v + x, n, lshift, rshift, bias);
+                yuv_kern.b16_uv_merge(uv + 2*x, c0, c1, n);
+            } else {
+                yuv_kern.b16_shift(c0, uv + 2*x, 2*n, lshift, rshift, bias);
+                yuv_kern.b16_uv_split(u + x, v + x, c0, n);
+            }
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  8-bit planar -> 16-bit semi-planar, 8-bit to P010 say
+ */
+int b8_p_2_b16_sp_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* src_u_base;
+    uint8_t* src_v_base;
+    uint8_t* dst_uv_base = pdst->pbuf + pdst->y_size;
+
+    uint16_t u16[B16_SP_CHUNK];
+    uint16_t v16[B16_SP_CHUNK];
+    int nshift = (pdst->nlsb > 0) ? (pdst->nlsb - 8) : 8;
+    int w   = psrc->width;
+    int h   = psrc->height;
+    int x, y, n;
+
+    ENTER_FUNC();
+
+    assert (psrc->nbit == 8 && pdst->nbit == 16);
+    assert (pdst->nlsb >= 8 || pdst->nlsb < 0);
+    assert (is_semi_planar(pdst->yuvfmt));
+    assert (is_planar_swap(psrc->yuvfmt, get_spl_fmt(pdst->yuvfmt)));
+
+    get_uv_planes(psrc, &src_u_base, &src_v_base);
+    if (is_uv_swapped(pdst->yuvfmt)) {
+        swap_uv(&src_u_base, &src_v_base);
+    }
+
+    for (y=0; y<h; ++y) {
+        uint8_t*  src_y = psrc->pbuf + y * psrc->y_stride;
+        uint16_t* dst_y = (uint16_t*)(pdst->pbuf + y * pdst->y_stride);
+        yuv_kern.b8_to_b16(dst_y, src_y, w, nshift);
+    }
+
+    w   = get_uv_width (psrc);
+    h   = get_uv_height(psrc);
+
+    for (y=0; y<h; ++y) {
+        uint8_t*  u  = src_u_base + y * psrc->uv_stride;
+        uint8_t*  v  = src_v_base + y * psrc->uv_stride;
+        uint16_t* uv = (uint16_t*)(dst_uv_base + y * pdst->uv_stride);
+        for (x=0; x<w; x+=n) {
+            n = MIN(B16_SP_CHUNK, w-x);
+            yuv_kern.b8_to_b16(u16, u + x, n, nshift);
+            yuv_kern.b8_to_b16(v16, v + x, n, nshift);
+            yuv_kern.b16_uv_merge(uv + 2*x, u16, v16, n);
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  v210 -> 8-bit 422p, same rounding as b16_n_b8_cvt(), through a row 
+ *  chunk of whole v210 blocks
+ */
+#define V210_CHUNK      240
+
+int v210_2_b8_p_mch(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    uint8_t* dst_u_base;
+    uint8_t* dst_v_base;
+
+    uint16_t y16[V210_CHUNK];
+    uint16_t u16[V210_CHUNK/2];
+    uint16_t v16[V210_CHUNK/2];
+    uint16_t bias[4];
+    int w   = psrc->width;
+    int h   = psrc->height;
+    int x, y, n;
+
+    ENTER_FUNC();
+
+    assert (psrc->yuvfmt == YUVFMT_V210);
+    assert (pdst->yuvfmt == YUVFMT_422P && pdst->nbit == 8);
+
+    get_uv_planes(pdst, &dst_u_base, &dst_v_base);
+
+    for (y=0; y<h; ++y) {
+        uint8_t* src   = psrc->pbuf + y * psrc->y_stride;
+        uint8_t* dst_y = pdst->pbuf + y * pdst->y_stride;
+        uint8_t* dst_u = dst_u_base + y * pdst->uv_stride;
+        uint8_t* dst_v = dst_v_base + y * pdst->uv_stride;
+        get_rnd_bias(bias, pdst->rnd, 8, y);
+        for (x=0; x<w; x+=n) {
+            n = MIN(V210_CHUNK, w-x);
+            yuv_kern.v210_unpack(src + x/6*16, y16, u16, v16, n);
+            yuv_kern.b16_to_b8(dst_y + x,   y16, n,   16 - BIT_10, bias);
+            yuv_kern.b16_to_b8(dst_u + x/2, u16, n/2, 16 - BIT_10, bias);
+            yuv_kern.b16_to_b8(dst_v + x/2, v16, n/2, 16 - BIT_10, bias);
+        }
+    }
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+static int is_sp(int fmt)
+{
+    return is_semi_planar(fmt) && fmt != YUVFMT_420SPA && fmt != YUVFMT_422SPA;
+}
+
+/**
+ *  422 -> 420 of @pdst keeps the even chroma rows as they are
+ */
+static int is_uv_row_drop(yuv_seq_t *pdst)
+{
+    return !is_mch_420(pdst->yuvfmt) || 
+        (pdst->uv_filt == UV_FILT_NEAREST && pdst->uv_site != UV_SITE_BOTTOM);
+}
+
+static int match_b10_tile_2_b8(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 10 && psrc->btile
+        && is_b10_tile_3x4(&psrc->tile) && is_b10_tile_3x4(&psrc->uv_tile)
+        && pdst->rnd == RND_TRUNC
+        && pdst->nbit == 8  && !pdst->btile
+        && pdst->yuvfmt == psrc->yuvfmt
+        && get_spl_fmt(psrc->yuvfmt) != YUVFMT_UNSUPPORT;
+}
+
+static int match_b8_sp_2_p(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 8 && !psrc->btile && is_sp(psrc->yuvfmt)
+        && pdst->nbit == 8 && !pdst->btile
+        && is_planar_swap(pdst->yuvfmt, get_spl_fmt(psrc->yuvfmt));
+}
+
+static int match_b8_yuyv_2_sp(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 8 && !psrc->btile && is_mch_mixed(psrc->yuvfmt)
+        && pdst->nbit == 8 && !pdst->btile && is_sp(pdst->yuvfmt)
+        && !is_mch_444(pdst->yuvfmt)
+        && is_uv_swapped(pdst->yuvfmt) == is_uv_swapped(psrc->yuvfmt)
+        && is_uv_row_drop(pdst);
+}
+
+static int match_b16_yuyv_2_sp(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 16 && !psrc->btile && is_mch_mixed(psrc->yuvfmt)
+        && pdst->nbit == 16 && !pdst->btile && is_sp(pdst->yuvfmt)
+        && !is_mch_444(pdst->yuvfmt)
+        && is_uv_swapped(pdst->yuvfmt) == is_uv_swapped(psrc->yuvfmt)
+        && pdst->nlsb == psrc->nlsb && is_uv_row_drop(pdst);
+}
+
+static int match_b16_sp_2_b8_p(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 16 && !psrc->btile && is_sp(psrc->yuvfmt)
+        && (psrc->nlsb >= 8 || psrc->nlsb < 0)
+        && pdst->nbit == 8  && !pdst->btile
+        && is_planar_swap(pdst->yuvfmt, get_spl_fmt(psrc->yuvfmt));
+}
+
+static int match_b16_sp_n_p_scale(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 16 && !psrc->btile
+        && pdst->nbit == 16 && !pdst->btile
+        && psrc->nlsb != pdst->nlsb
+        && ((is_sp(psrc->yuvfmt) && is_planar_swap(pdst->yuvfmt, get_spl_fmt(psrc->yuvfmt))) ||
+            (is_sp(pdst->yuvfmt) && is_planar_swap(psrc->yuvfmt, get_spl_fmt(pdst->yuvfmt))));
+}
+
+static int match_b8_p_2_b16_sp(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->nbit == 8  && !psrc->btile
+        && pdst->nbit == 16 && !pdst->btile && is_sp(pdst->yuvfmt)
+        && (pdst->nlsb >= 8 || pdst->nlsb < 0)
+        && is_planar_swap(psrc->yuvfmt, get_spl_fmt(pdst->yuvfmt));
+}
+
+static int match_v210_2_b8_p(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    return psrc->yuvfmt == YUVFMT_V210
+        && pdst->nbit == 8 && !pdst->btile && pdst->yuvfmt == YUVFMT_422P;
+}
+
+static const cvt_fused_t cvt_fused[] = {
+    {"b10tile->b8",     match_b10_tile_2_b8,    b10_tile_2_b8_mch   },
+    {"b8 sp->p",        match_b8_sp_2_p,        b8_sp_2_p_mch       },
+    {"b8 yuyv->sp",     match_b8_yuyv_2_sp,     b8_yuyv_2_sp_mch    },
+    {"b16 yuyv->sp",    match_b16_yuyv_2_sp,    b16_yuyv_2_sp_mch   },
+    {"b16 sp->b8 p",    match_b16_sp_2_b8_p,    b16_sp_2_b8_p_mch   },
+    {"b16 sp<->p scale",match_b16_sp_n_p_scale, b16_sp_n_p_scale_mch},
+    {"b8 p->b16 sp",    match_b8_p_2_b16_sp,    b8_p_2_b16_sp_mch   },
+    {"v210->b8 p",      match_v210_2_b8_p,      v210_2_b8_p_mch     },
+};
+
+/**
+ *  @return the fused kernel converting @psrc to @pdst in one pass,
+ *          or 0 if the pair has to go through the stage chain
+ */
+const cvt_fused_t *get_fused_cvt(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    int i;
+    for (i=0; i<ARRAY_SIZE(cvt_fused); ++i) {
+        if (cvt_fused[i].match(pdst, psrc)) {
+            xdbg("@cvt>> fused kernel `%s`\n", cvt_fused[i].name);
+            return &cvt_fused[i];
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,299 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcvt_pipe.c
+ *  @brief Frame pipeline: a reader thread, N converter lanes and the
+ *      calling thread as the in-order writer, so file I/O and conversion
+ *      overlap. Frame i goes through lane (i % N); every queue has one
+ *      producer and one consumer:
+ *
+ *          reader --filled--> lane k --done--> writer --free--> reader
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdio.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+#include "yuvio.h"
+
+#define PIPE_LANE_DEPTH 3       //!< slots per lane: reading, converting, writing
+#define PIPE_EOS        (-1)
+
+typedef struct _pipe_slot
+{
+    int         idx;            //!< frame index, or PIPE_EOS
+    yuv_seq_t   src;            //!< own buffer
+    yuv_seq_t   in;             //!< src, or a view of the mapped input
+    yuv_seq_t  *out;
+    cvt_plan_t  plan;           //!< per slot, as the output lives in its buffers
+    
+} pipe_slot_t;
+
+typedef struct _pipe_lane
+{
+    pthread_t       tid;
+    spsc_queue_t    q_free;     //!< writer -> reader
+    spsc_queue_t    q_filled;   //!< reader -> converter
+    spsc_queue_t    q_done;     //!< converter -> writer
+    pipe_slot_t     slot[PIPE_LANE_DEPTH];
+    
+} pipe_lane_t;
+
+typedef struct _cvt_pipe
+{
+    yuv_io_t       *in;
+    yuv_io_t       *out;
+    int             frame_range[2];
+    int             n_lane;
+    pipe_lane_t    *lane;
+    pthread_t       reader;
+    int             b_stop;     //!< set by the writer on error
+    
+} cvt_pipe_t;
+
+
+static void *pipe_reader(void *arg)
+{
+    cvt_pipe_t  *pipe = (cvt_pipe_t *)arg;
+    int i, k;
+    
+    for (i=pipe->frame_range[0]; ; ++i) 
+    {
+        pipe_lane_t *lane = &pipe->lane[(i - pipe->frame_range[0]) % pipe->n_lane];
+        pipe_slot_t *slot = (pipe_slot_t *)spsc_pop(&lane->q_free);
+        int idx = PIPE_EOS;
+        
+        if (i < pipe->frame_range[1] && 
+            !__atomic_load_n(&pipe->b_stop, __ATOMIC_RELAXED)) 
+        {
+            slot->in.pbuf = yuv_io_read(pipe->in, i, slot->src.pbuf);
+            if (slot->in.pbuf) {
+                idx = i;
+            } else if (pipe->in->b_eof) {
+                xinfo("@seq> reach file end, force stop\n");
+            }
+        }
+        
+        slot->idx = idx;
+        spsc_push(&lane->q_filled, slot);
+        if (idx == PIPE_EOS) {
+            break;
+        }
+    }
+    
+    /**
+     *  end the other lanes too. The writer keeps draining the frames
+     *  before #i, so a free slot shows up in each of them.
+     */
+    for (k=1; k<pipe->n_lane; ++k) {
+        pipe_lane_t *lane = &pipe->lane[(i - pipe->frame_range[0] + k) % pipe->n_lane];
+        pipe_slot_t *slot = (pipe_slot_t *)spsc_pop(&lane->q_free);
+        slot->idx = PIPE_EOS;
+        spsc_push(&lane->q_filled, slot);
+    }
+    
+    return 0;
+}
+
+static void *pipe_converter(void *arg)
+{
+    pipe_lane_t *lane = (pipe_lane_t *)arg;
+    pipe_slot_t *slot;
+    int idx;
+    
+    /**
+     *  the slot belongs to the writer once pushed, so @idx is kept aside
+     */
+    do {
+        slot = (pipe_slot_t *)spsc_pop(&lane->q_filled);
+        idx  = slot->idx;
+        if (idx != PIPE_EOS) {
+            slot->out = cvt_plan_run(&slot->plan, &slot->in);
+        }
+        spsc_push(&lane->q_done, slot);
+    } while (idx != PIPE_EOS);
+    
+    return 0;
+}
+
+static void cvt_pipe_free(cvt_pipe_t *pipe)
+{
+    int k, j;
+    
+    for (k=0; k<pipe->n_lane; ++k) {
+        pipe_lane_t *lane = &pipe->lane[k];
+        for (j=0; j<PIPE_LANE_DEPTH; ++j) {
+            cvt_plan_free(&lane->slot[j].plan);
+            yuv_buf_free (&lane->slot[j].src);
+        }
+        spsc_free(&lane->q_free);
+        spsc_free(&lane->q_filled);
+        spsc_free(&lane->q_done);
+    }
+    free(pipe->lane);
+}
+
+static int cvt_pipe_init(cvt_pipe_t *pipe, yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    int k, j;
+    
+    pipe->lane = (pipe_lane_t *)calloc(pipe->n_lane, sizeof(pipe_lane_t));
+    if (!pipe->lane) {
+        xerr("@pipe>> malloc for %d lanes failed\n", pipe->n_lane);
+        return -1;
+    }
+    
+    for (k=0; k<pipe->n_lane; ++k) 
+    {
+        pipe_lane_t *lane = &pipe->lane[k];
+        
+        if (spsc_init(&lane->q_free,   PIPE_LANE_DEPTH) < 0 ||
+            spsc_init(&lane->q_filled, PIPE_LANE_DEPTH) < 0 ||
+            spsc_init(&lane->q_done,   PIPE_LANE_DEPTH) < 0) {
+            return -1;
+        }
+        for (j=0; j<PIPE_LANE_DEPTH; ++j) {
+            pipe_slot_t *slot = &lane->slot[j];
+            
+            if (cvt_plan_init(&slot->plan, pdst, psrc, CVT_PLAN_PAD_ON_WRITE) < 0) {
+                return -1;
+            }
+            set_yuv_prop_by_copy(&slot->src, 1, psrc);
+            if (!slot->src.pbuf) {
+                xerr("@pipe>> malloc for src frame failed\n");
+                return -1;
+            }
+            memcpy(&slot->in, &slot->src, sizeof(yuv_seq_t));
+            spsc_push(&lane->q_free, slot);
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ *  @brief convert frames @frame_range of @in into @out with @n_lane 
+ *      converter threads. Output is written in frame order by the calling
+ *      thread.
+ *  @return number of frames written, or -1 if the pipeline could not start
+ */
+int cvt_pipe_run(yuv_io_t *in, yuv_io_t *out, int frame_range[2], 
+                 yuv_seq_t *pdst, yuv_seq_t *psrc, int n_lane)
+{
+    cvt_pipe_t   pipe;
+    pipe_slot_t *slot;
+    pipe_slot_t *held      = 0;
+    pipe_lane_t *held_lane = 0;
+    int i, k, r;
+    int n_lane_up = 0;
+    int n_frame   = 0;
+    
+    ENTER_FUNC();
+    
+    memset(&pipe, 0, sizeof(pipe));
+    pipe.in             = in;
+    pipe.out            = out;
+    pipe.frame_range[0] = frame_range[0];
+    pipe.frame_range[1] = frame_range[1];
+    pipe.n_lane         = MAX(n_lane, 1);
+    
+    if (cvt_pipe_init(&pipe, pdst, psrc) < 0) {
+        cvt_pipe_free(&pipe);
+        return -1;
+    }
+    in->n_keep = pipe.n_lane * PIPE_LANE_DEPTH;
+    
+    for (k=0; k<pipe.n_lane; ++k) {
+        if (pthread_create(&pipe.lane[k].tid, 0, pipe_converter, &pipe.lane[k])) {
+            xerr("@pipe>> pthread_create() failed for lane #%d\n", k);
+            break;
+        }
+        n_lane_up++;
+    }
+    if (n_lane_up < pipe.n_lane || 
+        pthread_create(&pipe.reader, 0, pipe_reader, &pipe)) {
+        /**
+         *  started lanes are ended by hand, they are still at their
+         *  first pop
+         */
+        for (k=0; k<n_lane_up; ++k) {
+            slot = (pipe_slot_t *)spsc_pop(&pipe.lane[k].q_free);
+            slot->idx = PIPE_EOS;
+            spsc_push(&pipe.lane[k].q_filled, slot);
+            pthread_join(pipe.lane[k].tid, 0);
+        }
+        cvt_pipe_free(&pipe);
+        return -1;
+    }
+    xlog(SLOG_CMDL, "@cfg>> ", "pipeline of %d converter(s)\n", pipe.n_lane);
+    
+    /*************************************************************************
+     *                          writer loop
+     ************************************************************************/
+    for (i=0; ; ++i) 
+    {
+        pipe_lane_t *lane = &pipe.lane[i % pipe.n_lane];
+        
+        slot = (pipe_slot_t *)spsc_pop(&lane->q_done);
+        if (slot->idx == PIPE_EOS) {
+            break;
+        }
+        
+        if (!__atomic_load_n(&pipe.b_stop, __ATOMIC_RELAXED)) {
+            r = yuv_io_write(out, slot->out, &slot->plan.dst);
+            if (r<0) {
+                xerr("error writing file\n");
+                __atomic_store_n(&pipe.b_stop, 1, __ATOMIC_RELAXED);
+            } else {
+                xprint("@frm> #%d -\n", slot->idx);
+                n_frame++;
+            }
+        }
+        
+        /**
+         *  a vmsplice()d frame is still read from its buffer until the
+         *  next one is spliced
+         */
+        if (out->b_splice) {
+            pipe_slot_t *s = held;
+            pipe_lane_t *l = held_lane;
+            held      = slot;
+            held_lane = lane;
+            slot      = s;
+            lane      = l;
+        }
+        if (slot) {
+            spsc_push(&lane->q_free, slot);
+        }
+    }
+    if (held) {
+        spsc_push(&held_lane->q_free, held);
+    }
+    
+    pthread_join(pipe.reader, 0);
+    for (k=0; k<pipe.n_lane; ++k) {
+        pthread_join(pipe.lane[k].tid, 0);
+    }
+    cvt_pipe_free(&pipe);
+    
+    LEAVE_FUNC();
+    
+    return n_frame;
+}
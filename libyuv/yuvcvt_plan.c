@@ -0,0 +1,696 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcvt_plan.c
+ *  @brief Conversion plan: the stage sequence from one yuv layout to
+ *      another, decided once per (src, dst) pair. A plan built with
+ *      cvt_plan_init() owns the intermediate buffers and the scaling
+ *      taps, so cvt_plan_run() is a straight call of the resolved kernels,
+ *      allocating no more than the scaler's scratch rows.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdio.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+/**
+ *  stage kernels, wrapped to the (pdst, psrc) order
+ */
+static int stg_bn_untile (yuv_seq_t *d, yuv_seq_t *s) { return bn_tile_unpack_mch(s, d, B10_2_B16); }
+static int stg_bn_unpack (yuv_seq_t *d, yuv_seq_t *s) { return bn_rect_unpack_mch(s, d, B10_2_B16); }
+static int stg_v210_unpack(yuv_seq_t *d, yuv_seq_t *s) { return v210_unpack_mch(s, d, B10_2_B16); }
+static int stg_b8_untile (yuv_seq_t *d, yuv_seq_t *s) { b8_tile_2_mch(s, d, TILE2RECT); return 0; }
+static int stg_b16_to_b8 (yuv_seq_t *d, yuv_seq_t *s) { return b16_n_b8_cvt_mch(s, d, B16_2_B8); }
+static int stg_b8_to_b16 (yuv_seq_t *d, yuv_seq_t *s) { return b16_n_b8_cvt_mch(d, s, B8_2_B16); }
+static int stg_b16_scale (yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_scale(d, s); }
+static int stg_b8_sp_spl (yuv_seq_t *d, yuv_seq_t *s) { return b8_mch_sp2p(s, d, SPLITTING); }
+static int stg_b16_sp_spl(yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_sp2p(s, d, SPLITTING); }
+static int stg_b8_yuyv_spl (yuv_seq_t *d, yuv_seq_t *s) { return b8_mch_yuyv2p(s, d, SPLITTING); }
+static int stg_b16_yuyv_spl(yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_yuyv2p(s, d, SPLITTING); }
+static int stg_b8_yuyv_sp  (yuv_seq_t *d, yuv_seq_t *s) { return b8_yuyv_2_sp_mch(d, s); }
+static int stg_b16_yuyv_sp (yuv_seq_t *d, yuv_seq_t *s) { return b16_yuyv_2_sp_mch(d, s); }
+static int stg_uv_hresample(yuv_seq_t *d, yuv_seq_t *s) { return yuv_uv_hresample(d, s); }
+static int stg_uv_reorder  (yuv_seq_t *d, yuv_seq_t *s) { return yuv_uv_reorder(d, s); }
+static int stg_uv_swap     (yuv_seq_t *d, yuv_seq_t *s) { return yuv_copy_frame(d, s); }
+static int stg_b8_p2p    (yuv_seq_t *d, yuv_seq_t *s) { return b8_mch_p2p(d, s); }
+static int stg_b16_p2p   (yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_p2p(d, s); }
+static int stg_b8_sp_itl (yuv_seq_t *d, yuv_seq_t *s) { return b8_mch_sp2p(d, s, INTERLACING); }
+static int stg_b16_sp_itl(yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_sp2p(d, s, INTERLACING); }
+static int stg_b8_yuyv_itl (yuv_seq_t *d, yuv_seq_t *s) { return b8_mch_yuyv2p(d, s, INTERLACING); }
+static int stg_b16_yuyv_itl(yuv_seq_t *d, yuv_seq_t *s) { return b16_mch_yuyv2p(d, s, INTERLACING); }
+static int stg_bn_tile   (yuv_seq_t *d, yuv_seq_t *s) { return bn_tile_unpack_mch(d, s, B16_2_B10); }
+static int stg_bn_pack   (yuv_seq_t *d, yuv_seq_t *s) { return bn_rect_unpack_mch(d, s, B16_2_B10); }
+static int stg_v210_pack (yuv_seq_t *d, yuv_seq_t *s) { return v210_unpack_mch(d, s, B16_2_B10); }
+static int stg_b8_tile   (yuv_seq_t *d, yuv_seq_t *s) { b8_tile_2_mch(d, s, RECT2TILE); return 0; }
+static int stg_copy      (yuv_seq_t *d, yuv_seq_t *s) { return yuv_copy_frame(d, s); }
+
+/**
+ *  band kernels, whole frames in, output rows [y0, y0+h)
+ */
+static int rows_uv_resample(yuv_seq_t *d, yuv_seq_t *s, int y0, int h, void *ctx) 
+{ 
+    return yuv_uv_resample(d, s, y0, h); 
+}
+static int rows_scale(yuv_seq_t *d, yuv_seq_t *s, int y0, int h, void *ctx) 
+{ 
+    return yuv_scale_rows(d, s, y0, h, (yuv_scaler_t *)ctx); 
+}
+
+static int lcm(int a, int b)
+{
+    int x = a, y = b, t;
+    while (y) {
+        t = x % y;  x = y;  y = t;
+    }
+    return a / x * b;
+}
+
+/**
+ *  @return planar (@b_sp = 0) or semi-planar format of the chroma sampling 
+ *      of @like, v first if @b_swap and there is such a format
+ */
+static int get_uv_fmt(int b_sp, int like, int b_swap)
+{
+    static const int fmt_tab[2][3][2] = {
+        {{YUVFMT_420P,  YUVFMT_YV12}, {YUVFMT_422P,  YUVFMT_422P}, {YUVFMT_444P,  YUVFMT_444P }},
+        {{YUVFMT_420SP, YUVFMT_NV21}, {YUVFMT_422SP, YUVFMT_NV61}, {YUVFMT_444SP, YUVFMT_444SP}},
+    };
+    int ds = is_mch_420(like) ? 0 : is_mch_422(like) ? 1 : 2;
+    
+    return fmt_tab[b_sp ? 1 : 0][ds][b_swap ? 1 : 0];
+}
+
+/**
+ *  @return the layout of @cur with the chroma sampling of @like. Planar
+ *      chroma takes the plane order of @dst, as a later stage would have 
+ *      to swap them otherwise.
+ */
+static int get_resampled_fmt(yuv_seq_t *cur, yuv_seq_t *dst, int like)
+{
+    int fmt = cur->yuvfmt;
+    
+    if (fmt == YUVFMT_420SPA || fmt == YUVFMT_422SPA) {
+        return is_mch_420(like) ? YUVFMT_420SPA : YUVFMT_422SPA;
+    }
+    if (is_semi_planar(fmt)) {
+        return get_uv_fmt(1, like, is_uv_swapped(fmt));
+    }
+    return get_uv_fmt(0, like, is_uv_swapped(is_mch_planar(dst->yuvfmt) ? dst->yuvfmt : fmt));
+}
+
+/**
+ *  @return output format of a depth stage: that of @src, or of @dst if
+ *      it only swaps the planes, which the depth kernels do for free
+ */
+static int get_depth_fmt(yuv_seq_t *dst, yuv_seq_t *src)
+{
+    return is_planar_swap(dst->yuvfmt, src->yuvfmt) ? dst->yuvfmt : src->yuvfmt;
+}
+
+/**
+ *  luma rows a band of @yuv has to start on: a tile row, or a pair of 
+ *  them for Z/N scans, in both planes
+ */
+static int get_band_align(yuv_seq_t *yuv)
+{
+    int ds_h  = MAX(get_uv_ds_ratio_h(yuv->yuvfmt), 1);
+    int align = ds_h;
+    
+    if (yuv->btile) {
+        int g = (yuv->tile.scan == TILE_SCAN_RASTER) ? 1 : 2;
+        align = lcm(g * yuv->tile.th, g * yuv->uv_tile.th * ds_h);
+    }
+    return align;
+}
+
+/**
+ *  append a stage; its output layout is given as for set_yuv_prop(), in
+ *  the size of the previous output
+ *  @return layout of the stage output, which is the next stage's input
+ */
+static yuv_seq_t *plan_add
+(
+    cvt_plan_t *plan, const char *name, cvt_stage_fp fp,
+    int fmt, int nbit, int nlsb, int btile, int stride, int io_size
+)
+{
+    cvt_stage_t *stg = &plan->stage[plan->n_stage++];
+    yuv_seq_t   *in  = (plan->n_stage > 1) ? &stg[-1].out : &plan->src;
+
+    assert(plan->n_stage <= CVT_MAX_STAGE);
+
+    memset(stg, 0, sizeof(cvt_stage_t));
+    stg->name   = name;
+    stg->fp     = fp;
+    stg->b_band = 1;
+    stg->out.rnd = plan->dst.rnd;
+    stg->out.uv_filt = plan->dst.uv_filt;
+    stg->out.uv_site = plan->dst.uv_site;
+    stg->out.scl_filt = plan->dst.scl_filt;
+    if (btile) {
+        memcpy(&stg->out.tile,    &plan->dst.tile,    sizeof(tile_t));
+        memcpy(&stg->out.uv_tile, &plan->dst.uv_tile, sizeof(tile_t));
+    }
+    set_yuv_prop(&stg->out, 0, in->width, in->height,
+            fmt, nbit, nlsb, btile, stride, io_size);
+
+    return &stg->out;
+}
+
+/**
+ *  append the resize of @cur to the size of the plan output, in a layout
+ *  the scaler takes: 16-bit samples LSB aligned, chroma in planes of its own
+ *  @return layout of the scaled output, 0 on failure
+ */
+static yuv_seq_t *plan_scale(cvt_plan_t *plan, yuv_seq_t *cur)
+{
+    yuv_seq_t   *in;
+    cvt_stage_t *stg;
+
+    if (cur->nbit == 16 && cur->nlsb < 0) {
+        cur = plan_add(plan, "b16 scale", stg_b16_scale,
+                cur->yuvfmt, BIT_16, -cur->nlsb, TILE_0, 0, 0);
+    }
+    if (is_mch_mixed(cur->yuvfmt)) {
+        cur = plan_add(plan, "yuyv split",
+                (cur->nbit==8) ? stg_b8_yuyv_spl : stg_b16_yuyv_spl,
+                YUVFMT_422P, cur->nbit, cur->nlsb, TILE_0, 0, 0);
+    }
+    in  = cur;
+    cur = plan_add(plan, "scale", 0, in->yuvfmt, in->nbit, in->nlsb, TILE_0, 0, 0);
+    set_yuv_prop(cur, 0, plan->dst.width, plan->dst.height, 
+            cur->yuvfmt, cur->nbit, cur->nlsb, TILE_0, 0, 0);
+    
+    stg = &plan->stage[plan->n_stage-1];
+    stg->fp_rows = rows_scale;
+    stg->ctx     = yuv_scaler_init(cur, in);
+    
+    return stg->ctx ? cur : 0;
+}
+
+/**
+ *  decide the stage sequence from @psrc to @pdst. No buffer is touched.
+ */
+static int cvt_plan_compile(cvt_plan_t *plan, yuv_seq_t *pdst, yuv_seq_t *psrc,
+                            int flags)
+{
+    yuv_seq_t *src = &plan->src;
+    yuv_seq_t *dst = &plan->dst;
+    yuv_seq_t *cur = src;
+    yuv_seq_t *tgt = dst;       //!< what the depth and fmt stages aim at
+    yuv_seq_t  wrk;
+    const cvt_fused_t *fused;
+    int b_scale, b_down, lsb;
+
+    memset(plan, 0, sizeof(cvt_plan_t));
+    memcpy(src, psrc, sizeof(yuv_seq_t));
+    memcpy(dst, pdst, sizeof(yuv_seq_t));
+    src->pbuf = dst->pbuf = 0;
+    src->buf_size = dst->buf_size = 0;
+
+    /**
+     *  a downscale goes as early as the layout allows, an upscale as late,
+     *  so the stages in between run on the smaller frames
+     */
+    b_scale = (dst->width != src->width || dst->height != src->height);
+    b_down  = b_scale && (int64_t)dst->width * dst->height <= 
+                         (int64_t)src->width * src->height;
+
+    /**
+     *  single-pass kernel, writing straight into the final layout
+     */
+    fused = b_scale ? 0 : get_fused_cvt(dst, src);
+    if (fused) {
+        cur = plan_add(plan, fused->name, fused->cvt, dst->yuvfmt,
+                dst->nbit, dst->nlsb, dst->btile, 0, 0);
+        goto replace;
+    }
+
+    /**
+     *  v210 is packed into and out of 422p of 10-bit in 16
+     */
+    if (dst->yuvfmt == YUVFMT_V210) {
+        memcpy(&wrk, dst, sizeof(yuv_seq_t));
+        wrk.yuvfmt = YUVFMT_422P;
+        wrk.nbit   = BIT_16;
+        wrk.nlsb   = BIT_10;
+        tgt = &wrk;
+    }
+    
+    /**
+     *  the scaler takes 16-bit samples LSB aligned, an upscale keeps them
+     *  so up to its end
+     */
+    lsb = (b_scale && !b_down && tgt->nlsb < 0) ? -tgt->nlsb : tgt->nlsb;
+
+    /**
+     *  v210-unpack, bn-untile/unpack, b8-untile
+     */
+    if (src->yuvfmt == YUVFMT_V210)
+    {
+        cur = plan_add(plan, "v210 unpack", stg_v210_unpack,
+                YUVFMT_422P, BIT_16, BIT_10, TILE_0, 0, 0);
+    }
+    else if (is_packed_bit(src->nbit))
+    {
+        cur = plan_add(plan, src->btile ? "bn untile" : "bn unpack",
+                src->btile ? stg_bn_untile : stg_bn_unpack,
+                src->yuvfmt, BIT_16, src->nbit, TILE_0, 0, 0);
+    }
+    else if (src->nbit==8 && src->btile)
+    {
+        cur = plan_add(plan, "b8 untile", stg_b8_untile,
+                src->yuvfmt, BIT_8, BIT_8, TILE_0, 0, 0);
+    }
+    if (b_down && !(cur = plan_scale(plan, cur))) {
+        return -1;
+    }
+
+    /**
+     *  bit-shift
+     */
+    if (cur->nbit != tgt->nbit) {
+        if (cur->nbit==16 && tgt->nbit==8) {
+            cur = plan_add(plan, "b16->b8", stg_b16_to_b8,
+                    get_depth_fmt(tgt, cur), BIT_8, BIT_8, TILE_0, 0, 0);
+        }
+        else if (cur->nbit==8 && tgt->nbit>8) {
+            cur = plan_add(plan, "b8->b16", stg_b8_to_b16,
+                    get_depth_fmt(tgt, cur), BIT_16, 
+                    is_packed_bit(tgt->nbit) ? tgt->nbit : lsb, TILE_0, 0, 0);
+        }
+        else if (cur->nbit==16 && is_packed_bit(tgt->nbit) && cur->nlsb != tgt->nbit) {
+            cur = plan_add(plan, "b16 scale", stg_b16_scale,
+                    get_depth_fmt(tgt, cur), BIT_16, tgt->nbit, TILE_0, 0, 0);
+        }
+    } else if (tgt->nbit == 16) {
+        if (cur->nlsb != lsb) {
+            cur = plan_add(plan, "b16 scale", stg_b16_scale,
+                    get_depth_fmt(tgt, cur), BIT_16, lsb, TILE_0, 0, 0);
+        }
+    }
+
+    /**
+     *  upscale, here if the target mixes luma and chroma, or after the 
+     *  fmt convertion; an MSB aligned target is restored at last
+     */
+    if (b_scale && !b_down && is_mch_mixed(tgt->yuvfmt)) {
+        if (!(cur = plan_scale(plan, cur))) {
+            return -1;
+        }
+        b_scale = 0;
+    }
+
+    /**
+     * fmt convertion.
+     */
+    if (cur->yuvfmt != tgt->yuvfmt)
+    {
+        int nbit = cur->nbit;
+        int nlsb = cur->nlsb;
+        uint8_t perm[4];
+        assert(nbit == 8 || nbit == 16);
+
+        // only the sample order within the rows differs
+        if (get_uv_shuf4(tgt->yuvfmt, cur->yuvfmt, perm)) {
+            cur = plan_add(plan, "uv reorder", stg_uv_reorder,
+                    tgt->yuvfmt, nbit, nlsb, TILE_0, 0, 0);
+        }
+
+        // uv de-interlace, unless the chroma stays semi-planar
+        if (is_mch_mixed(cur->yuvfmt) && cur->yuvfmt != tgt->yuvfmt) {
+            if (is_semi_planar(tgt->yuvfmt) && !is_mch_444(tgt->yuvfmt)) {
+                cur = plan_add(plan, "yuyv->sp",
+                        (nbit==8) ? stg_b8_yuyv_sp : stg_b16_yuyv_sp,
+                        get_uv_fmt(1, YUVFMT_422SP, is_uv_swapped(cur->yuvfmt)), 
+                        nbit, nlsb, TILE_0, 0, 0);
+            } else {
+                cur = plan_add(plan, "yuyv split",
+                        (nbit==8) ? stg_b8_yuyv_spl : stg_b16_yuyv_spl,
+                        YUVFMT_422P, nbit, nlsb, TILE_0, 0, 0);
+            }
+        } else if (is_semi_planar(cur->yuvfmt) && !is_semi_planar(tgt->yuvfmt)) {
+            cur = plan_add(plan, "sp split",
+                    (nbit==8) ? stg_b8_sp_spl : stg_b16_sp_spl,
+                    get_uv_fmt(0, cur->yuvfmt, is_mch_planar(tgt->yuvfmt) && 
+                                               is_uv_swapped(tgt->yuvfmt)), 
+                    nbit, nlsb, TILE_0, 0, 0);
+        }
+
+        // uv re-sample: 444 -> 422 along the rows, 420 <-> 422 across 
+        // them, 422 -> 444 along the rows, in the layout at hand
+        if (is_mch_444(cur->yuvfmt) && !is_mch_444(tgt->yuvfmt) 
+                && tgt->yuvfmt != YUVFMT_400P) {
+            cur = plan_add(plan, "uv h-resample", stg_uv_hresample,
+                    get_resampled_fmt(cur, tgt, YUVFMT_422P), 
+                    nbit, nlsb, TILE_0, 0, 0);
+        }
+        if ((is_mch_420(cur->yuvfmt) && (is_mch_422(tgt->yuvfmt) || is_mch_444(tgt->yuvfmt))) ||
+            (is_mch_422(cur->yuvfmt) && is_mch_420(tgt->yuvfmt)))
+        {
+            cur = plan_add(plan, "uv resample", 0,
+                    get_resampled_fmt(cur, tgt, is_mch_420(cur->yuvfmt) ? YUVFMT_422P : YUVFMT_420P), 
+                    nbit, nlsb, TILE_0, 0, 0);
+            plan->stage[plan->n_stage-1].fp_rows = rows_uv_resample;
+        }
+        if (is_mch_422(cur->yuvfmt) && is_mch_444(tgt->yuvfmt)) {
+            cur = plan_add(plan, "uv h-resample", stg_uv_hresample,
+                    get_resampled_fmt(cur, tgt, YUVFMT_444P), 
+                    nbit, nlsb, TILE_0, 0, 0);
+        }
+        if (get_spl_fmt(cur->yuvfmt) != get_spl_fmt(tgt->yuvfmt))
+        {
+            cur = plan_add(plan, "p2p", (nbit==8) ? stg_b8_p2p : stg_b16_p2p,
+                    get_spl_fmt(tgt->yuvfmt), nbit, nlsb, TILE_0, 0, 0);
+        }
+
+        // uv interlace, or what is left of the uv order
+        if (cur->yuvfmt != tgt->yuvfmt)
+        {
+            if (is_semi_planar(tgt->yuvfmt) && !is_semi_planar(cur->yuvfmt)) {
+                cur = plan_add(plan, "sp interlace",
+                        (nbit==8) ? stg_b8_sp_itl : stg_b16_sp_itl,
+                        tgt->yuvfmt, nbit, nlsb, TILE_0, 0, 0);
+            } else if (is_mch_mixed(tgt->yuvfmt)) {
+                cur = plan_add(plan, "yuyv interlace",
+                        (nbit==8) ? stg_b8_yuyv_itl : stg_b16_yuyv_itl,
+                        tgt->yuvfmt, nbit, nlsb, TILE_0, 0, 0);
+            } else if (get_uv_shuf4(tgt->yuvfmt, cur->yuvfmt, perm)) {
+                cur = plan_add(plan, "uv reorder", stg_uv_reorder,
+                        tgt->yuvfmt, nbit, nlsb, TILE_0, 0, 0);
+            } else if (is_planar_swap(tgt->yuvfmt, cur->yuvfmt)) {
+                cur = plan_add(plan, "uv swap", stg_uv_swap,
+                        tgt->yuvfmt, nbit, nlsb, TILE_0, 0, 0);
+            }
+        }
+    }
+
+    if (b_scale && !b_down && !(cur = plan_scale(plan, cur))) {
+        return -1;
+    }
+    if (cur->nbit == 16 && tgt->nbit == 16 && cur->nlsb != tgt->nlsb) {
+        cur = plan_add(plan, "b16 scale", stg_b16_scale,
+                cur->yuvfmt, BIT_16, tgt->nlsb, TILE_0, 0, 0);
+    }
+
+    /**
+     *  v210-pack, bn-tile/pack, b8-tile
+     */
+    if (dst->yuvfmt == YUVFMT_V210)
+    {
+        cur = plan_add(plan, "v210 pack", stg_v210_pack,
+                dst->yuvfmt, BIT_10, BIT_10, TILE_0, 0, 0);
+    }
+    else if (is_packed_bit(dst->nbit))
+    {
+        if (dst->btile) {
+            cur = plan_add(plan, "bn tile", stg_bn_tile,
+                    dst->yuvfmt, dst->nbit, dst->nbit, TILE_1, 0, 0);
+        } else {
+            cur = plan_add(plan, "bn pack", stg_bn_pack,
+                    dst->yuvfmt, dst->nbit, dst->nbit, TILE_0, 0, 0);
+        }
+    }
+    else if (dst->nbit==8 && dst->btile)
+    {
+        cur = plan_add(plan, "b8 tile", stg_b8_tile,
+                dst->yuvfmt, BIT_8, BIT_8, TILE_1, 0, 0);
+    }
+
+    /**
+     *  a double buffered output needs a stage to write it
+     */
+    if (plan->n_stage == 0 && (flags & CVT_PLAN_DOUBLE_OUT)) {
+        cur = plan_add(plan, "copy", stg_copy, src->yuvfmt, src->nbit, 
+                src->nlsb, src->btile, src->y_stride, src->io_size);
+    }
+
+replace:
+    /**
+     *  buf re-placement: left to the writer, or folded into the last
+     *  linear stage, which takes any output stride. A bare copy is the
+     *  fallback.
+     */
+    if (cur->y_stride != dst->y_stride ||
+        cur->io_size  != dst->io_size  )
+    {
+        if (flags & CVT_PLAN_PAD_ON_WRITE) {
+            return 0;
+        }
+        if (plan->n_stage > 0 && !cur->btile) {
+            set_yuv_prop(cur, 0, cur->width, cur->height, cur->yuvfmt, 
+                    cur->nbit, cur->nlsb, cur->btile, 
+                    dst->y_stride, dst->io_size);
+        } else {
+            cur = plan_add(plan, "copy", stg_copy, dst->yuvfmt, dst->nbit, 
+                    dst->nlsb, dst->btile, dst->y_stride, dst->io_size);
+        }
+    }
+
+    return 0;
+}
+
+/**
+ *  @brief build the plan converting frames of layout @psrc to @pdst,
+ *      and allocate its intermediate buffers.
+ *  @param [in] flags CVT_PLAN_PAD_ON_WRITE: the output keeps its natural
+ *      stride/iosize, and the padding of @pdst is added by yuv_io_write()
+ *      CVT_PLAN_DOUBLE_OUT: the output alternates between two buffers, so
+ *      the previous one holds while the next frame is converted
+ *  @return 0 on success
+ */
+int cvt_plan_init(cvt_plan_t *plan, yuv_seq_t *pdst, yuv_seq_t *psrc, int flags)
+{
+    int k, size[3] = {0, 0, 0};
+
+    ENTER_FUNC();
+
+    if (cvt_plan_compile(plan, pdst, psrc, flags) < 0) {
+        xerr("@cvt>> no plan from %dx%d to %dx%d\n", 
+                psrc->width, psrc->height, pdst->width, pdst->height);
+        cvt_plan_free(plan);
+        return -1;
+    }
+    plan->flags = flags;
+
+    for (k=0; k<plan->n_stage; ++k) {
+        size[k&1] = MAX(size[k&1], plan->stage[k].out.io_size + CVT_BUF_PAD);
+    }
+    if (plan->n_stage > 0 && (flags & CVT_PLAN_DOUBLE_OUT)) {
+        size[2] = plan->stage[plan->n_stage-1].out.io_size + CVT_BUF_PAD;
+    }
+    for (k=0; k<3; ++k) {
+        if (size[k] && yuv_buf_realloc(&plan->buf[k], size[k]) < size[k]) {
+            xerr("@cvt>> plan buffer allocation failed\n");
+            cvt_plan_free(plan);
+            return -1;
+        }
+    }
+    for (k=0; k<3; ++k) {
+        if (plan->buf[k].pbuf) {
+            memset(plan->buf[k].pbuf, 0, plan->buf[k].buf_size);
+        }
+    }
+    for (k=0; k<plan->n_stage; ++k) {
+        plan->stage[k].out.pbuf     = plan->buf[k&1].pbuf;
+        plan->stage[k].out.buf_size = plan->buf[k&1].buf_size;
+    }
+
+    /**
+     *  a band has to start on a tile row (pair) of every layout on the way, 
+     *  and on a chroma row for 420. Dithering also keeps the 4-row pattern
+     *  of both planes in phase.
+     */
+    plan->band_align = lcm(2, get_band_align(&plan->src));
+    if (plan->dst.rnd == RND_DITHER) {
+        plan->band_align = lcm(plan->band_align, 8);
+    }
+    for (k=0; k<plan->n_stage; ++k) {
+        plan->band_align = lcm(plan->band_align, get_band_align(&plan->stage[k].out));
+    }
+    thr_pool_init(&plan->pool, 1);
+
+    show_cvt_plan(plan, SLOG_CMDL, "@cfg>> plan: ");
+
+    LEAVE_FUNC();
+
+    return 0;
+}
+
+/**
+ *  @brief run the plan stages in row bands on @n_thread threads
+ *  @return 0 on success
+ */
+int cvt_plan_threads(cvt_plan_t *plan, int n_thread)
+{
+    thr_pool_free(&plan->pool);
+    if (thr_pool_init(&plan->pool, n_thread) < 0) {
+        xerr("@cvt>> only %d of %d threads started\n",
+                plan->pool.n_thread, n_thread);
+        return -1;
+    }
+    xlog(SLOG_CMDL, "@cfg>> ", "%d thread(s), band aligned to %d rows\n",
+            plan->pool.n_thread, plan->band_align);
+    return 0;
+}
+
+typedef struct _band_job
+{
+    cvt_stage_t *stg;
+    yuv_seq_t   *in;
+    int          band_h;
+    
+} band_job_t;
+
+static int stage_run(cvt_stage_t *stg, yuv_seq_t *out, yuv_seq_t *in)
+{
+    if (stg->fp_rows) {
+        return stg->fp_rows(out, in, 0, out->height, stg->ctx);
+    }
+    return stg->fp(out, in);
+}
+
+static void stage_band_job(void *arg, int job)
+{
+    band_job_t *bj = (band_job_t *)arg;
+    yuv_seq_t   dst, src;
+    int y0 = job * bj->band_h;
+    int h  = MIN(bj->band_h, bj->stg->out.height - y0);
+    
+    if (bj->stg->fp_rows) {
+        bj->stg->fp_rows(&bj->stg->out, bj->in, y0, h, bj->stg->ctx);
+        return;
+    }
+    yuv_band_view(&dst, &bj->stg->out, y0, h);
+    yuv_band_view(&src, bj->in, y0, h);
+    bj->stg->fp(&dst, &src);
+}
+
+/**
+ *  @param [in] psrc frame laid out as the plan source. It is only read.
+ *  @return the plan output, either @psrc itself or a plan owned buffer
+ *      which holds up to the next cvt_plan_run(), or the one after with
+ *      CVT_PLAN_DOUBLE_OUT
+ */
+yuv_seq_t *cvt_plan_run(cvt_plan_t *plan, yuv_seq_t *psrc)
+{
+    yuv_seq_t *cur = psrc;
+    band_job_t bj;
+    int k;
+
+    if (plan->buf[2].pbuf) {
+        yuv_seq_t *out = &plan->stage[plan->n_stage-1].out;
+        yuv_seq_t *buf = &plan->buf[(plan->n_run & 1) ? 2 : (plan->n_stage-1) & 1];
+        out->pbuf     = buf->pbuf;
+        out->buf_size = buf->buf_size;
+    }
+    plan->n_run++;
+
+    for (k=0; k<plan->n_stage; ++k) {
+        cvt_stage_t *stg = &plan->stage[k];
+        int n_band = 1;
+        
+        if (plan->pool.n_thread > 1 && stg->b_band) {
+            bj.band_h = sat_div(stg->out.height, plan->pool.n_thread);
+            bj.band_h = sat_div(bj.band_h, plan->band_align) * plan->band_align;
+            n_band    = sat_div(stg->out.height, bj.band_h);
+        }
+        if (n_band > 1) {
+            bj.stg = stg;
+            bj.in  = cur;
+            thr_pool_run(&plan->pool, stage_band_job, &bj, n_band);
+        } else {
+            stage_run(stg, &stg->out, cur);
+        }
+        cur = &stg->out;
+    }
+
+    return cur;
+}
+
+void cvt_plan_free(cvt_plan_t *plan)
+{
+    int k;
+
+    for (k=0; k<plan->n_stage; ++k) {
+        if (plan->stage[k].fp_rows == rows_scale) {
+            yuv_scaler_free((yuv_scaler_t *)plan->stage[k].ctx);
+        }
+        plan->stage[k].ctx = 0;
+    }
+    yuv_buf_free(&plan->buf[0]);
+    yuv_buf_free(&plan->buf[1]);
+    yuv_buf_free(&plan->buf[2]);
+    thr_pool_free(&plan->pool);
+    plan->n_stage = 0;
+}
+
+void show_cvt_plan(cvt_plan_t *plan, int level, const char *prompt)
+{
+    int k;
+
+    xlog(level, prompt, "%d stage(s) {", plan->n_stage);
+    for (k=0; k<plan->n_stage; ++k) {
+        xlog(level, 0, "%s%s", k ? ", " : "", plan->stage[k].name);
+    }
+    xlog(level, 0, "}\n");
+}
+
+/**
+ *  @param [in] pdst description for target yuv format
+ *      The buffer @pdst bound is just for median used. "pdst->pbuf"
+ *      is not guaranteed to hold the target yuv data at any point.
+ *  @param [in] psrc hold yuv buffer compliant to source yuv format (@psrc itself)
+ *  @return either @pdst or @psrc which hold yuv buffer compliant to @pdst,
+ *      0 if there is no plan between them
+ *
+ *  One-shot form of cvt_plan_init() + cvt_plan_run(), ping-ponging between
+ *  the caller's two buffers. Frame loops should keep a cvt_plan_t instead.
+ */
+yuv_seq_t *yuv_cvt_frame(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    cvt_plan_t plan;
+    yuv_seq_t *pp[2] = {pdst, psrc};
+    yuv_seq_t *cur = psrc;
+    int k;
+
+    ENTER_FUNC();
+    show_yuv_prop(pdst, SLOG_DBG, "dst ");
+    show_yuv_prop(psrc, SLOG_DBG, "src ");
+
+    if (cvt_plan_compile(&plan, pdst, psrc, 0) < 0) {
+        cvt_plan_free(&plan);
+        LEAVE_FUNC();
+        return 0;
+    }
+
+    for (k=0; k<plan.n_stage; ++k) {
+        set_yuv_prop_by_copy(pp[k&1], 1, &plan.stage[k].out);
+        stage_run(&plan.stage[k], pp[k&1], cur);
+        cur = pp[k&1];
+    }
+    cvt_plan_free(&plan);
+
+    LEAVE_FUNC();
+
+    return cur;
+}
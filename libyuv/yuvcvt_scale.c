@@ -0,0 +1,383 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvcvt_scale.c
+ *  @brief Resizing by separable polyphase filters (bilinear, bicubic,
+ *      lanczos-3), in 14-bit fixed point. The taps of both axes are worked
+ *      out once by yuv_scaler_init(); each output row is a vertical pass
+ *      into a scratch row, then a horizontal one into the frame. Chroma
+ *      keeps its siting: co-sited with the even luma columns, and per
+ *      uv_site across 420 rows.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <math.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+#define SCL_BITS    14
+#define SCL_ONE     (1 << SCL_BITS)
+#define SCL_PI      3.14159265358979323846
+
+/**
+ *  taps of one axis of one plane. An unscaled axis has a single tap of
+ *  SCL_ONE at pos[k] = k.
+ */
+typedef struct _scl_axis
+{
+    int         n_in;
+    int         n_out;
+    int         nt;             //!< taps per output sample
+    int32_t    *pos;            //!< first input sample of each output
+    int16_t    *c;              //!< nt taps per output sample
+
+} scl_axis_t;
+
+struct _yuv_scaler
+{
+    scl_axis_t  h[2];           //!< luma, chroma
+    scl_axis_t  v[2];
+};
+
+/**
+ *  support radius of SCL_FILT_*, in input samples of an upscale
+ */
+static const int scl_radius[3] = {2, 1, 3};
+
+static double scl_kernel(int filt, double x)
+{
+    x = fabs(x);
+    if (filt == SCL_FILT_BILINEAR) {
+        return (x < 1) ? 1 - x : 0;
+    }
+    if (filt == SCL_FILT_LANCZOS3) {
+        if (x < 1e-9) {
+            return 1;
+        }
+        return (x < 3) ? 3 * sin(SCL_PI * x) * sin(SCL_PI * x / 3) / (SCL_PI * SCL_PI * x * x) : 0;
+    }
+    if (x < 1) {
+        return (1.5 * x - 2.5) * x * x + 1;
+    }
+    return (x < 2) ? ((-0.5 * x + 2.5) * x - 4) * x + 2 : 0;
+}
+
+/**
+ *  @param [in] ratio input over output size, of the luma axis
+ *  @return taps per output sample, a multiple of @align when filtering
+ */
+static int scl_axis_taps(int filt, int n_in, int n_out, double ratio, int align)
+{
+    double f = MAX(ratio, 1.0);
+    int nt;
+
+    if (n_in == n_out && ratio == 1.0) {
+        return 1;
+    }
+    nt = (int)ceil(2 * scl_radius[filt] * f);
+    return (nt + align - 1) / align * align;
+}
+
+/**
+ *  @brief taps of output sample k, centered on input sample
+ *      ((ds*k + off + 0.5) * ratio - 0.5 - off) / ds: the output sample at
+ *      luma position ds*k + off, mapped into the input, in input samples. A
+ *      downscale stretches the kernel by the ratio.
+ *  @param [in] b_fold fold the taps past the edges into a window of @nt
+ *      samples inside the input; without it they are left to the caller,
+ *      which clamps the rows.
+ *  @param [in] w scratch of (un-aligned) taps
+ */
+static void scl_axis_fill(scl_axis_t *a, int filt, double ratio, int ds, double off,
+                          int b_fold, double *w)
+{
+    double f  = MAX(ratio, 1.0);
+    double rf = scl_radius[filt] * f;
+    int    nw = (int)ceil(2 * rf);
+    int    k, i;
+
+    for (k=0; k<a->n_out; ++k)
+    {
+        int16_t *c = a->c + k * a->nt;
+        double ctr = ((ds * k + off + 0.5) * ratio - 0.5 - off) / ds;
+        double sum = 0;
+        int    i0  = (int)floor(ctr - rf) + 1;
+        int    big = 0, left = SCL_ONE, p = i0;
+
+        if (a->nt == 1) {
+            a->pos[k] = k;
+            c[0] = SCL_ONE;
+            continue;
+        }
+        for (i=0; i<nw; ++i) {
+            w[i] = scl_kernel(filt, (i0 + i - ctr) / f);
+            sum += w[i];
+            big  = (fabs(w[i]) > fabs(w[big])) ? i : big;
+        }
+        if (b_fold) {
+            p = (a->n_in < a->nt) ? 0 : MAX(MIN(i0, a->n_in - a->nt), 0);
+        }
+        memset(c, 0, a->nt * sizeof(int16_t));
+        for (i=0; i<nw; ++i) {
+            int q = (int)floor(w[i] / sum * SCL_ONE + 0.5);
+            int x = b_fold ? MAX(MIN(i0 + i, a->n_in - 1), 0) - p : i;
+
+            q = (i == big) ? 0 : q;
+            c[x] += (int16_t)q;
+            left -= q;
+        }
+        c[b_fold ? MAX(MIN(i0 + big, a->n_in - 1), 0) - p : big] += (int16_t)left;
+        a->pos[k] = p;
+    }
+}
+
+/**
+ *  @brief work out the taps scaling @psrc into @pdst. Layouts differ in
+ *      size only; the filter and the 420 siting are taken from @pdst.
+ *  @return the scaler, to be released by yuv_scaler_free(), 0 on failure
+ */
+yuv_scaler_t *yuv_scaler_init(yuv_seq_t *pdst, yuv_seq_t *psrc)
+{
+    static const double site_off[3] = {0.5, 0, 1};
+    yuv_scaler_t *scl, axes;
+    int     filt  = pdst->scl_filt;
+    int     step  = is_semi_planar(psrc->yuvfmt) ? 2 : 1;
+    int     ds_w  = is_mch_444(psrc->yuvfmt) ? 1 : 2;
+    int     ds_h  = get_uv_ds_ratio_h(psrc->yuvfmt);
+    double  rw    = (double)psrc->width  / pdst->width;
+    double  rh    = (double)psrc->height / pdst->height;
+    double  off_h = 0;
+    double *w;
+    scl_axis_t *a[4];
+    int     size, nw, k;
+    uint8_t *p;
+
+    if ((unsigned)filt > SCL_FILT_LANCZOS3) {
+        xerr("%s(): bad scaling filter (%d)\n", __FUNCTION__, filt);
+        return 0;
+    }
+    if (is_mch_420(psrc->yuvfmt)) {
+        if ((unsigned)pdst->uv_site > UV_SITE_BOTTOM) {
+            xerr("%s(): bad chroma siting (%d)\n", __FUNCTION__, pdst->uv_site);
+            return 0;
+        }
+        off_h = site_off[pdst->uv_site];
+    }
+
+    memset(&axes, 0, sizeof(axes));
+    a[0] = &axes.h[0];  a[1] = &axes.v[0];
+    a[2] = &axes.h[1];  a[3] = &axes.v[1];
+
+    a[0]->n_in = psrc->width;               a[0]->n_out = pdst->width;
+    a[1]->n_in = psrc->height;              a[1]->n_out = pdst->height;
+    a[2]->n_in = get_uv_width (psrc) / step;a[2]->n_out = get_uv_width (pdst) / step;
+    a[3]->n_in = get_uv_height(psrc);       a[3]->n_out = get_uv_height(pdst);
+
+    a[0]->nt = scl_axis_taps(filt, a[0]->n_in, a[0]->n_out, rw, 4);
+    a[1]->nt = scl_axis_taps(filt, a[1]->n_in, a[1]->n_out, rh, 1);
+    a[2]->nt = scl_axis_taps(filt, a[2]->n_in, a[2]->n_out, rw, 4);
+    a[3]->nt = scl_axis_taps(filt, a[3]->n_in, a[3]->n_out, rh, 1);
+
+    /**
+     *  one block: the scaler, pos and taps of each axis, then the scratch
+     *  of scl_axis_fill()
+     */
+    size = sizeof(yuv_scaler_t);
+    nw   = 0;
+    for (k=0; k<4; ++k) {
+        size += a[k]->n_out * (sizeof(int32_t) + a[k]->nt * sizeof(int16_t));
+        nw    = MAX(nw, a[k]->nt);
+    }
+    size = (size + 7) & ~7;
+    p = (uint8_t *)malloc(size + nw * sizeof(double));
+    if (!p) {
+        xerr("%s(): malloc failed\n", __FUNCTION__);
+        return 0;
+    }
+    scl = (yuv_scaler_t *)p;
+    memcpy(scl, &axes, sizeof(yuv_scaler_t));
+    a[0] = &scl->h[0];  a[1] = &scl->v[0];
+    a[2] = &scl->h[1];  a[3] = &scl->v[1];
+    w    = (double *)(p + size);
+    p   += sizeof(yuv_scaler_t);
+    for (k=0; k<4; ++k) {
+        a[k]->pos = (int32_t *)p;
+        p += a[k]->n_out * sizeof(int32_t);
+    }
+    for (k=0; k<4; ++k) {
+        a[k]->c = (int16_t *)p;
+        p += a[k]->n_out * a[k]->nt * sizeof(int16_t);
+    }
+
+    scl_axis_fill(a[0], filt, rw, 1,    0,     1, w);
+    scl_axis_fill(a[1], filt, rh, 1,    0,     0, w);
+    scl_axis_fill(a[2], filt, rw, ds_w, 0,     1, w);
+    scl_axis_fill(a[3], filt, rh, ds_h, off_h, 0, w);
+
+    return scl;
+}
+
+void yuv_scaler_free(yuv_scaler_t *scl)
+{
+    free(scl);
+}
+
+/**
+ *  @brief output rows [@j0, @j1) of one plane, @nbyte bytes a sample.
+ *      Semi-planar rows are filtered as they are across rows, and split
+ *      around the horizontal pass.
+ *  @param [in] t scratch of the sizes yuv_scale_rows() gives
+ */
+static void scale_plane(scl_axis_t *ah, scl_axis_t *av, int nbyte, int max, int b_sp,
+                        uint8_t *dst, int dst_stride, uint8_t *src, int src_stride,
+                        int j0, int j1, uint8_t **rows, uint8_t *t)
+{
+    int step = b_sp ? 2 : 1;
+    int nin  = ah->n_in * step;
+    int nout = ah->n_out * step;
+    int pad  = ah->nt * nbyte;
+    uint8_t *u  = t  + nin * nbyte + pad;
+    uint8_t *v  = u  + ah->n_in * nbyte + pad;
+    uint8_t *du = v  + ah->n_in * nbyte + pad;
+    uint8_t *dv = du + ah->n_out * nbyte;
+    int j, k;
+
+    for (j=j0; j<j1; ++j)
+    {
+        uint8_t *d = dst + j * dst_stride;
+        uint8_t *r = (ah->nt == 1) ? d : t;
+
+        if (av->nt == 1) {
+            r = src + av->pos[j] * src_stride;
+            if (ah->nt == 1) {
+                memcpy(d, r, nout * nbyte);
+                continue;
+            }
+            if (!b_sp && ah->n_in < ah->nt) {
+                memcpy(t, r, nin * nbyte);
+                r = t;
+            }
+        } else {
+            for (k=0; k<av->nt; ++k) {
+                rows[k] = src + MAX(MIN(av->pos[j] + k, av->n_in - 1), 0) * src_stride;
+            }
+            if (nbyte == 1) {
+                yuv_kern.b8_vscale(r, rows, av->c + j * av->nt, av->nt, nin);
+            } else {
+                yuv_kern.b16_vscale((uint16_t *)r, (uint16_t **)rows, av->c + j * av->nt,
+                                    av->nt, nin, max);
+            }
+        }
+        if (ah->nt == 1) {
+            continue;
+        }
+
+        if (nbyte == 1) {
+            if (!b_sp) {
+                yuv_kern.b8_hscale(d, r, ah->pos, ah->c, ah->nt, ah->n_out);
+                continue;
+            }
+            yuv_kern.b8_uv_split(u, v, r, ah->n_in);
+            yuv_kern.b8_hscale(du, u, ah->pos, ah->c, ah->nt, ah->n_out);
+            yuv_kern.b8_hscale(dv, v, ah->pos, ah->c, ah->nt, ah->n_out);
+            yuv_kern.b8_uv_merge(d, du, dv, ah->n_out);
+        } else {
+            if (!b_sp) {
+                yuv_kern.b16_hscale((uint16_t *)d, (uint16_t *)r, ah->pos, ah->c,
+                                    ah->nt, ah->n_out, max);
+                continue;
+            }
+            yuv_kern.b16_uv_split((uint16_t *)u, (uint16_t *)v, (uint16_t *)r, ah->n_in);
+            yuv_kern.b16_hscale((uint16_t *)du, (uint16_t *)u, ah->pos, ah->c,
+                                ah->nt, ah->n_out, max);
+            yuv_kern.b16_hscale((uint16_t *)dv, (uint16_t *)v, ah->pos, ah->c,
+                                ah->nt, ah->n_out, max);
+            yuv_kern.b16_uv_merge((uint16_t *)d, (uint16_t *)du, (uint16_t *)dv, ah->n_out);
+        }
+    }
+}
+
+/**
+ *  @brief scale luma rows [@y0, @y0+@h) of @pdst out of @psrc, 8 or 16
+ *      bits, planar or semi-planar, by the taps of @scl. @pdst and @psrc
+ *      are whole frames, as the filters read rows around the band; rows
+ *      and samples past the edges repeat the edge ones.
+ *  @return 0 on success
+ */
+int yuv_scale_rows(yuv_seq_t *pdst, yuv_seq_t *psrc, int y0, int h, yuv_scaler_t *scl)
+{
+    int nbyte = psrc->nbit / 8;
+    int max   = (nbyte == 1) ? 255 : (1 << psrc->nlsb) - 1;
+    int b_sp  = is_semi_planar(psrc->yuvfmt);
+    int n_uv  = is_mch_planar(psrc->yuvfmt) ? 2 : 1;
+    int ds    = get_uv_ds_ratio_h(pdst->yuvfmt);
+    int n_row = MAX(scl->v[0].nt, scl->v[1].nt);
+    int n_tmp = 0;
+    uint8_t *src_uv[2], *dst_uv[2];
+    uint8_t **rows;
+    int a, p;
+
+    ENTER_FUNC();
+
+    assert(psrc->nbit == pdst->nbit && (psrc->nbit == 8 || psrc->nbit == 16));
+    assert(psrc->nlsb == pdst->nlsb && psrc->nlsb > 0);
+    assert(psrc->yuvfmt == pdst->yuvfmt && !is_mch_mixed(psrc->yuvfmt));
+    assert(!psrc->btile && !pdst->btile);
+    assert(!ds || y0 % ds == 0);
+
+    /**
+     *  row pointers, then a vertical output row, split u/v inputs and
+     *  outputs of the horizontal pass, @nt samples of slack after inputs
+     */
+    for (a=0; a<2; ++a) {
+        int step = (a && b_sp) ? 2 : 1;
+        n_tmp = MAX(n_tmp, ((step + 2) * scl->h[a].n_in + 2 * scl->h[a].n_out 
+                            + 3 * scl->h[a].nt) * nbyte);
+    }
+    rows = (uint8_t **)calloc(1, n_row * sizeof(uint8_t *) + n_tmp);
+    if (!rows) {
+        xerr("%s(): malloc failed\n", __FUNCTION__);
+        return -1;
+    }
+
+    scale_plane(&scl->h[0], &scl->v[0], nbyte, max, 0,
+            pdst->pbuf, pdst->y_stride, psrc->pbuf, psrc->y_stride,
+            y0, y0 + h, rows, (uint8_t *)(rows + n_row));
+
+    if (ds)
+    {
+        int j0 = y0 / ds;
+        int j1 = MIN(sat_div(y0 + h, ds), get_uv_height(pdst));
+
+        get_uv_planes(psrc, &src_uv[0], &src_uv[1]);
+        get_uv_planes(pdst, &dst_uv[0], &dst_uv[1]);
+        for (p=0; p<n_uv; ++p) {
+            scale_plane(&scl->h[1], &scl->v[1], nbyte, max, b_sp,
+                    dst_uv[p], pdst->uv_stride, src_uv[p], psrc->uv_stride,
+                    j0, j1, rows, (uint8_t *)(rows + n_row));
+        }
+    }
+    free(rows);
+
+    LEAVE_FUNC();
+
+    return 0;
+}
@@ -17,6 +17,7 @@
 #include <assert.h>
 #include <malloc.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "yuvdef.h"
 
@@ -25,7 +26,9 @@ int is_mch_420(int fmt)
 {
     return (fmt == YUVFMT_420P
             || fmt == YUVFMT_420SP
-            || fmt == YUVFMT_420SPA) ? 1 : 0;
+            || fmt == YUVFMT_420SPA
+            || fmt == YUVFMT_YV12
+            || fmt == YUVFMT_NV21) ? 1 : 0;
 }
 
 
@@ -34,22 +37,36 @@ int is_mch_422(int fmt)
     return (fmt == YUVFMT_422P
             || fmt == YUVFMT_422SP
             || fmt == YUVFMT_422SPA
+            || fmt == YUVFMT_NV61
             || fmt == YUVFMT_UYVY
-            || fmt == YUVFMT_YUYV) ? 1 : 0;
+            || fmt == YUVFMT_YUYV
+            || fmt == YUVFMT_YVYU
+            || fmt == YUVFMT_VYUY) ? 1 : 0;
+}
+
+
+int is_mch_444(int fmt)
+{
+    return (fmt == YUVFMT_444P
+            || fmt == YUVFMT_444SP) ? 1 : 0;
 }
 
  
 int is_mch_mixed(int fmt)
 {
     return (fmt == YUVFMT_UYVY 
-            || fmt == YUVFMT_YUYV) ? 1 : 0;
+            || fmt == YUVFMT_YUYV
+            || fmt == YUVFMT_YVYU
+            || fmt == YUVFMT_VYUY) ? 1 : 0;
 }
 
 
 int is_mch_planar(int fmt)
 {
     return (fmt == YUVFMT_420P 
-            || fmt == YUVFMT_422P) ? 1 : 0;
+            || fmt == YUVFMT_422P
+            || fmt == YUVFMT_444P
+            || fmt == YUVFMT_YV12) ? 1 : 0;
 }
 
 
@@ -58,7 +75,10 @@ int is_semi_planar(int fmt)
     return (fmt == YUVFMT_420SP
             || fmt == YUVFMT_420SPA
             || fmt == YUVFMT_422SP
-            || fmt == YUVFMT_422SPA) ? 1 : 0;
+            || fmt == YUVFMT_422SPA
+            || fmt == YUVFMT_444SP
+            || fmt == YUVFMT_NV21
+            || fmt == YUVFMT_NV61) ? 1 : 0;
 }
 
 
@@ -67,14 +87,86 @@ int is_mono_planar(int fmt)
     return (fmt == YUVFMT_400P) ? 1 : 0;
 }
 
+/**
+ *  9..15 bit samples are stored as a packed lte bitstream
+ */
+int is_packed_bit(int nbit)
+{
+    return (nbit > 8 && nbit < 16) ? 1 : 0;
+}
+
+/**
+ *  v ahead of u: the v plane first, or vu interleaved
+ */
+int is_uv_swapped(int fmt)
+{
+    return (fmt == YUVFMT_YV12
+            || fmt == YUVFMT_NV21
+            || fmt == YUVFMT_NV61
+            || fmt == YUVFMT_YVYU
+            || fmt == YUVFMT_VYUY) ? 1 : 0;
+}
+
+/**
+ *  @return position of the first luma in a pair: 0 for yuyv/yvyu, 
+ *      1 for uyvy/vyuy
+ */
+int get_yuyv_yo(int fmt)
+{
+    return (fmt == YUVFMT_YUYV || fmt == YUVFMT_YVYU) ? 0 : 1;
+}
+
+/**
+ *  @return 1 if planar @fmt1 and @fmt2 differ in the order of u,v planes 
+ *      at most
+ */
+int is_planar_swap(int fmt1, int fmt2)
+{
+    return is_mch_planar(fmt1) && is_mch_planar(fmt2) 
+        && get_spl_fmt(fmt1) == get_spl_fmt(fmt2);
+}
+
 int get_spl_fmt(int fmt)
 {
     if (fmt == YUVFMT_400P)     return YUVFMT_400P; 
     else if (is_mch_420(fmt))   return YUVFMT_420P;
     else if (is_mch_422(fmt))   return YUVFMT_422P;
+    else if (fmt == YUVFMT_V210) return YUVFMT_422P;
+    else if (is_mch_444(fmt))   return YUVFMT_444P;
     else                        return YUVFMT_UNSUPPORT;
 }
 
+/**
+ *  @brief P010 and the like name a layout and a depth together; rewrite 
+ *      them into both. 10-bit in 16 is kept at the MSB (nlsb < 0).
+ *      V210 is 10-bit by layout.
+ */
+void resolve_named_fmt(yuv_seq_t *yuv)
+{
+    static const struct {
+        int fmt;
+        int yuvfmt;
+        int nbit;
+        int nlsb;
+    } named[] = {
+        {YUVFMT_P010,   YUVFMT_420SP,   16,     -10 },
+        {YUVFMT_P210,   YUVFMT_422SP,   16,     -10 },
+        {YUVFMT_P016,   YUVFMT_420SP,   16,     16  },
+        {YUVFMT_Y210,   YUVFMT_YUYV,    16,     -10 },
+        {YUVFMT_V210,   YUVFMT_V210,    10,     10  },
+    };
+    int i;
+    
+    for (i=0; i<ARRAY_SIZE(named); ++i) {
+        if (yuv->yuvfmt == named[i].fmt) {
+            yuv->yuvfmt = named[i].yuvfmt;
+            yuv->nbit   = named[i].nbit;
+            yuv->nlsb   = named[i].nlsb;
+            return;
+        }
+    }
+}
+
 void swap_uv(uint8_t **u, uint8_t **v)
 {
     uint8_t *m = *u;
@@ -82,9 +174,22 @@ void swap_uv(uint8_t **u, uint8_t **v)
     *v = m;
 }
 
+/**
+ *  @brief u and v plane of planar @yuv, whichever is stored first. 
+ *      Semi-planar chroma is all at @u.
+ */
+void get_uv_planes(yuv_seq_t *yuv, uint8_t **u, uint8_t **v)
+{
+    *u = yuv->pbuf + yuv->y_size;
+    *v = *u + yuv->uv_size;
+    if (is_mch_planar(yuv->yuvfmt) && is_uv_swapped(yuv->yuvfmt)) {
+        swap_uv(u, v);
+    }
+}
+
 int get_uv_ds_ratio_w(int fmt)
 {
-    if (is_semi_planar(fmt)) {
+    if (is_semi_planar(fmt) || is_mch_444(fmt)) {
         return 1;
     } else 
     if (is_mch_planar(fmt)) {
@@ -96,7 +201,7 @@ int get_uv_ds_ratio_w(int fmt)
 
 int get_uv_ds_ratio_h(int fmt)
 {
-    if (is_mch_422(fmt)) {
+    if (is_mch_422(fmt) || is_mch_444(fmt)) {
         return 1;
     } else 
     if (is_mch_420(fmt)) {
@@ -111,9 +216,9 @@ int get_uv_width(yuv_seq_t *yuv)
     int fmt = yuv->yuvfmt;
     
     if       (is_semi_planar(fmt)) {
-        return yuv->width;
+        return is_mch_444(fmt) ? 2 * yuv->width : yuv->width;
     } else if (is_mch_planar(fmt)) {
-        return yuv->width / 2;
+        return is_mch_444(fmt) ? yuv->width : yuv->width / 2;
     }
     
     return 0;
@@ -123,7 +228,7 @@ int get_uv_height(yuv_seq_t *yuv)
 {
     int fmt = yuv->yuvfmt;
 
-    if       (is_mch_422(fmt)) {
+    if       (is_mch_422(fmt) || is_mch_444(fmt)) {
         return yuv->height;
     } else if (is_mch_420(fmt)) {
         return yuv->height / 2;
@@ -133,6 +238,179 @@ int get_uv_height(yuv_seq_t *yuv)
 }
 
 
+const opt_enum_t cmn_scan[] = {
+    {"raster",  TILE_SCAN_RASTER},
+    {"z",       TILE_SCAN_Z     },
+    {"n",       TILE_SCAN_N     },
+};
+const int n_cmn_scan = ARRAY_SIZE(cmn_scan);
+
+int yuv_tile_scan(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_scan; ++j) {
+        if (0==strcmp(name, cmn_scan[j].name)) {
+            return cmn_scan[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown tile scan `%s`\n", name);
+    return -1;
+}
+
+const opt_enum_t cmn_rnd[] = {
+    {"trunc",   RND_TRUNC   },
+    {"nearest", RND_NEAREST },
+    {"dither",  RND_DITHER  },
+};
+const int n_cmn_rnd = ARRAY_SIZE(cmn_rnd);
+
+int yuv_rnd_mode(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_rnd; ++j) {
+        if (0==strcmp(name, cmn_rnd[j].name)) {
+            return cmn_rnd[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown rounding `%s`\n", name);
+    return -1;
+}
+
+const opt_enum_t cmn_uv_filt[] = {
+    {"nearest", UV_FILT_NEAREST },
+    {"bilinear",UV_FILT_BILINEAR},
+    {"4tap",    UV_FILT_4TAP    },
+};
+const int n_cmn_uv_filt = ARRAY_SIZE(cmn_uv_filt);
+
+int yuv_uv_filt(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_uv_filt; ++j) {
+        if (0==strcmp(name, cmn_uv_filt[j].name)) {
+            return cmn_uv_filt[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown chroma filter `%s`\n", name);
+    return -1;
+}
+
+const opt_enum_t cmn_uv_site[] = {
+    {"center",  UV_SITE_CENTER  },
+    {"top",     UV_SITE_TOP     },
+    {"bottom",  UV_SITE_BOTTOM  },
+};
+const int n_cmn_uv_site = ARRAY_SIZE(cmn_uv_site);
+
+int yuv_uv_site(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_uv_site; ++j) {
+        if (0==strcmp(name, cmn_uv_site[j].name)) {
+            return cmn_uv_site[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown chroma siting `%s`\n", name);
+    return -1;
+}
+
+const opt_enum_t cmn_scl_filt[] = {
+    {"bicubic", SCL_FILT_BICUBIC },
+    {"bilinear",SCL_FILT_BILINEAR},
+    {"lanczos3",SCL_FILT_LANCZOS3},
+};
+const int n_cmn_scl_filt = ARRAY_SIZE(cmn_scl_filt);
+
+int yuv_scl_filt(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_scl_filt; ++j) {
+        if (0==strcmp(name, cmn_scl_filt[j].name)) {
+            return cmn_scl_filt[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown scaling filter `%s`\n", name);
+    return -1;
+}
+
+/**
+ *  @brief complete the tile geometry of @nbit samples: unset tw/th come 
+ *      from @like, or the built-in tiling without it; unset tsz is the 
+ *      8-byte aligned size of tw*th samples.
+ */
+void set_tile_geometry(tile_t *t, const tile_t *like, int nbit)
+{
+    if (t->tw <= 0 || t->th <= 0) {
+        if (like) {
+            t->tw = like->tw;   t->th = like->th;
+            t->tsz= t->tsz ? t->tsz : like->tsz;
+        } else if (nbit == 10) { 
+            t->tw = 3;  t->th = 4;
+        } else 
+        if (nbit >= 8 && nbit < 16) { 
+            t->tw = 8;  t->th = 4; 
+        } else {
+            xerr("not supported bitdepth (%d) for tile mode\n", nbit);
+            t->tw = 8;  t->th = 4;  t->tsz = 64;
+        }
+    }
+    if (t->tsz <= 0) {
+        t->tsz = sat_div(t->tw * t->th * nbit, 64) * 8;
+    }
+    if (t->tsz * 8 < t->tw * t->th * nbit) {
+        xerr("tile %dx%d does not fit in %d bytes\n", t->tw, t->th, t->tsz);
+        t->tsz = sat_div(t->tw * t->th * nbit, 64) * 8;
+    }
+}
+
+/**
+ *  @brief bytes of a tile row covering @w samples
+ */
+int get_tile_row_size(const tile_t *t, int w)
+{
+    return sat_div(w, t->tw) * t->tsz + t->pad;
+}
+
+/**
+ *  @brief byte offset of tile (@tx, @ty) in a plane of @ntx x @nty tiles
+ *      and tile row size @ts. 
+ *      Z/N scans store a pair of tile rows as one run of 2x2 groups, with 
+ *      both rows' padding at its end. A single trailing column (row) is 
+ *      walked top-down (left to right).
+ */
+int get_tile_offset(const tile_t *t, int ts, int ntx, int nty, int tx, int ty)
+{
+    int idx = tx;
+    
+    if (t->scan != TILE_SCAN_RASTER && (ty|1) < nty)
+    {
+        if ((tx|1) >= ntx) {
+            idx = 2*tx + (ty&1);
+        } else if (t->scan == TILE_SCAN_Z) {
+            idx = 2*(tx&~1) + 2*(ty&1) + (tx&1);
+        } else {
+            idx = 2*(tx&~1) + 2*(tx&1) + (ty&1);
+        }
+        ty &= ~1;
+    }
+    
+    return ts * ty + t->tsz * idx;
+}
+
+/**
+ *  @brief row count of the luma (chroma) plane, in tile rows if tiled
+ */
+int get_y_rows(yuv_seq_t *yuv)
+{
+    return yuv->btile ? sat_div(yuv->height, yuv->tile.th) : yuv->height;
+}
+
+int get_uv_rows(yuv_seq_t *yuv)
+{
+    int h = get_uv_height(yuv);
+    return yuv->btile ? sat_div(h, yuv->uv_tile.th) : h;
+}
+
 void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt, 
                     int nbit, int nlsb, int btile, 
                     int stride, int io_size)
@@ -144,28 +422,30 @@ void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt,
     yuv->nlsb       = nlsb;
     yuv->btile      = btile;
 
-    if (fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV) {
+    if (is_mch_mixed(fmt)) {
         w *= 2;
     }
 
     if (btile) 
     {
         tile_t *t = &yuv->tile; 
-        if (yuv->nbit == 10) { 
-            t->tw = 3; t->th = 4; t->tsz = 16; 
-        } else 
-        if (yuv->nbit == 8) { 
-            t->tw = 8; t->th = 4; t->tsz = 32;
-        } else {
-            xerr("not supported bitdepth (%d) for tile mode\n", yuv->nbit);
-            t->tw = 8; t->th = 4; t->tsz = 64;
-        }
+        set_tile_geometry(t, 0, yuv->nbit);
+        set_tile_geometry(&yuv->uv_tile, t, yuv->nbit);
+        yuv->uv_tile.pad  = t->pad;
+        yuv->uv_tile.scan = t->scan;
         
-        yuv->y_stride = sat_div(w, t->tw) * t->tsz;
+        yuv->y_stride = get_tile_row_size(t, w);
         yuv->y_stride = MAX(stride,  yuv->y_stride);
         
         yuv->y_size = yuv->y_stride * sat_div(h, t->th);
     } 
+    else if (fmt == YUVFMT_V210)
+    {
+        yuv->y_stride = sat_div(w, 48) * 128;
+        yuv->y_stride = MAX(stride,  yuv->y_stride);
+        
+        yuv->y_size = yuv->y_stride * yuv->height;
+    }
     else 
     {
         yuv->y_stride = sat_div(w * yuv->nbit, 8);
@@ -174,33 +454,56 @@ void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt,
         yuv->y_size = yuv->y_stride * yuv->height;
     }
     
-    if (fmt == YUVFMT_400P || fmt == YUVFMT_UYVY || fmt == YUVFMT_YUYV)
+    if (fmt == YUVFMT_400P || fmt == YUVFMT_V210 || is_mch_mixed(fmt))
     {
         yuv->uv_stride  = 0;
         yuv->uv_size    = 0;
         yuv->io_size    = yuv->y_size;
     }
-    else if (fmt == YUVFMT_420P)
+    else if (is_mch_planar(fmt))
     {
-        yuv->uv_stride  = yuv->y_stride / 2;
-        yuv->uv_size    = yuv->y_size   / 4;
+        int ds_w = get_uv_ds_ratio_w(fmt);
+        int ds_h = get_uv_ds_ratio_h(fmt);
+        
+        yuv->uv_stride  = yuv->y_stride / ds_w;
+        yuv->uv_size    = yuv->y_size   / (ds_w * ds_h);
         yuv->io_size    = yuv->y_size + 2 * yuv->uv_size;
     }
-    else if (fmt == YUVFMT_420SP)
+    else if (is_semi_planar(fmt))
     {
-        assert( is_bit_aligned(1, yuv->height) );
+        int n_uv = is_mch_444(fmt) ? 2 : 1;
+        
+        assert( !is_mch_420(fmt) || is_bit_aligned(1, yuv->height) );
         
-        yuv->uv_stride  = yuv->y_stride;
-        yuv->uv_size    = yuv->y_size   / 2;
+        yuv->uv_stride  = yuv->y_stride * n_uv;
+        yuv->uv_size    = yuv->y_size   * n_uv / get_uv_ds_ratio_h(fmt);
         yuv->io_size    = yuv->y_size + yuv->uv_size;
     }
-    else if (fmt == YUVFMT_422P)
+    
+    /**
+     *  packed chroma rows hold whole samples, an odd byte count of luma
+     *  does not halve
+     */
+    if (!btile && is_packed_bit(yuv->nbit) && is_mch_planar(fmt) && yuv->uv_stride)
     {
-        yuv->uv_stride  = yuv->y_stride / 2;
-        yuv->uv_size    = yuv->y_size   / 2;
+        yuv->uv_stride  = MAX(yuv->uv_stride, sat_div(get_uv_width(yuv) * yuv->nbit, 8));
+        yuv->uv_size    = yuv->uv_stride * get_uv_height(yuv);
         yuv->io_size    = yuv->y_size + 2 * yuv->uv_size;
     }
     
+    /**
+     *  chroma tiles keep whole tile rows of their own geometry
+     */
+    if (btile && yuv->uv_stride) 
+    {
+        tile_t *c = &yuv->uv_tile;
+        int n_uv  = is_mch_planar(fmt) ? 2 : 1;
+        
+        yuv->uv_stride  = MAX(yuv->uv_stride, get_tile_row_size(c, get_uv_width(yuv)));
+        yuv->uv_size    = yuv->uv_stride * get_uv_rows(yuv);
+        yuv->io_size    = yuv->y_size + n_uv * yuv->uv_size;
+    }
+    
     yuv->io_size = MAX(io_size, yuv->io_size);
     if (b_realloc) {
         yuv_buf_realloc(yuv, yuv->io_size);
@@ -211,12 +514,46 @@ void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt,
 
 void set_yuv_prop_by_copy(yuv_seq_t *dst, int b_realloc, yuv_seq_t *src)
 {
+    if (dst != src) {
+        memcpy(&dst->tile,    &src->tile,    sizeof(tile_t));
+        memcpy(&dst->uv_tile, &src->uv_tile, sizeof(tile_t));
+        dst->rnd = src->rnd;
+        dst->uv_filt = src->uv_filt;
+        dst->uv_site = src->uv_site;
+        dst->scl_filt = src->scl_filt;
+    }
     return set_yuv_prop(dst, b_realloc,
             src->width, src->height, src->yuvfmt, 
             src->nbit,  src->nlsb,   src->btile, 
             src->y_stride, src->io_size);
 }
 
+/**
+ *  @brief describe rows [y0, y0+h) of @yuv as a frame of its own, sharing
+ *      @yuv's buffer. Plane offsets are kept, so kernels written for a whole
+ *      frame work on the band unchanged.
+ *  @param [in] y0 luma row, aligned to a tile row (pair for Z/N scans)
+ *      of both planes, and to a chroma row for 420
+ */
+void yuv_band_view(yuv_seq_t *band, yuv_seq_t *yuv, int y0, int h)
+{
+    int th    = yuv->btile ? yuv->tile.th    : 1;
+    int uv_th = yuv->btile ? yuv->uv_tile.th : 1;
+    int ds_h  = get_uv_ds_ratio_h(yuv->yuvfmt);
+    int y_off = yuv->y_stride * (y0 / th);
+    int uv_off= ds_h ? yuv->uv_stride * (y0 / ds_h / uv_th) : 0;
+    
+    assert(y0 % th == 0);
+    assert(!ds_h || (y0 / ds_h) % uv_th == 0);
+    
+    memcpy(band, yuv, sizeof(yuv_seq_t));
+    band->height    = h;
+    band->pbuf      = yuv->pbuf + y_off;
+    band->y_size    = yuv->y_size - y_off + uv_off;
+    band->io_size   = yuv->io_size - y_off;
+    band->buf_size  = yuv->buf_size - y_off;
+}
+
 int yuv_buf_realloc(yuv_seq_t *yuv, int buf_size)
 {
     if (!yuv) {
@@ -265,6 +602,10 @@ void show_yuv_prop(yuv_seq_t *yuv, int level, const char *prompt)
     xlog(level, 0, "(%s), ", show_fmt(yuv->yuvfmt));
     XTR_I(nlsb      );
     XTR_I(nbit      );
+    XTR_I(rnd       );
+    XTR_I(uv_filt   );
+    XTR_I(uv_site   );
+    XTR_I(scl_filt  );
     XTR_I(btile     );
     XTR_I(y_stride  );
     XTR_I(uv_stride );
@@ -276,6 +617,11 @@ void show_yuv_prop(yuv_seq_t *yuv, int level, const char *prompt)
     XTR_I(tile.tw   );
     XTR_I(tile.th   );
     XTR_I(tile.tsz  );
+    XTR_I(tile.pad  );
+    XTR_I(tile.scan );
+    XTR_I(uv_tile.tw );
+    XTR_I(uv_tile.th );
+    XTR_I(uv_tile.tsz);
     
     xlog(level, 0, "}\n");
 }
@@ -49,6 +49,18 @@ enum {
     YUVFMT_422SPA,
     YUVFMT_UYVY,
     YUVFMT_YUYV,
+    YUVFMT_444P,
+    YUVFMT_444SP,
+    YUVFMT_YV12,        //!< 420p, v plane first
+    YUVFMT_NV21,        //!< 420sp, vu interleaved
+    YUVFMT_NV61,        //!< 422sp, vu interleaved
+    YUVFMT_YVYU,
+    YUVFMT_VYUY,
+    YUVFMT_V210,        //!< 422, 6 pixels of 10-bit in 16 bytes
+    YUVFMT_P010,        //!< named layout and depth, see resolve_named_fmt()
+    YUVFMT_P210,
+    YUVFMT_P016,
+    YUVFMT_Y210,
     YUVFMT_UNSUPPORT
 };
 
@@ -75,10 +87,68 @@ typedef struct _tile
      *  x x x x    <== padding_bytes
      *  
      */
-    //int     tile_row_size;         //!< tile_row_size = tsz * N + padding_bytes;
+    int     pad;        //!< tile_row_size = tsz * N + pad;
+    int     scan;       //!< tile order in a tile row pair, TILE_SCAN_*
 
 } tile_t;
 
+/**
+ *  tile order. Z and N walk 2x2 tile groups over a pair of tile rows:
+ *      Z: 0 1      N: 0 2
+ *         2 3         1 3
+ */
+enum tile_scan {
+    TILE_SCAN_RASTER    = 0,
+    TILE_SCAN_Z         = 1,
+    TILE_SCAN_N         = 2,
+};
+extern const opt_enum_t cmn_scan[];
+extern const int n_cmn_scan;
+
+/**
+ *  rounding as bits are dropped
+ */
+enum depth_rnd {
+    RND_TRUNC           = 0,
+    RND_NEAREST         = 1,
+    RND_DITHER          = 2,    //!< 4x4 ordered dither
+};
+extern const opt_enum_t cmn_rnd[];
+extern const int n_cmn_rnd;
+
+/**
+ *  chroma resampling filter, 420 <-> 422
+ */
+enum uv_filter {
+    UV_FILT_NEAREST     = 0,    //!< drop / repeat rows
+    UV_FILT_BILINEAR    = 1,
+    UV_FILT_4TAP        = 2,    //!< cubic for up, [1 3 3 1] for down
+};
+extern const opt_enum_t cmn_uv_filt[];
+extern const int n_cmn_uv_filt;
+
+/**
+ *  vertical siting of 420 chroma sample j, in luma rows
+ */
+enum uv_siting {
+    UV_SITE_CENTER      = 0,    //!< 2j+0.5, mpeg-2/h.264 default
+    UV_SITE_TOP         = 1,    //!< 2j
+    UV_SITE_BOTTOM      = 2,    //!< 2j+1
+};
+extern const opt_enum_t cmn_uv_site[];
+extern const int n_cmn_uv_site;
+
+/**
+ *  resize filter, separable polyphase
+ */
+enum scl_filter {
+    SCL_FILT_BICUBIC    = 0,    //!< keys, a = -0.5
+    SCL_FILT_BILINEAR   = 1,
+    SCL_FILT_LANCZOS3   = 2,
+};
+extern const opt_enum_t cmn_scl_filt[];
+extern const int n_cmn_scl_filt;
+
 typedef struct _rect
 {
     union {
@@ -99,9 +169,14 @@ typedef struct _yuv_seq
     int     yuvfmt;
     int     nbit;
     int     nlsb;
+    int     rnd;            //!< RND_*, as this seq is made of a deeper one
+    int     uv_filt;        //!< UV_FILT_*, as this seq is resampled from another
+    int     uv_site;        //!< UV_SITE_*, of the 420 side in resampling
+    int     scl_filt;       //!< SCL_FILT_*, as this seq is resized from another
     int     btile;
     
     tile_t  tile;
+    tile_t  uv_tile;        //!< chroma tiles, same as @tile if not set
     int     y_stride;       //!< cfg-able
     int     uv_stride;      //!< un-cfg-able, y_stride or y_stride/2
     
@@ -118,17 +193,35 @@ typedef struct _yuv_seq
 
 int is_mch_420(int fmt);
 int is_mch_422(int fmt);
+int is_mch_444(int fmt);
 int is_mch_mixed(int fmt);
 int is_mch_planar(int fmt);
 int is_semi_planar(int fmt);
 int is_mono_planar(int fmt);
+int is_packed_bit(int nbit);
+int is_uv_swapped(int fmt);
+int get_yuyv_yo(int fmt);
+int is_planar_swap(int fmt1, int fmt2);
 int get_spl_fmt(int fmt);
+void resolve_named_fmt(yuv_seq_t *yuv);
 
 void swap_uv(uint8_t **u, uint8_t **v);
+void get_uv_planes(yuv_seq_t *yuv, uint8_t **u, uint8_t **v);
 int get_uv_width(yuv_seq_t *yuv);
 int get_uv_height(yuv_seq_t *yuv);
 int get_uv_ds_ratio_w(int fmt);
 int get_uv_ds_ratio_h(int fmt);
+int get_y_rows(yuv_seq_t *yuv);
+int get_uv_rows(yuv_seq_t *yuv);
+
+int  yuv_tile_scan(const char *name);
+int  yuv_rnd_mode(const char *name);
+int  yuv_uv_filt(const char *name);
+int  yuv_uv_site(const char *name);
+int  yuv_scl_filt(const char *name);
+void set_tile_geometry(tile_t *t, const tile_t *like, int nbit);
+int  get_tile_row_size(const tile_t *t, int w);
+int  get_tile_offset(const tile_t *t, int ts, int ntx, int nty, int tx, int ty);
 
 void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt, 
                     int nbit, int nlsb, int btile, 
@@ -136,6 +229,7 @@ void set_yuv_prop(yuv_seq_t *yuv, int b_realloc, int w, int h, int fmt,
                     
 void set_yuv_prop_by_copy(yuv_seq_t *dst, int b_realloc, yuv_seq_t *src);
 void show_yuv_prop(yuv_seq_t *yuv, int level, const char *prompt);
+void yuv_band_view(yuv_seq_t *band, yuv_seq_t *yuv, int y0, int h);
 int  yuv_buf_realloc(yuv_seq_t *yuv, int buf_size);
 void yuv_buf_free(yuv_seq_t *yuv);
 
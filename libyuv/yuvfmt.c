@@ -52,6 +52,7 @@ const opt_enum_t cmn_bit[] =
 {
     {"b8",   8},
     {"b10", 10},
+    {"b12", 12},
     {"b16", 16},
 };
 const int n_cmn_bit = ARRAY_SIZE(cmn_bit);
@@ -71,6 +72,12 @@ int yuv_prop_parser(cmdl_iter_t *iter, void* dst, cmdl_act_t act, cmdl_opt_t *op
         { 0, "nbit",   1, cmdl_parse_int, YUV_POP_M(seq.nbit),     "8",    "",        },
         { 0, "nlsb",   1, cmdl_parse_int, YUV_POP_M(seq.nlsb),     "0",    ""},
         { 0, "tile",   1, cmdl_parse_int, YUV_POP_M(seq.btile),     0,     ""},
+        { 0, "tile-wxh",     2, cmdl_parse_ints, YUV_POP_M(seq.tile.tw),     0,  "tile w & h"},
+        { 0, "tile-size",    1, cmdl_parse_int,  YUV_POP_M(seq.tile.tsz),    0,  "tile bytes"},
+        { 0, "tile-pad",     1, cmdl_parse_int,  YUV_POP_M(seq.tile.pad),    0,  "bytes after a tile row"},
+        { 0, "tile-scan",    1, cmdl_parse_int,  YUV_POP_M(seq.tile.scan), "raster", "tile order"},
+        { 0, "uv-tile-wxh",  2, cmdl_parse_ints, YUV_POP_M(seq.uv_tile.tw),  0,  "chroma tile w & h"},
+        { 0, "uv-tile-size", 1, cmdl_parse_int,  YUV_POP_M(seq.uv_tile.tsz), 0,  "chroma tile bytes"},
         { 0, "stride", 1, cmdl_parse_int, YUV_POP_M(seq.y_stride),  0,     ""},
         { 0, "iosize", 1, cmdl_parse_int, YUV_POP_M(seq.io_size),   0,     ""},
     };
@@ -78,11 +85,12 @@ int yuv_prop_parser(cmdl_iter_t *iter, void* dst, cmdl_act_t act, cmdl_opt_t *op
     cmdl_set_enum(n_yuv_opt, yuv_opt, "fmt",  n_cmn_fmt, cmn_fmt); 
     cmdl_set_ref (n_yuv_opt, yuv_opt, "wxh",  n_cmn_wxh, cmn_wxh); 
     cmdl_set_enum(n_yuv_opt, yuv_opt, "nbit", n_cmn_bit, cmn_bit); 
+    cmdl_set_enum(n_yuv_opt, yuv_opt, "tile-scan", n_cmn_scan, cmn_scan); 
     
     if (act == CMDL_ACT_PARSE) 
     {
         char *arg = cmdl_iter_next(iter);
-        if (arg && arg[0]!='-') {
+        if (arg && (arg[0]!='-' || 0==strcmp(arg, "-"))) {
             ((yuv_arg_t*)dst)->path = arg;
             return cmdl_parse(iter, dst, n_yuv_opt, yuv_opt);
         } else {
@@ -112,6 +120,14 @@ cmdl_opt_t fmt_opt[] =
     { 1, "src",     0, yuv_prop_parser,   FMT_OPT_M(src),           0,  "src path ...prop ..."},
     { 1, "dst",     0, yuv_prop_parser,   FMT_OPT_M(dst),           0,  "dst path ...prop ..."},
     { 0, "f-range", 1, cmdl_parse_range,  FMT_OPT_M(frame_range),   0,  "frame range"},
+    { 0, "threads", 1, cmdl_parse_int,    FMT_OPT_M(n_thread),    "1",  "worker threads per frame"},
+    { 0, "pipe",    1, cmdl_parse_int,    FMT_OPT_M(n_pipe),      "0",  "converter threads of frame pipeline"},
+    { 0, "io",      1, cmdl_parse_int,    FMT_OPT_M(io_mode), "stdio",  "io mode"},
+    { 0, "cpu",     1, cmdl_parse_int,    FMT_OPT_M(cpu),      "auto",  "pixel kernel level"},
+    { 0, "round",   1, cmdl_parse_int,    FMT_OPT_M(dst.seq.rnd), "trunc", "rounding as bits are dropped"},
+    { 0, "uv-filter", 1, cmdl_parse_int,  FMT_OPT_M(dst.seq.uv_filt), "nearest", "420/422/444 chroma filter"},
+    { 0, "uv-site", 1, cmdl_parse_int,    FMT_OPT_M(dst.seq.uv_site), "center", "vertical siting of 420 chroma"},
+    { 0, "scale-filter", 1, cmdl_parse_int, FMT_OPT_M(dst.seq.scl_filt), "bicubic", "resizing filter, dst wxh set"},
 };
 const int n_fmt_opt = ARRAY_SIZE(fmt_opt);
 
@@ -136,29 +152,46 @@ int fmt_arg_check(fmt_opt_t *cfg, int argc, char *argv[])
         xerr("@cmdl>> Invalid resolution for src\n");
         return -1;
     }
-    if ((psrc->nbit != 8 && psrc->nbit!=10 && psrc->nbit!=16) ||
+    resolve_named_fmt(psrc);
+    resolve_named_fmt(pdst);
+    if ((psrc->yuvfmt == YUVFMT_V210 && psrc->btile) ||
+        (pdst->yuvfmt == YUVFMT_V210 && pdst->btile)) {
+        xerr("@cmdl>> v210 is not tiled\n");
+        return -1;
+    }
+    if ((psrc->nbit < 8 || psrc->nbit > 16) ||
         (psrc->nbit < psrc->nlsb)) {
         xerr("@cmdl>> Invalid bitdepth (%d/%d) for src\n", 
                 psrc->nlsb, psrc->nbit);
         return -1;
     }
-    if ((pdst->nbit != 8 && pdst->nbit!=10 && pdst->nbit!=16) ||
+    if ((pdst->nbit < 8 || pdst->nbit > 16) ||
         (pdst->nbit < pdst->nlsb)) {
         xerr("@cmdl>> Invalid bitdepth (%d/%d) for dst\n", 
                 pdst->nlsb, pdst->nbit);
         return -1;
     }
     
+    if (pdst->width && pdst->height &&
+        (pdst->width != psrc->width || pdst->height != psrc->height) &&
+        (is_mch_420(psrc->yuvfmt) || is_mch_420(pdst->yuvfmt)) &&
+        !is_bit_aligned(1, pdst->height)) {
+        xerr("@cmdl>> 420 not resized to odd height %d\n", pdst->height);
+        return -1;
+    }
+    
     psrc->nlsb = psrc->nlsb ? psrc->nlsb : psrc->nbit;
     pdst->nlsb = pdst->nlsb ? pdst->nlsb : pdst->nbit;
     
-    if (!ios_open(cfg->ios, CVT_IOS_CNT, 0)) {
+    if (!yuv_ios_open(cfg->ios, CVT_IOS_CNT)) {
         ios_close(cfg->ios, CVT_IOS_CNT);
         return -1;
     }
     
-    pdst->width  = psrc->width;
-    pdst->height = psrc->height;
+    if (!pdst->width || !pdst->height) {
+        pdst->width  = psrc->width;
+        pdst->height = psrc->height;
+    }
     set_yuv_prop_by_copy(psrc, 0, psrc);
     set_yuv_prop_by_copy(pdst, 0, pdst);
     show_yuv_prop(psrc, SLOG_CMDL, "@cfg>> src: ");
@@ -184,16 +217,24 @@ int yuv_fmt(int argc, char **argv)
 {
     int         r, i;
     fmt_opt_t   cfg;
-    yuv_seq_t   seq[2];
+    cvt_plan_t  plan;
+    yuv_io_t    io, out_io;
+    yuv_seq_t   seq, in;
     yuv_seq_t *psrc = &cfg.src.seq;
     yuv_seq_t *pdst = &cfg.dst.seq;
 
-    memset(seq, 0, sizeof(seq));
+    memset(&seq, 0, sizeof(seq));
     memset(&cfg, 0, sizeof(cfg));
     set_yuv_prop(psrc, 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     set_yuv_prop(pdst, 0, 0, 0, YUVFMT_420P, BIT_8, BIT_8, TILE_0, 0, 0);
     cfg.frame_range[1] = INT_MAX;
     
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "io", n_cmn_io, cmn_io); 
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "cpu", n_cmn_cpu, cmn_cpu);
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "round", n_cmn_rnd, cmn_rnd); 
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "uv-filter", n_cmn_uv_filt, cmn_uv_filt); 
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "uv-site", n_cmn_uv_site, cmn_uv_site); 
+    cmdl_set_enum(n_fmt_opt, fmt_opt, "scale-filter", n_cmn_scl_filt, cmn_scl_filt); 
     cmdl_iter_t iter = cmdl_iter_init(argc, argv, 0);
     r = cmdl_parse(&iter, &cfg, n_fmt_opt, fmt_opt);
     if (r == CMDL_RET_HELP) {
@@ -205,7 +246,7 @@ int yuv_fmt(int argc, char **argv)
 
     //cmdl_result(&iter, &cfg, n_fmt_opt, fmt_opt);
     ios_cfg(cfg.ios, CVT_IOS_SRC, cfg.src.path, "rb");
-    ios_cfg(cfg.ios, CVT_IOS_DST, cfg.src.path, "rb");
+    ios_cfg(cfg.ios, CVT_IOS_DST, cfg.dst.path, "wb");
     
     r = fmt_arg_check(&cfg, argc, argv);
     if (r < 0) {
@@ -213,18 +254,43 @@ int yuv_fmt(int argc, char **argv)
         fmt_arg_help(&cfg, argc, argv);
         return 1;
     }
+    yuv_kern_init(cfg.cpu);
+    yuv_io_open(&io, cfg.ios[CVT_IOS_SRC].fp, cfg.io_mode, psrc->io_size);
+    yuv_io_open(&out_io, cfg.ios[CVT_IOS_DST].fp, cfg.io_mode, pdst->io_size);
     
-    int w_align = bit_sat(6, psrc->width);
-    int h_align = bit_sat(6, psrc->height);
-    int nbyte   = 1 + (psrc->nbit > 8 || psrc->nbit > 8);
-    for (i=0; i<2; ++i) {
-        seq[i].buf_size = w_align * h_align * 3 * nbyte;
-        seq[i].pbuf = (uint8_t *)malloc(seq[i].buf_size);
-        if(!seq[i].pbuf) {
-            xerr("error: malloc seq[%d] fail\n", i);
-            return -1;
+    if (cfg.n_pipe > 0) {
+        if (cfg.n_thread > 1) {
+            xinfo("@cmdl>> -threads is ignored with -pipe\n");
         }
+        r = cvt_pipe_run(&io, &out_io, cfg.frame_range, 
+                         pdst, psrc, cfg.n_pipe);
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        fmt_arg_close(&cfg);
+        return (r < 0) ? 1 : 0;
+    }
+    
+    r = cvt_plan_init(&plan, pdst, psrc, CVT_PLAN_PAD_ON_WRITE |
+                      (out_io.b_splice ? CVT_PLAN_DOUBLE_OUT : 0));
+    if (r < 0) {
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        fmt_arg_close(&cfg);
+        return 1;
+    }
+    if (cfg.n_thread > 1) {
+        cvt_plan_threads(&plan, cfg.n_thread);
+    }
+    set_yuv_prop_by_copy(&seq, 1, psrc);
+    if (!seq.pbuf) {
+        xerr("error: malloc src frame fail\n");
+        cvt_plan_free(&plan);
+        yuv_io_close(&out_io);
+        yuv_io_close(&io);
+        fmt_arg_close(&cfg);
+        return 1;
     }
+    memcpy(&in, &seq, sizeof(yuv_seq_t));
 
     /*************************************************************************
      *                          frame loop
@@ -232,38 +298,29 @@ int yuv_fmt(int argc, char **argv)
     for (i=cfg.frame_range[0]; i<cfg.frame_range[1]; i++) 
     {
         xprint("@frm>> #%d -\n", i);
-        r=fseek(cfg.ios[CVT_IOS_SRC].fp, psrc->io_size * i, SEEK_SET);
-        if (r) {
-            xerr("fseek %d error\n", psrc->io_size * i);
-            return -1;
-        }
-        
-        r = fread(seq[0].pbuf, psrc->io_size, 1, cfg.ios[CVT_IOS_SRC].fp);
-        if (r<1) {
-            if ( ios_feof(cfg.ios, CVT_IOS_SRC) ) {
+        in.pbuf = yuv_io_read(&io, i, seq.pbuf);
+        if (!in.pbuf) {
+            if (io.b_eof) {
                 xinfo("@seq>> reach file end, force stop\n");
-            } else {
-                xerr("error reading file\n");
             }
             break;
         }
 
-        set_yuv_prop_by_copy(&seq[0], 1, psrc);
-        set_yuv_prop_by_copy(&seq[1], 1, pdst);
-        yuv_seq_t *pout = yuv_cvt_frame(&seq[1], &seq[0]);
+        yuv_seq_t *pout = cvt_plan_run(&plan, &in);
         
-        r = fwrite(pout->pbuf, pout->io_size, 1, cfg.ios[CVT_IOS_DST].fp);
-        if (r<1) {
+        r = yuv_io_write(&out_io, pout, &plan.dst);
+        if (r<0) {
             xerr("error writing file\n");
             break;
         }
          xprint("@frm>> #%d -\n", i);
     } // end frame loop
     
+    yuv_io_close(&out_io);
+    yuv_io_close(&io);
     fmt_arg_close(&cfg);
-    for (i=0; i<2; ++i) {
-        yuv_buf_free(&seq[i]);
-    }
+    cvt_plan_free(&plan);
+    yuv_buf_free(&seq);
 
     return 0;
 }
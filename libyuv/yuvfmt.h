@@ -30,6 +30,10 @@ typedef struct _fmt_cvt_opt
     ios_t   ios[2];
     int     nframe;
     int     frame_range[2];
+    int     n_thread;
+    int     n_pipe;
+    int     io_mode;
+    int     cpu;
 
     yuv_arg_t   src;
     yuv_arg_t   dst;
@@ -0,0 +1,683 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvio.c
+ *  @brief Frame reads from / writes to a raw yuv file. Besides fseek+fread,
+ *      the input can be mapped, so a frame is handed out in place of being
+ *      copied, or read ahead into a slot ring by an async backend
+ *      (yuvio_pread.c, yuvio_uring.c). Pipes are streamed: frames are read
+ *      in order and skipped frames are discarded, and output to a pipe is
+ *      vmsplice()d. Output stride/iosize padding is added while writing.
+ */
+
+#define _GNU_SOURCE         //!< O_DIRECT
+
+#include <assert.h>
+#include <limits.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <errno.h>
+
+#include "yuvdef.h"
+#include "yuvio.h"
+
+#define YUVIO_AHEAD_MIN     (8 << 20)   //!< readahead window in bytes, at least
+#define YUVIO_AHEAD_FRAMES  4           //!< readahead window in frames, at least
+#define YUVIO_ZERO_SIZE     4096        //!< shared source of padding bytes
+
+#ifndef IOV_MAX
+#define IOV_MAX             1024
+#endif
+
+static const uint8_t yuv_io_zero[YUVIO_ZERO_SIZE];
+
+const opt_enum_t cmn_io[] = {
+    {"stdio",           YUVIO_STDIO },
+    {"mmap",            YUVIO_MMAP  },
+    {"pread",           YUVIO_PREAD },
+    {"uring",           YUVIO_URING },
+    {"pread-direct",    YUVIO_PREAD | YUVIO_DIRECT },
+    {"uring-direct",    YUVIO_URING | YUVIO_DIRECT },
+};
+const int n_cmn_io = ARRAY_SIZE(cmn_io);
+
+/**
+ *  @return io mode named @name, or -1
+ */
+int yuv_io_mode(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_io; ++j) {
+        if (0==strcmp(name, cmn_io[j].name)) {
+            return cmn_io[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown io mode `%s`\n", name);
+    return -1;
+}
+
+static int yuv_io_map(yuv_io_t *io)
+{
+    struct stat st;
+    
+    if (fstat(io->fd, &st) || !S_ISREG(st.st_mode) || st.st_size == 0) {
+        return -1;
+    }
+    
+    io->map_size = st.st_size;
+    io->map = (uint8_t *)mmap(0, io->map_size, PROT_READ, MAP_PRIVATE, io->fd, 0);
+    if (io->map == MAP_FAILED) {
+        io->map = 0;
+        return -1;
+    }
+    madvise(io->map, io->map_size, MADV_SEQUENTIAL);
+    
+    return 0;
+}
+
+/**
+ *  ios_open() taking path "-" as stdin or stdout, by the mode of the entry
+ *  @return as ios_open()
+ */
+int yuv_ios_open(ios_t *ios, int n)
+{
+    int k, r;
+    int b_std[8] = {0};
+    
+    assert(n <= ARRAY_SIZE(b_std));
+    for (k=0; k<n; ++k) {
+        if (ios[k].path && 0==strcmp(ios[k].path, "-")) {
+            b_std[k]    = 1;
+            ios[k].path = 0;
+        }
+    }
+    r = ios_open(ios, n, 0);
+    for (k=0; k<n; ++k) {
+        if (b_std[k]) {
+            ios[k].path = "-";
+            ios[k].fp   = (ios[k].mode[0] == 'r') ? stdin : stdout;
+        }
+    }
+    
+    return r;
+}
+
+/**
+ *  vmsplice() only hands page references to the pipe, so a frame buffer
+ *  must not be rewritten while the reader may still see it. The pipe is
+ *  shrunk to at most one frame: once a frame is fully spliced, nothing of
+ *  the frame before it is left in the pipe. A writer has to keep the last
+ *  frame untouched, see CVT_PLAN_DOUBLE_OUT.
+ */
+static void yuv_io_splice_init(yuv_io_t *io)
+{
+    struct stat st;
+    long page = sysconf(_SC_PAGESIZE);
+    int  size = page;
+    
+    if (fstat(io->fd, &st) || !S_ISFIFO(st.st_mode)) {
+        return;
+    }
+    while (size * 2 <= io->frame_size) {
+        size *= 2;
+    }
+    fcntl(io->fd, F_SETPIPE_SZ, size);
+    size = fcntl(io->fd, F_GETPIPE_SZ);
+    if (size > 0 && size <= io->frame_size) {
+        io->b_splice = 1;
+        xlog(SLOG_CMDL, "@cfg>> ", "vmsplice to pipe of %d bytes\n", size);
+    }
+}
+
+/**
+ *  @param [in] fp opened by ios_open() or yuv_ios_open()
+ *  @param [in] mode YUVIO_MMAP and the async modes fall back to YUVIO_STDIO
+ *      for input that is not a regular file. Output in a mode other than
+ *      YUVIO_STDIO is written by pwritev(), bypassing the stdio buffer.
+ *  @return 0 on success
+ */
+int yuv_io_open(yuv_io_t *io, FILE *fp, int mode, int frame_size)
+{
+    struct stat st;
+    
+    memset(io, 0, sizeof(yuv_io_t));
+    io->mode        = YUVIO_STDIO;
+    io->fp          = fp;
+    io->fd          = fileno(fp);
+    io->rfd         = -1;
+    io->frame_size  = frame_size;
+    io->n_keep      = 1;
+    io->wpos        = ftell(fp);
+    io->b_seekable  = (io->wpos >= 0);
+    io->wpos        = MAX(io->wpos, 0);
+    io->null_fd     = -1;
+    
+    if ((fcntl(io->fd, F_GETFL) & O_ACCMODE) != O_RDONLY) {
+        yuv_io_splice_init(io);
+    }
+    if (mode == YUVIO_STDIO) {
+        return 0;
+    }
+    if ((fcntl(io->fd, F_GETFL) & O_ACCMODE) == O_WRONLY) {
+        io->mode = io->b_seekable ? mode : YUVIO_STDIO;
+        return 0;
+    }
+    
+    if (mode == YUVIO_MMAP) {
+        if (yuv_io_map(io) == 0) {
+            io->mode = YUVIO_MMAP;
+        } else {
+            xinfo("@io>> fd %d can not be mapped, use stdio\n", io->fd);
+        }
+    } else {
+        if (fstat(io->fd, &st) == 0 && S_ISREG(st.st_mode)) {
+            io->mode      = mode;
+            io->file_size = st.st_size;
+        } else {
+            xinfo("@io>> fd %d is not a regular file, use stdio\n", io->fd);
+        }
+    }
+    
+    return 0;
+}
+
+/**
+ *  reopen the input for O_DIRECT, as the flag is not settable on @fp
+ */
+static int yuv_io_open_direct(yuv_io_t *io)
+{
+    char path[64];
+    int  fd;
+    
+    snprintf(path, sizeof(path), "/proc/self/fd/%d", io->fd);
+    fd = open(path, O_RDONLY | O_DIRECT);
+    if (fd < 0) {
+        xinfo("@io>> O_DIRECT not available for fd %d, use page cache\n", io->fd);
+        return -1;
+    }
+    io->rfd   = fd;
+    io->align = YUVIO_ALIGN;
+    
+    return 0;
+}
+
+/**
+ *  slot ring for frames being read ahead, plus the frames the caller may
+ *  still hold (n_keep), so no slot is reused under the caller
+ */
+static int yuv_io_async_init(yuv_io_t *io)
+{
+    int k, size;
+    
+    io->rfd   = io->fd;
+    io->align = 1;
+    if (io->mode & YUVIO_DIRECT) {
+        yuv_io_open_direct(io);
+    }
+    
+    size = (io->frame_size + 2 * YUVIO_ALIGN - 1) & ~(YUVIO_ALIGN - 1);
+    io->n_slot = io->n_keep + 1 + YUVIO_DEPTH;
+    io->slot   = (yuv_io_slot_t *)calloc(io->n_slot, sizeof(yuv_io_slot_t));
+    if (!io->slot) {
+        return -1;
+    }
+    for (k=0; k<io->n_slot; ++k) {
+        io->slot[k].id   = k;
+        io->slot[k].idx  = -1;
+        io->slot[k].size = size;
+        if (posix_memalign((void **)&io->slot[k].buf, YUVIO_ALIGN, size)) {
+            io->slot[k].buf = 0;
+            return -1;
+        }
+    }
+    
+    io->ops = (YUVIO_BACKEND(io->mode) == YUVIO_URING) ? 
+              &yuv_io_uring_ops : &yuv_io_pread_ops;
+    if (io->ops->init(io) < 0 && io->ops == &yuv_io_uring_ops) {
+        xinfo("@io>> io_uring not available, use pread\n");
+        io->ops = &yuv_io_pread_ops;
+        if (io->ops->init(io) < 0) {
+            io->ops = 0;
+        }
+    }
+    
+    return io->ops ? 0 : -1;
+}
+
+static void yuv_io_async_free(yuv_io_t *io)
+{
+    int k;
+    
+    if (io->ops) {
+        for (k=0; k<io->n_slot; ++k) {
+            io->ops->wait(io, &io->slot[k]);
+        }
+        io->ops->free(io);
+        io->ops = 0;
+    }
+    if (io->slot) {
+        for (k=0; k<io->n_slot; ++k) {
+            free(io->slot[k].buf);
+        }
+        free(io->slot);
+        io->slot = 0;
+    }
+    if (io->rfd >= 0 && io->rfd != io->fd) {
+        close(io->rfd);
+    }
+    io->rfd = -1;
+}
+
+static void yuv_io_submit(yuv_io_t *io, int idx)
+{
+    yuv_io_slot_t *slot = &io->slot[idx % io->n_slot];
+    int64_t off = (int64_t)io->frame_size * idx;
+    
+    if (slot->b_busy) {
+        io->ops->wait(io, slot);
+    }
+    
+    slot->idx  = idx;
+    slot->off  = off & ~(int64_t)(io->align - 1);
+    slot->skip = (int)(off - slot->off);
+    slot->len  = (slot->skip + io->frame_size + io->align - 1) & ~(io->align - 1);
+    slot->res  = 0;
+    io->ops->submit(io, slot);
+}
+
+/**
+ *  frame #i from the slot ring, with frames up to #i+YUVIO_DEPTH in flight
+ */
+static uint8_t *yuv_io_read_async(yuv_io_t *io, int i)
+{
+    yuv_io_slot_t *slot;
+    int k;
+    
+    if (!io->slot && yuv_io_async_init(io) < 0) {
+        xerr("@io>> async read setup failed\n");
+        yuv_io_async_free(io);
+        return 0;
+    }
+    
+    if (i != io->next_rd) {
+        for (k=0; k<io->n_slot; ++k) {
+            io->ops->wait(io, &io->slot[k]);
+            io->slot[k].idx = -1;
+        }
+        io->next_sub = i;
+    }
+    io->next_rd = i + 1;
+    
+    while (io->next_sub <= i + YUVIO_DEPTH &&
+           (int64_t)io->frame_size * io->next_sub < io->file_size) {
+        yuv_io_submit(io, io->next_sub++);
+    }
+    
+    slot = &io->slot[i % io->n_slot];
+    if (slot->idx != i) {
+        io->b_eof = 1;
+        return 0;
+    }
+    io->ops->wait(io, slot);
+    
+    if (slot->res < slot->skip + io->frame_size) {
+        io->b_eof = (slot->res >= 0);
+        if (!io->b_eof) {
+            xerr("@io>> read frame %d failed (%d)\n", i, slot->res);
+        }
+        return 0;
+    }
+    
+    return slot->buf + slot->skip;
+}
+
+/**
+ *  keep [off, off + window) requested, and release what is older than
+ *  @n_keep frames
+ */
+static void yuv_io_advise(yuv_io_t *io, size_t off)
+{
+    size_t page   = sysconf(_SC_PAGESIZE);
+    size_t window = MAX((size_t)YUVIO_AHEAD_MIN, 
+                        (size_t)io->frame_size * YUVIO_AHEAD_FRAMES);
+    size_t keep   = (size_t)io->frame_size * io->n_keep;
+    size_t end;
+    
+    if (off < io->dropped) {
+        io->dropped = off & ~(page - 1);
+        io->ahead   = io->dropped;
+    }
+    if (io->ahead < off) {
+        io->ahead = off & ~(page - 1);
+    }
+    
+    if (io->ahead < off + io->frame_size + window / 2) {
+        end = MIN(io->map_size, off + io->frame_size + window);
+        if (end > io->ahead) {
+            madvise(io->map + io->ahead, end - io->ahead, MADV_WILLNEED);
+            io->ahead = end;
+        }
+    }
+    
+    if (off > keep) {
+        end = (off - keep) & ~(page - 1);
+        if (end > io->dropped) {
+            madvise(io->map + io->dropped, end - io->dropped, MADV_DONTNEED);
+            io->dropped = end;
+        }
+    }
+}
+
+static int yuv_io_read_full(int fd, uint8_t *buf, int size)
+{
+    ssize_t r;
+    int n;
+    
+    for (n=0; n<size; n+=r) {
+        r = read(fd, buf + n, size - n);
+        if (r < 0 && errno == EINTR) {
+            r = 0;
+            continue;
+        }
+        if (r <= 0) {
+            return (r < 0) ? -1 : n;
+        }
+    }
+    return n;
+}
+
+/**
+ *  drop one frame of a pipe, by splice() into /dev/null if possible
+ *  @return bytes dropped
+ */
+static int yuv_io_skip(yuv_io_t *io, uint8_t *buf)
+{
+    ssize_t r;
+    int n = 0;
+    
+    if (io->null_fd < 0) {
+        io->null_fd = open("/dev/null", O_WRONLY);
+    }
+    while (io->null_fd >= 0 && n < io->frame_size) {
+        r = splice(io->fd, 0, io->null_fd, 0, io->frame_size - n, SPLICE_F_MOVE);
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            if (r == 0) {
+                return n;
+            }
+            break;
+        }
+        n += r;
+    }
+    if (n < io->frame_size) {
+        r  = yuv_io_read_full(io->fd, buf, io->frame_size - n);
+        n += MAX(r, 0);
+    }
+    return n;
+}
+
+/**
+ *  frame #i of a stream which can not seek: frames before #i are dropped,
+ *  frames behind the stream position are lost
+ */
+static uint8_t *yuv_io_read_stream(yuv_io_t *io, int i, uint8_t *buf)
+{
+    int r;
+    
+    if (i < io->next_rd) {
+        xerr("@io>> frame %d is already passed on a pipe\n", i);
+        return 0;
+    }
+    for (; io->next_rd < i; io->next_rd++) {
+        if (yuv_io_skip(io, buf) < io->frame_size) {
+            io->b_eof = 1;
+            return 0;
+        }
+    }
+    
+    r = yuv_io_read_full(io->fd, buf, io->frame_size);
+    if (r < io->frame_size) {
+        io->b_eof = (r >= 0);
+        if (!io->b_eof) {
+            xerr("error reading file\n");
+        }
+        return 0;
+    }
+    io->next_rd++;
+    
+    return buf;
+}
+
+/**
+ *  @brief get frame #i
+ *  @param [in] buf frame_size bytes, filled in stdio mode
+ *  @return the frame data, which is either @buf or a read-only pointer
+ *      into the mapped file or the slot ring, valid for io->n_keep more
+ *      reads; 0 at file end (io->b_eof set) or on error
+ */
+uint8_t *yuv_io_read(yuv_io_t *io, int i, uint8_t *buf)
+{
+    size_t off = (size_t)io->frame_size * i;
+    
+    if (io->mode == YUVIO_MMAP) 
+    {
+        if (off + io->frame_size > io->map_size) {
+            io->b_eof = 1;
+            return 0;
+        }
+        yuv_io_advise(io, off);
+        return io->map + off;
+    }
+    if (io->mode != YUVIO_STDIO) {
+        return yuv_io_read_async(io, i);
+    }
+    if (!io->b_seekable) {
+        return yuv_io_read_stream(io, i, buf);
+    }
+    
+    if (fseek(io->fp, (long)off, SEEK_SET)) {
+        xerr("fseek %d error\n", io->frame_size * i);
+        return 0;
+    }
+    if (fread(buf, io->frame_size, 1, io->fp) < 1) {
+        io->b_eof = feof(io->fp);
+        if (!io->b_eof) {
+            xerr("error reading file\n");
+        }
+        return 0;
+    }
+    
+    return buf;
+}
+
+/**
+ *  iovec list of one padded frame, flushed to the file as it fills up
+ */
+typedef struct _iov_list
+{
+    yuv_io_t       *io;
+    struct iovec    iov[IOV_MAX];
+    int             n;
+    ssize_t         len;
+    int             err;
+    
+} iov_list_t;
+
+static void iov_flush(iov_list_t *l)
+{
+    yuv_io_t     *io  = l->io;
+    struct iovec *iov = l->iov;
+    int           n   = l->n;
+    ssize_t       r;
+    
+    while (n > 0 && !l->err) 
+    {
+        if (io->b_splice) {
+            r = vmsplice(io->fd, iov, n, 0);
+        } else if (io->b_seekable) {
+            r = pwritev(io->fd, iov, n, io->wpos);
+        } else {
+            r = writev(io->fd, iov, n);
+        }
+        if (r < 0 && errno == EINTR) {
+            continue;
+        }
+        if (r <= 0) {
+            xerr("@io>> writev %d bytes failed (%d)\n", (int)l->len, (int)r);
+            l->err = 1;
+            break;
+        }
+        
+        /**
+         *  pipes may take part of the list
+         */
+        io->wpos += r;
+        while (n > 0 && (size_t)r >= iov->iov_len) {
+            r -= iov->iov_len;
+            iov++;
+            n--;
+        }
+        if (n > 0) {
+            iov->iov_base  = (uint8_t *)iov->iov_base + r;
+            iov->iov_len  -= r;
+        }
+    }
+    l->n   = 0;
+    l->len = 0;
+}
+
+static void iov_add(iov_list_t *l, const uint8_t *base, size_t len)
+{
+    while (len > 0) 
+    {
+        size_t n = (base == yuv_io_zero) ? MIN(len, YUVIO_ZERO_SIZE) : len;
+        
+        if (l->n == IOV_MAX) {
+            iov_flush(l);
+        }
+        l->iov[l->n].iov_base = (void *)base;
+        l->iov[l->n].iov_len  = n;
+        l->n++;
+        l->len += n;
+        len    -= n;
+    }
+}
+
+/**
+ *  @param [in] rows row count of the plane
+ *  @param [in] s/ls stride of @frame and of the target layout, s <= ls
+ */
+static void iov_add_plane(iov_list_t *l, uint8_t *base, int rows, int s, int ls)
+{
+    int y;
+    
+    if (s == ls) {
+        iov_add(l, base, (size_t)s * rows);
+        return;
+    }
+    for (y=0; y<rows; ++y) {
+        iov_add(l, base + (size_t)s * y, s);
+        iov_add(l, yuv_io_zero, ls - s);
+    }
+}
+
+/**
+ *  @brief append a frame laid out as @layout to the file.
+ *  @param [in] frame the picture of @layout with the same or tighter
+ *      strides/iosize. Row and tail padding up to @layout is written as
+ *      zeros from a shared page by scatter-gather, so the padded frame is
+ *      never built in memory.
+ *  @return 0 on success
+ */
+int yuv_io_write(yuv_io_t *io, yuv_seq_t *frame, yuv_seq_t *layout)
+{
+    static __thread iov_list_t l;
+    
+    int fmt  = frame->yuvfmt;
+    int rows = get_y_rows(frame);
+    uint8_t *base = frame->pbuf;
+    
+    if (io->mode == YUVIO_STDIO && !io->b_splice &&
+        frame->y_stride  == layout->y_stride  &&
+        frame->uv_stride == layout->uv_stride &&
+        frame->io_size   == layout->io_size) 
+    {
+        if (fwrite(frame->pbuf, frame->io_size, 1, io->fp) < 1) {
+            return -1;
+        }
+        io->wpos += frame->io_size;
+        return 0;
+    }
+    
+    assert(frame->y_stride <= layout->y_stride);
+    assert(frame->io_size  <= layout->io_size);
+    
+    fflush(io->fp);
+    l.io  = io;
+    l.n   = 0;
+    l.len = 0;
+    l.err = 0;
+    
+    iov_add_plane(&l, base, rows, frame->y_stride, layout->y_stride);
+    
+    if (is_mch_420(fmt) || is_mch_422(fmt) || is_mch_444(fmt))
+    {
+        rows  = get_uv_rows(frame);
+        base += frame->y_size;
+        iov_add_plane(&l, base, rows, frame->uv_stride, layout->uv_stride);
+        
+        if (is_mch_planar(fmt)) {
+            base += frame->uv_size;
+            iov_add_plane(&l, base, rows, frame->uv_stride, layout->uv_stride);
+        }
+    }
+    
+    /**
+     *  tail up to io_size, counted from the layout planes
+     */
+    {
+        int io_used = layout->y_size;
+        if (is_mch_420(fmt) || is_mch_422(fmt) || is_mch_444(fmt)) {
+            io_used += is_mch_planar(fmt) ? 2 * layout->uv_size : layout->uv_size;
+        }
+        iov_add(&l, yuv_io_zero, MAX(0, layout->io_size - io_used));
+    }
+    iov_flush(&l);
+    
+    return l.err ? -1 : 0;
+}
+
+void yuv_io_close(yuv_io_t *io)
+{
+    yuv_io_async_free(io);
+    if (io->null_fd > 0) {
+        close(io->null_fd);
+        io->null_fd = -1;
+    }
+    if (io->map) {
+        munmap(io->map, io->map_size);
+        io->map = 0;
+    }
+}
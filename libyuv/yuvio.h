@@ -0,0 +1,113 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+#ifndef __YUVIO_H__
+#define __YUVIO_H__
+
+#include <stdio.h>
+#include <stdint.h>
+
+enum yuv_io_mode {
+    YUVIO_STDIO = 0,
+    YUVIO_MMAP  = 1,
+    YUVIO_PREAD = 2,            //!< pread() by helper threads, read ahead
+    YUVIO_URING = 3,            //!< io_uring, read ahead
+    
+    YUVIO_DIRECT = 0x10,        //!< flag: O_DIRECT reads for PREAD/URING
+};
+#define YUVIO_BACKEND(mode)     ((mode) & 0x0f)
+
+#define YUVIO_DEPTH     4       //!< frames read ahead by async backends
+#define YUVIO_ALIGN     4096    //!< buffer and O_DIRECT offset alignment
+
+extern const opt_enum_t cmn_io[];
+extern const int n_cmn_io;
+
+/**
+ *  one frame read of an async backend
+ */
+typedef struct _yuv_io_slot
+{
+    uint8_t    *buf;            //!< YUVIO_ALIGN aligned, registered to uring
+    int         size;
+    int         id;             //!< position in the slot ring
+    int         idx;            //!< frame read into this slot, -1 if none
+    int         skip;           //!< frame start in @buf, for O_DIRECT
+    int         len;            //!< bytes requested
+    int         res;            //!< bytes read or -errno, once reaped
+    int         b_busy;         //!< submitted and not reaped yet
+    int64_t     off;
+    
+} yuv_io_slot_t;
+
+struct _yuv_io;
+
+typedef struct _yuv_io_ops
+{
+    const char *name;
+    int  (*init)  (struct _yuv_io *io);
+    void (*submit)(struct _yuv_io *io, yuv_io_slot_t *slot);
+    void (*wait)  (struct _yuv_io *io, yuv_io_slot_t *slot);
+    void (*free)  (struct _yuv_io *io);
+    
+} yuv_io_ops_t;
+
+extern const yuv_io_ops_t yuv_io_pread_ops;
+extern const yuv_io_ops_t yuv_io_uring_ops;
+
+/**
+ *  frame reader/writer over an opened ios_t stream
+ */
+typedef struct _yuv_io
+{
+    int         mode;
+    FILE       *fp;
+    int         fd;
+    int         frame_size;
+    int         n_keep;         //!< frames before the current one kept mapped
+    int         b_eof;
+    int         b_seekable;
+    int         b_splice;       //!< output is a pipe taking vmsplice()
+    int         null_fd;        //!< /dev/null, sink of skipped pipe input
+    int64_t     wpos;           //!< file offset of the next frame written
+    
+    uint8_t    *map;
+    size_t      map_size;
+    size_t      ahead;          //!< readahead requested up to this offset
+    size_t      dropped;        //!< pages below this offset are released
+    
+    const yuv_io_ops_t *ops;    //!< async backend, set up at the first read
+    void       *be;             //!< backend state
+    int         rfd;            //!< fd of async reads, may be O_DIRECT
+    int         align;          //!< offset/length alignment of async reads
+    int64_t     file_size;
+    int         n_slot;
+    yuv_io_slot_t *slot;
+    int         next_rd;        //!< frame expected by the next read, or
+                                //!< the stream position of a pipe
+    int         next_sub;       //!< frame to be submitted next
+    
+} yuv_io_t;
+
+int      yuv_ios_open(ios_t *ios, int n);
+int      yuv_io_open (yuv_io_t *io, FILE *fp, int mode, int frame_size);
+uint8_t *yuv_io_read (yuv_io_t *io, int i, uint8_t *buf);
+int      yuv_io_write(yuv_io_t *io, yuv_seq_t *frame, yuv_seq_t *layout);
+void     yuv_io_close(yuv_io_t *io);
+int      yuv_io_mode (const char *name);
+
+
+#endif  // __YUVIO_H__
@@ -0,0 +1,162 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvio_pread.c
+ *  @brief Async read backend of plain pread() calls, issued by a few helper
+ *      threads so the file is read ahead of the frame being converted.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+
+#include "yuvdef.h"
+#include "yuvthr.h"
+#include "yuvio.h"
+
+#define PREAD_N_THREAD  2
+
+/**
+ *  frames go to reader (idx % PREAD_N_THREAD), so each reader completes
+ *  its slots in the order they are waited for
+ */
+typedef struct _pread_thr
+{
+    yuv_io_t       *io;
+    pthread_t       tid;
+    spsc_queue_t    q_req;
+    spsc_queue_t    q_done;
+    
+} pread_thr_t;
+
+typedef struct _pread_be
+{
+    int             n_thread;
+    pread_thr_t     thr[PREAD_N_THREAD];
+    
+} pread_be_t;
+
+static void *pread_worker(void *arg)
+{
+    pread_thr_t   *thr = (pread_thr_t *)arg;
+    yuv_io_slot_t *slot;
+    ssize_t r, n;
+    
+    while ((slot = (yuv_io_slot_t *)spsc_pop(&thr->q_req)) != 0)
+    {
+        for (n=0; n<slot->len; n+=r) {
+            r = pread(thr->io->rfd, slot->buf + n, slot->len - n, slot->off + n);
+            if (r < 0 && errno == EINTR) {
+                r = 0;
+                continue;
+            }
+            if (r <= 0) {
+                break;
+            }
+        }
+        slot->res = (r < 0) ? -errno : (int)n;
+        spsc_push(&thr->q_done, slot);
+    }
+    
+    return 0;
+}
+
+static void pread_free(yuv_io_t *io);
+
+static int pread_init(yuv_io_t *io)
+{
+    pread_be_t *be;
+    int k;
+    
+    be = (pread_be_t *)calloc(1, sizeof(pread_be_t));
+    if (!be) {
+        return -1;
+    }
+    io->be = be;
+    
+    for (k=0; k<PREAD_N_THREAD; ++k) {
+        pread_thr_t *thr = &be->thr[k];
+        thr->io = io;
+        if (spsc_init(&thr->q_req,  io->n_slot + 1) < 0 || 
+            spsc_init(&thr->q_done, io->n_slot) < 0) {
+            break;
+        }
+        if (pthread_create(&thr->tid, 0, pread_worker, thr)) {
+            xerr("@io>> pthread_create() failed for reader #%d\n", k);
+            break;
+        }
+        be->n_thread++;
+    }
+    if (be->n_thread < PREAD_N_THREAD) {
+        pread_free(io);
+        return -1;
+    }
+    
+    return 0;
+}
+
+static void pread_submit(yuv_io_t *io, yuv_io_slot_t *slot)
+{
+    pread_be_t *be = (pread_be_t *)io->be;
+    
+    slot->b_busy = 1;
+    spsc_push(&be->thr[slot->idx % be->n_thread].q_req, slot);
+}
+
+static void pread_wait(yuv_io_t *io, yuv_io_slot_t *slot)
+{
+    pread_be_t  *be = (pread_be_t *)io->be;
+    pread_thr_t *thr;
+    yuv_io_slot_t *done;
+    
+    if (!slot->b_busy) {
+        return;
+    }
+    thr = &be->thr[slot->idx % be->n_thread];
+    do {
+        done = (yuv_io_slot_t *)spsc_pop(&thr->q_done);
+        done->b_busy = 0;
+    } while (done != slot);
+}
+
+static void pread_free(yuv_io_t *io)
+{
+    pread_be_t *be = (pread_be_t *)io->be;
+    int k;
+    
+    if (!be) {
+        return;
+    }
+    for (k=0; k<be->n_thread; ++k) {
+        spsc_push(&be->thr[k].q_req, 0);
+        pthread_join(be->thr[k].tid, 0);
+    }
+    for (k=0; k<PREAD_N_THREAD; ++k) {
+        spsc_free(&be->thr[k].q_req);
+        spsc_free(&be->thr[k].q_done);
+    }
+    free(be);
+    io->be = 0;
+}
+
+const yuv_io_ops_t yuv_io_pread_ops = 
+{
+    "pread", pread_init, pread_submit, pread_wait, pread_free,
+};
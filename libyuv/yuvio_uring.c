@@ -0,0 +1,253 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvio_uring.c
+ *  @brief Async read backend on io_uring, set up by raw syscalls. Slot
+ *      buffers are registered once, so a frame read is a READ_FIXED entry
+ *      and a steady frame loop costs one io_uring_enter() per frame.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <linux/io_uring.h>
+
+#include "yuvdef.h"
+#include "yuvio.h"
+
+typedef struct _uring_be
+{
+    int             fd;
+    int             b_fixed;    //!< slot buffers registered
+    int             n_pending;  //!< queued, not yet passed to the kernel
+    
+    uint8_t        *sq_ptr;
+    size_t          sq_len;
+    unsigned       *sq_head;
+    unsigned       *sq_tail;
+    unsigned       *sq_mask;
+    unsigned       *sq_array;
+    struct io_uring_sqe *sqes;
+    size_t          sqes_len;
+    
+    uint8_t        *cq_ptr;
+    size_t          cq_len;
+    unsigned       *cq_head;
+    unsigned       *cq_tail;
+    unsigned       *cq_mask;
+    struct io_uring_cqe *cqes;
+    
+} uring_be_t;
+
+static int uring_setup(unsigned entries, struct io_uring_params *p)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int uring_enter(int fd, unsigned to_submit, unsigned min_complete, 
+                       unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, 
+                        flags, 0, 0);
+}
+
+static int uring_register(int fd, unsigned opcode, void *arg, unsigned n_arg)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, n_arg);
+}
+
+static void uring_free(yuv_io_t *io);
+
+static int uring_init(yuv_io_t *io)
+{
+    struct io_uring_params p;
+    struct iovec *iov;
+    uring_be_t *be;
+    int k;
+    
+    be = (uring_be_t *)calloc(1, sizeof(uring_be_t));
+    if (!be) {
+        return -1;
+    }
+    io->be = be;
+    
+    memset(&p, 0, sizeof(p));
+    be->fd = uring_setup(io->n_slot, &p);
+    if (be->fd < 0) {
+        uring_free(io);
+        return -1;
+    }
+    
+    be->sq_len = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+    be->cq_len = p.cq_off.cqes  + p.cq_entries * sizeof(struct io_uring_cqe);
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        be->sq_len = be->cq_len = MAX(be->sq_len, be->cq_len);
+    }
+    be->sq_ptr = (uint8_t *)mmap(0, be->sq_len, PROT_READ | PROT_WRITE, 
+                    MAP_SHARED | MAP_POPULATE, be->fd, IORING_OFF_SQ_RING);
+    if (be->sq_ptr == MAP_FAILED) {
+        be->sq_ptr = 0;
+        uring_free(io);
+        return -1;
+    }
+    if (p.features & IORING_FEAT_SINGLE_MMAP) {
+        be->cq_ptr = be->sq_ptr;
+    } else {
+        be->cq_ptr = (uint8_t *)mmap(0, be->cq_len, PROT_READ | PROT_WRITE, 
+                        MAP_SHARED | MAP_POPULATE, be->fd, IORING_OFF_CQ_RING);
+        if (be->cq_ptr == MAP_FAILED) {
+            be->cq_ptr = 0;
+            uring_free(io);
+            return -1;
+        }
+    }
+    be->sqes_len = p.sq_entries * sizeof(struct io_uring_sqe);
+    be->sqes = (struct io_uring_sqe *)mmap(0, be->sqes_len, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, be->fd, IORING_OFF_SQES);
+    if (be->sqes == MAP_FAILED) {
+        be->sqes = 0;
+        uring_free(io);
+        return -1;
+    }
+    
+    be->sq_head  = (unsigned *)(be->sq_ptr + p.sq_off.head);
+    be->sq_tail  = (unsigned *)(be->sq_ptr + p.sq_off.tail);
+    be->sq_mask  = (unsigned *)(be->sq_ptr + p.sq_off.ring_mask);
+    be->sq_array = (unsigned *)(be->sq_ptr + p.sq_off.array);
+    be->cq_head  = (unsigned *)(be->cq_ptr + p.cq_off.head);
+    be->cq_tail  = (unsigned *)(be->cq_ptr + p.cq_off.tail);
+    be->cq_mask  = (unsigned *)(be->cq_ptr + p.cq_off.ring_mask);
+    be->cqes     = (struct io_uring_cqe *)(be->cq_ptr + p.cq_off.cqes);
+    
+    /**
+     *  registered buffers are pinned, which RLIMIT_MEMLOCK may refuse;
+     *  plain READ entries are used then
+     */
+    iov = (struct iovec *)calloc(io->n_slot, sizeof(struct iovec));
+    if (iov) {
+        for (k=0; k<io->n_slot; ++k) {
+            iov[k].iov_base = io->slot[k].buf;
+            iov[k].iov_len  = io->slot[k].size;
+        }
+        be->b_fixed = (uring_register(be->fd, IORING_REGISTER_BUFFERS, 
+                                      iov, io->n_slot) == 0);
+        free(iov);
+    }
+    xlog(SLOG_CMDL, "@cfg>> ", "io_uring of %d entries, %s buffers\n", 
+         p.sq_entries, be->b_fixed ? "registered" : "plain");
+    
+    return 0;
+}
+
+static void uring_submit(yuv_io_t *io, yuv_io_slot_t *slot)
+{
+    uring_be_t *be = (uring_be_t *)io->be;
+    unsigned tail = *be->sq_tail;
+    unsigned k    = tail & *be->sq_mask;
+    struct io_uring_sqe *sqe = &be->sqes[k];
+    
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+    sqe->opcode    = be->b_fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd        = io->rfd;
+    sqe->addr      = (uint64_t)(uintptr_t)slot->buf;
+    sqe->len       = slot->len;
+    sqe->off       = slot->off;
+    sqe->buf_index = be->b_fixed ? slot->id : 0;
+    sqe->user_data = (uint64_t)(uintptr_t)slot;
+    be->sq_array[k] = k;
+    __atomic_store_n(be->sq_tail, tail + 1, __ATOMIC_RELEASE);
+    
+    slot->b_busy = 1;
+    be->n_pending++;
+}
+
+static void uring_reap(uring_be_t *be)
+{
+    unsigned head = *be->cq_head;
+    
+    while (head != __atomic_load_n(be->cq_tail, __ATOMIC_ACQUIRE)) {
+        struct io_uring_cqe *cqe = &be->cqes[head & *be->cq_mask];
+        yuv_io_slot_t *slot = (yuv_io_slot_t *)(uintptr_t)cqe->user_data;
+        slot->res    = cqe->res;
+        slot->b_busy = 0;
+        head++;
+    }
+    __atomic_store_n(be->cq_head, head, __ATOMIC_RELEASE);
+}
+
+/**
+ *  pass the queued entries to the kernel, and block until @slot is done
+ *  if it is still in flight. Short reads are not resubmitted: they only
+ *  happen at the end of the file.
+ */
+static void uring_wait(yuv_io_t *io, yuv_io_slot_t *slot)
+{
+    uring_be_t *be = (uring_be_t *)io->be;
+    int r;
+    
+    uring_reap(be);
+    while (be->n_pending > 0 || slot->b_busy) 
+    {
+        r = uring_enter(be->fd, be->n_pending, slot->b_busy, 
+                        slot->b_busy ? IORING_ENTER_GETEVENTS : 0);
+        if (r < 0) {
+            if (errno == EINTR || errno == EAGAIN) {
+                continue;
+            }
+            xerr("@io>> io_uring_enter() failed (%d)\n", -errno);
+            slot->res    = -errno;
+            slot->b_busy = 0;
+            return;
+        }
+        be->n_pending -= r;
+        uring_reap(be);
+    }
+}
+
+static void uring_free(yuv_io_t *io)
+{
+    uring_be_t *be = (uring_be_t *)io->be;
+    
+    if (!be) {
+        return;
+    }
+    if (be->sqes) {
+        munmap(be->sqes, be->sqes_len);
+    }
+    if (be->cq_ptr && be->cq_ptr != be->sq_ptr) {
+        munmap(be->cq_ptr, be->cq_len);
+    }
+    if (be->sq_ptr) {
+        munmap(be->sq_ptr, be->sq_len);
+    }
+    if (be->fd > 0) {
+        close(be->fd);
+    }
+    free(be);
+    io->be = 0;
+}
+
+const yuv_io_ops_t yuv_io_uring_ops = 
+{
+    "uring", uring_init, uring_submit, uring_wait, uring_free,
+};
@@ -0,0 +1,569 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvkern.c
+ *  @brief Dispatch of the row kernels: scalar versions, cpu detection,
+ *      and the table filled by yuv_kern_init(). Callers loop over rows and
+ *      call through yuv_kern, so a SIMD version only has to be added to its
+ *      ISA file and registered there.
+ */
+
+#include <assert.h>
+#include <string.h>
+#include <stdio.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+const opt_enum_t cmn_cpu[] = {
+    {"auto",    CPU_AUTO    },
+    {"c",       CPU_C       },
+    {"sse2",    CPU_SSE2    },
+    {"ssse3",   CPU_SSSE3   },
+    {"sse41",   CPU_SSE41   },
+    {"avx2",    CPU_AVX2    },
+    {"avx512",  CPU_AVX512  },
+};
+const int n_cmn_cpu = ARRAY_SIZE(cmn_cpu);
+
+static const char *cpu_name(int level)
+{
+    int j;
+    for (j=0; j<n_cmn_cpu; ++j) {
+        if (cmn_cpu[j].val == level) {
+            return cmn_cpu[j].name;
+        }
+    }
+    return "?";
+}
+
+/**
+ *  @return cpu level named @name, or -1
+ */
+int yuv_cpu_level(const char *name)
+{
+    int j;
+    for (j=0; j<n_cmn_cpu; ++j) {
+        if (0==strcmp(name, cmn_cpu[j].name)) {
+            return cmn_cpu[j].val;
+        }
+    }
+    xerr("@cmdl>> unknown cpu level `%s`\n", name);
+    return -1;
+}
+
+/*****************************************************************************
+ *                          scalar kernels
+ ****************************************************************************/
+static void b8_uv_split_c(uint8_t *u, uint8_t *v, uint8_t *uv, int n)
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b8_uv_merge_c(uint8_t *uv, uint8_t *u, uint8_t *v, int n)
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+static void b16_uv_split_c(uint16_t *u, uint16_t *v, uint16_t *uv, int n)
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b16_uv_merge_c(uint16_t *uv, uint16_t *u, uint16_t *v, int n)
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+static void b8_yuyv_split_c(uint8_t *y, uint8_t *u, uint8_t *v, uint8_t *p, 
+                            int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b8_yuyv_merge_c(uint8_t *p, uint8_t *y, uint8_t *u, uint8_t *v, 
+                            int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+static void b16_yuyv_split_c(uint16_t *y, uint16_t *u, uint16_t *v, uint16_t *p, 
+                             int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b16_yuyv_merge_c(uint16_t *p, uint16_t *y, uint16_t *u, uint16_t *v, 
+                             int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+static void b8_yuyv_split_sp_c(uint8_t *y, uint8_t *uv, uint8_t *p, int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b16_yuyv_split_sp_c(uint16_t *y, uint16_t *uv, uint16_t *p, int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    for (x=0; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b8_shuf4_c(uint8_t *dst, uint8_t *src, int n, const uint8_t perm[4])
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+static void b16_shuf4_c(uint16_t *dst, uint16_t *src, int n, const uint8_t perm[4])
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+static void b16_to_b8_c(uint8_t *dst, uint16_t *src, int n, int lshift, 
+                        const uint16_t bias[4])
+{
+    int x, v;
+    for (x=0; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint8_t)(MIN(v, 0xffff) >> 8);
+    }
+}
+
+static void b8_to_b16_c(uint16_t *dst, uint8_t *src, int n, int lshift)
+{
+    int x;
+    for (x=0; x<n; ++x) {
+        dst[x] = (uint16_t)(src[x] << lshift);
+    }
+}
+
+static void b16_shift_c(uint16_t *dst, uint16_t *src, int n, int lshift, int rshift,
+                        const uint16_t bias[4])
+{
+    int x, v;
+    for (x=0; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint16_t)(MIN(v, 0xffff) >> rshift);
+    }
+}
+
+static void b8_vfilt_c(uint8_t *dst, uint8_t *r[4], const int16_t c[4], int n)
+{
+    int x, v;
+    for (x=0; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+static void b16_vfilt_c(uint16_t *dst, uint16_t *r[4], const int16_t c[4], int n, int max)
+{
+    int x, v;
+    for (x=0; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint16_t)MIN(v, max);
+    }
+}
+
+static void b8_vscale_c(uint8_t *dst, uint8_t **r, const int16_t *c, int nt, int n)
+{
+    int x, k, v;
+    for (x=0; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * r[k][x];
+        }
+        v = v<0 ? 0 : v>>14;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+/**
+ *  samples biased by -32768 keep the sums in 32 bits; as the taps sum to
+ *  1<<14, the bias comes back whole after the shift
+ */
+static void b16_vscale_c(uint16_t *dst, uint16_t **r, const int16_t *c, int nt, int n, int max)
+{
+    int x, k, v;
+    for (x=0; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * (r[k][x] - 32768);
+        }
+        v = (v >> 14) + 32768;
+        dst[x] = (uint16_t)(v<0 ? 0 : MIN(v, max));
+    }
+}
+
+static void b8_hscale_c(uint8_t *dst, uint8_t *src, const int32_t *pos, const int16_t *c,
+                        int nt, int n)
+{
+    int x, k, v;
+    for (x=0; x<n; ++x, c+=nt) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * src[pos[x] + k];
+        }
+        v = v<0 ? 0 : v>>14;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+static void b16_hscale_c(uint16_t *dst, uint16_t *src, const int32_t *pos, const int16_t *c,
+                         int nt, int n, int max)
+{
+    int x, k, v;
+    for (x=0; x<n; ++x, c+=nt) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * (src[pos[x] + k] - 32768);
+        }
+        v = (v >> 14) + 32768;
+        dst[x] = (uint16_t)(v<0 ? 0 : MIN(v, max));
+    }
+}
+
+static void b8_diff_c(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[3])
+{
+    uint64_t sad = 0, ssd = 0;
+    int x, e, m = 0;
+    for (x=0; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        m = MAX(m, e);
+        sad += e;
+        ssd += e*e;
+    }
+    for (x=0; d && x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        d[x] = (uint8_t)(e>0 ? e : -e);
+    }
+    sum[0] += sad;
+    sum[1] += ssd;
+    sum[2]  = MAX(sum[2], (uint64_t)m);
+}
+
+static void b16_diff_c(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[3])
+{
+    uint64_t sad = 0, ssd = 0;
+    int x, e, m = 0;
+    for (x=0; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        m = MAX(m, e);
+        sad += e;
+        ssd += (uint64_t)e*e;
+    }
+    for (x=0; d && x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        d[x] = (uint16_t)(e>0 ? e : -e);
+    }
+    sum[0] += sad;
+    sum[1] += ssd;
+    sum[2]  = MAX(sum[2], (uint64_t)m);
+}
+
+static void b8_diff4_c(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[4][3])
+{
+    uint64_t sad[4] = {0}, ssd[4] = {0};
+    int x, e, m[4] = {0};
+    for (x=0; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        m[x & 3] = MAX(m[x & 3], e);
+        sad[x & 3] += e;
+        ssd[x & 3] += e*e;
+    }
+    for (x=0; d && x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        d[x] = (uint8_t)(e>0 ? e : -e);
+    }
+    for (x=0; x<4; ++x) {
+        sum[x][0] += sad[x];
+        sum[x][1] += ssd[x];
+        sum[x][2]  = MAX(sum[x][2], (uint64_t)m[x]);
+    }
+}
+
+static void b16_diff4_c(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[4][3])
+{
+    uint64_t sad[4] = {0}, ssd[4] = {0};
+    int x, e, m[4] = {0};
+    for (x=0; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        m[x & 3] = MAX(m[x & 3], e);
+        sad[x & 3] += e;
+        ssd[x & 3] += (uint64_t)e*e;
+    }
+    for (x=0; d && x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        d[x] = (uint16_t)(e>0 ? e : -e);
+    }
+    for (x=0; x<4; ++x) {
+        sum[x][0] += sad[x];
+        sum[x][1] += ssd[x];
+        sum[x][2]  = MAX(sum[x][2], (uint64_t)m[x]);
+    }
+}
+
+static void b8_ssim_4x4_c(uint8_t *a, int sa, uint8_t *b, int sb, int n, uint64_t (*s)[4])
+{
+    int i, x, y;
+    for (i=0; i<n; ++i, a+=4, b+=4) {
+        uint32_t s1 = 0, s2 = 0, ss = 0, s12 = 0;
+        for (y=0; y<4; ++y) {
+            for (x=0; x<4; ++x) {
+                uint32_t va = a[y*sa + x];
+                uint32_t vb = b[y*sb + x];
+                s1  += va;
+                s2  += vb;
+                ss  += va*va + vb*vb;
+                s12 += va*vb;
+            }
+        }
+        s[i][0] = s1;
+        s[i][1] = s2;
+        s[i][2] = ss;
+        s[i][3] = s12;
+    }
+}
+
+static void b16_ssim_4x4_c(uint16_t *a, int sa, uint16_t *b, int sb, int n, uint64_t (*s)[4])
+{
+    int i, x, y;
+    for (i=0; i<n; ++i, a+=4, b+=4) {
+        uint64_t s1 = 0, s2 = 0, ss = 0, s12 = 0;
+        for (y=0; y<4; ++y) {
+            uint16_t *ra = (uint16_t *)((uint8_t *)a + y*sa);
+            uint16_t *rb = (uint16_t *)((uint8_t *)b + y*sb);
+            for (x=0; x<4; ++x) {
+                uint64_t va = ra[x];
+                uint64_t vb = rb[x];
+                s1  += va;
+                s2  += vb;
+                ss  += va*va + vb*vb;
+                s12 += va*vb;
+            }
+        }
+        s[i][0] = s1;
+        s[i][1] = s2;
+        s[i][2] = ss;
+        s[i][3] = s12;
+    }
+}
+
+#define YUV_KERN_C                                      \
+{                                                       \
+    CPU_C,                                              \
+    b8_uv_split_c,      b8_uv_merge_c,                  \
+    b16_uv_split_c,     b16_uv_merge_c,                 \
+    b8_yuyv_split_c,    b8_yuyv_merge_c,                \
+    b16_yuyv_split_c,   b16_yuyv_merge_c,               \
+    b8_yuyv_split_sp_c, b16_yuyv_split_sp_c,            \
+    b8_shuf4_c,         b16_shuf4_c,                    \
+    b16_to_b8_c,        b8_to_b16_c,        b16_shift_c,\
+    b8_vfilt_c,         b16_vfilt_c,                    \
+    b8_vscale_c,        b16_vscale_c,                   \
+    b8_hscale_c,        b16_hscale_c,                   \
+    bn_linear_unpack_lte,   bn_linear_pack_lte,         \
+    bn_tile_row_unpack,     bn_tile_row_pack,           \
+    v210_row_unpack,        v210_row_pack,              \
+    b8_diff_c,          b16_diff_c,                     \
+    b8_diff4_c,         b16_diff4_c,                    \
+    b8_ssim_4x4_c,      b16_ssim_4x4_c,                 \
+}
+
+static const yuv_kern_t yuv_kern_c = YUV_KERN_C;
+
+/**
+ *  scalar until yuv_kern_init() runs, so library callers skipping it
+ *  still work
+ */
+yuv_kern_t yuv_kern = YUV_KERN_C;
+
+/*****************************************************************************
+ *                          cpu detection
+ ****************************************************************************/
+#if defined(__x86_64__) || defined(__i386__)
+static uint64_t get_xcr0(void)
+{
+    uint32_t lo, hi;
+    __asm__ volatile ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+    return ((uint64_t)hi << 32) | lo;
+}
+
+/**
+ *  @return the highest level the cpu and the OS (saved register state)
+ *      both support. Levels are cumulative.
+ */
+int cpu_detect(void)
+{
+    unsigned a, b, c, d;
+    uint64_t xcr0;
+    int level = CPU_C;
+    
+    if (!__get_cpuid(1, &a, &b, &c, &d) || !(d & bit_SSE2)) {
+        return level;
+    }
+    level = CPU_SSE2;
+    if (!(c & bit_SSSE3)) {
+        return level;
+    }
+    level = CPU_SSSE3;
+    if (!(c & bit_SSE4_1)) {
+        return level;
+    }
+    level = CPU_SSE41;
+    if (!(c & bit_OSXSAVE) || !(c & bit_AVX)) {
+        return level;
+    }
+    
+    xcr0 = get_xcr0();
+    if ((xcr0 & 0x06) != 0x06 || !__get_cpuid_count(7, 0, &a, &b, &c, &d) ||
+        !(b & bit_AVX2)) {
+        return level;
+    }
+    level = CPU_AVX2;
+    if ((xcr0 & 0xe6) == 0xe6 && (b & bit_AVX512F) && (b & bit_AVX512BW)) {
+        level = CPU_AVX512;
+    }
+    
+    return level;
+}
+#else
+int cpu_detect(void)
+{
+    return CPU_C;
+}
+#endif
+
+/**
+ *  @brief fill yuv_kern for @level. Call before any worker thread starts.
+ *  @param [in] level CPU_AUTO, or a level to force for testing; levels the
+ *      cpu lacks are lowered to the detected one
+ *  @return the level in use
+ */
+int yuv_kern_init(int level)
+{
+    int hw = cpu_detect();
+    
+    if (level == CPU_AUTO) {
+        level = hw;
+    } else if (level > hw) {
+        xinfo("@cpu>> %s is not supported, use %s\n", cpu_name(level), cpu_name(hw));
+        level = hw;
+    }
+    
+    /**
+     *  scalar first, then each ISA file up to @level overrides the entries
+     *  it has
+     */
+    memcpy(&yuv_kern, &yuv_kern_c, sizeof(yuv_kern_t));
+    yuv_kern.level = level;
+#if defined(__x86_64__) || defined(__i386__)
+    if (level >= CPU_SSE2) {
+        yuv_kern_set_sse2(&yuv_kern);
+    }
+    if (level >= CPU_SSSE3) {
+        yuv_kern_set_ssse3(&yuv_kern);
+    }
+    if (level >= CPU_AVX2) {
+        yuv_kern_set_avx2(&yuv_kern);
+    }
+#endif
+    
+    xlog(SLOG_CMDL, "@cfg>> ", "cpu kernels: %s (detected %s)\n", 
+         cpu_name(level), cpu_name(hw));
+    
+    return level;
+}
@@ -0,0 +1,159 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+#ifndef __YUVKERN_H__
+#define __YUVKERN_H__
+
+#include <stdint.h>
+
+enum cpu_level {
+    CPU_AUTO    = 0,            //!< as detected
+    CPU_C       = 1,
+    CPU_SSE2    = 2,
+    CPU_SSSE3   = 3,
+    CPU_SSE41   = 4,
+    CPU_AVX2    = 5,
+    CPU_AVX512  = 6,            //!< AVX-512F + AVX-512BW
+};
+
+extern const opt_enum_t cmn_cpu[];
+extern const int n_cmn_cpu;
+
+/**
+ *  row kernels, picked once by the cpu level. Every entry has a scalar
+ *  version (yuvkern.c); an ISA file replaces the entries it implements.
+ *  @n counts samples, or sample pairs for the uv/yuyv entries
+ */
+typedef struct _yuv_kern
+{
+    int     level;
+    
+    void (*b8_uv_split)   (uint8_t  *u, uint8_t  *v, uint8_t  *uv, int n);
+    void (*b8_uv_merge)   (uint8_t  *uv, uint8_t  *u, uint8_t  *v, int n);
+    void (*b16_uv_split)  (uint16_t *u, uint16_t *v, uint16_t *uv, int n);
+    void (*b16_uv_merge)  (uint16_t *uv, uint16_t *u, uint16_t *v, int n);
+    
+    /**
+     *  @yo luma offset in the 4-sample group: 0 for yuyv, 1 for uyvy
+     */
+    void (*b8_yuyv_split) (uint8_t  *y, uint8_t  *u, uint8_t  *v, uint8_t  *p, int n, int yo);
+    void (*b8_yuyv_merge) (uint8_t  *p, uint8_t  *y, uint8_t  *u, uint8_t  *v, int n, int yo);
+    void (*b16_yuyv_split)(uint16_t *y, uint16_t *u, uint16_t *v, uint16_t *p, int n, int yo);
+    void (*b16_yuyv_merge)(uint16_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int n, int yo);
+    
+    /**
+     *  yuyv/uyvy -> luma + interleaved uv; @uv may be 0 to drop the chroma
+     *  of the row
+     */
+    void (*b8_yuyv_split_sp) (uint8_t  *y, uint8_t  *uv, uint8_t  *p, int n, int yo);
+    void (*b16_yuyv_split_sp)(uint16_t *y, uint16_t *uv, uint16_t *p, int n, int yo);
+    
+    /**
+     *  reorder in groups of 4: dst[4i+k] = src[4i+perm[k]], not in place. 
+     *  @n counts samples; a last group of 2 needs perm[0..1] within it.
+     */
+    void (*b8_shuf4)      (uint8_t  *dst, uint8_t  *src, int n, const uint8_t perm[4]);
+    void (*b16_shuf4)     (uint16_t *dst, uint16_t *src, int n, const uint8_t perm[4]);
+    
+    /**
+     *  depth: dst = (src << @lshift) + bias[x&3], saturated to 16 bits, 
+     *  then >> 8 (@rshift). The bias row rounds or dithers; all 0 truncates.
+     */
+    void (*b16_to_b8)     (uint8_t  *dst, uint16_t *src, int n, int lshift, const uint16_t bias[4]);
+    void (*b8_to_b16)     (uint16_t *dst, uint8_t  *src, int n, int lshift);
+    void (*b16_shift)     (uint16_t *dst, uint16_t *src, int n, int lshift, int rshift, 
+                           const uint16_t bias[4]);
+    
+    /**
+     *  vertical 4-tap filter: dst = (sum c[i]*r[i][x] + 32) >> 6, clamped
+     *  to [0, 255] or [0, @max]. Taps sum to 64; the positive ones to 
+     *  128 at most.
+     */
+    void (*b8_vfilt)      (uint8_t  *dst, uint8_t  *r[4], const int16_t c[4], int n);
+    void (*b16_vfilt)     (uint16_t *dst, uint16_t *r[4], const int16_t c[4], int n, int max);
+    
+    /**
+     *  polyphase scaling, 14-bit taps summing to 1<<14: 
+     *  vscale: dst[x] = sum c[k]*r[k][x], k < @nt
+     *  hscale: dst[x] = sum c[x*nt+k]*src[pos[x]+k], @nt a multiple of 4
+     *  rounded, >> 14 and clamped to [0, 255] or [0, @max]
+     */
+    void (*b8_vscale)     (uint8_t  *dst, uint8_t  **r, const int16_t *c, int nt, int n);
+    void (*b16_vscale)    (uint16_t *dst, uint16_t **r, const int16_t *c, int nt, int n, int max);
+    void (*b8_hscale)     (uint8_t  *dst, uint8_t  *src, const int32_t *pos, const int16_t *c, 
+                           int nt, int n);
+    void (*b16_hscale)    (uint16_t *dst, uint16_t *src, const int32_t *pos, const int16_t *c, 
+                           int nt, int n, int max);
+    
+    /**
+     *  @nbit (9..15) lte bitstream of @n_byte bytes <-> @n16 samples
+     */
+    void (*bn_unpack)     (void *bn, int n_byte, void *b16, int n16, int nbit);
+    void (*bn_pack)       (void *bn, int n_byte, void *b16, int n16, int nbit);
+    
+    /**
+     *  one row of @nbit tiles <-> @h (<= @th) raster rows of @w samples,
+     *  @s bytes apart. A tile holds @tw x @th samples in @tsz bytes, sample
+     *  (x,y) at bit nbit*(x*th+y); pack zeroes the unused bits.
+     */
+    void (*bn_tile_unpack)(uint8_t *t, int tw, int th, int tsz, uint16_t *r, int w, int h, int s, int nbit);
+    void (*bn_tile_pack)  (uint8_t *t, int tw, int th, int tsz, uint16_t *r, int w, int h, int s, int nbit);
+    
+    /**
+     *  one row of v210 (16 bytes per 6 pixels) <-> @w luma and @w/2 u, v
+     *  samples of 10-bit in 16; pack zeroes the rest of the last block
+     */
+    void (*v210_unpack)   (uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w);
+    void (*v210_pack)     (uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w);
+    
+    /**
+     *  |a-b| into @d, sum[0] += sad, sum[1] += ssd, sum[2] = max(sum[2], 
+     *  max |a-b|); a null @d takes the sums only
+     */
+    void (*b8_diff)       (uint8_t  *a, uint8_t  *b, uint8_t  *d, int n, uint64_t sum[3]);
+    void (*b16_diff)      (uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[3]);
+    
+    /**
+     *  diff with the sums split by position, sample x into sum[x & 3], for 
+     *  rows of interleaved planes
+     */
+    void (*b8_diff4)      (uint8_t  *a, uint8_t  *b, uint8_t  *d, int n, uint64_t sum[4][3]);
+    void (*b16_diff4)     (uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[4][3]);
+    
+    /**
+     *  sums of @n 4x4 blocks side by side, rows @sa/@sb bytes apart:
+     *  s[i] = {sum a, sum b, sum a*a + b*b, sum a*b} of block i
+     */
+    void (*b8_ssim_4x4)   (uint8_t  *a, int sa, uint8_t  *b, int sb, int n, uint64_t (*s)[4]);
+    void (*b16_ssim_4x4)  (uint16_t *a, int sa, uint16_t *b, int sb, int n, uint64_t (*s)[4]);
+    
+} yuv_kern_t;
+
+extern yuv_kern_t yuv_kern;
+
+int  cpu_detect   (void);
+int  yuv_cpu_level(const char *name);
+int  yuv_kern_init(int level);
+
+/**
+ *  ISA files, each overrides the entries it implements
+ */
+void yuv_kern_set_sse2(yuv_kern_t *k);
+void yuv_kern_set_ssse3(yuv_kern_t *k);
+void yuv_kern_set_avx2(yuv_kern_t *k);
+
+
+#endif  // __YUVKERN_H__
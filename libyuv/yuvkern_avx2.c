@@ -0,0 +1,1065 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvkern_avx2.c
+ *  @brief AVX2 row kernels, registered by yuv_kern_init() for CPU_AVX2 and
+ *      up. In-lane shuffles group the samples, a cross-lane permute puts
+ *      them in order.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <immintrin.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+/**
+ *  per 128-bit lane: even bytes (or words) to the low half, odd ones to
+ *  the high half
+ */
+#define B8_EO_SHUF  0, 2, 4, 6, 8,10,12,14,  1, 3, 5, 7, 9,11,13,15
+#define B16_EO_SHUF 0, 1, 4, 5, 8, 9,12,13,  2, 3, 6, 7,10,11,14,15
+
+/**
+ *  @a, @b hold 2*N interleaved samples; the even ones go to @u, the odd
+ *  ones to @v, both in order
+ */
+static inline void eo_split(__m256i a, __m256i b, __m256i shuf, 
+                            __m256i *u, __m256i *v)
+{
+    a = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(a, shuf), _MM_SHUFFLE(3,1,2,0));
+    b = _mm256_permute4x64_epi64(_mm256_shuffle_epi8(b, shuf), _MM_SHUFFLE(3,1,2,0));
+    *u = _mm256_permute2x128_si256(a, b, 0x20);
+    *v = _mm256_permute2x128_si256(a, b, 0x31);
+}
+
+/**
+ *  @a, @b in order -> interleaved @lo (first half) and @hi
+ */
+static inline void b8_interleave(__m256i a, __m256i b, __m256i *lo, __m256i *hi)
+{
+    __m256i l = _mm256_unpacklo_epi8(a, b);
+    __m256i h = _mm256_unpackhi_epi8(a, b);
+    *lo = _mm256_permute2x128_si256(l, h, 0x20);
+    *hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+
+static inline void b16_interleave(__m256i a, __m256i b, __m256i *lo, __m256i *hi)
+{
+    __m256i l = _mm256_unpacklo_epi16(a, b);
+    __m256i h = _mm256_unpackhi_epi16(a, b);
+    *lo = _mm256_permute2x128_si256(l, h, 0x20);
+    *hi = _mm256_permute2x128_si256(l, h, 0x31);
+}
+
+static void b8_uv_split_avx2(uint8_t *u, uint8_t *v, uint8_t *uv, int n)
+{
+    const __m256i shuf = _mm256_setr_epi8(B8_EO_SHUF, B8_EO_SHUF);
+    __m256i a, b;
+    int x;
+    
+    for (x=0; x+32<=n; x+=32) {
+        eo_split(_mm256_loadu_si256((__m256i*)(uv + 2*x     )),
+                 _mm256_loadu_si256((__m256i*)(uv + 2*x + 32)), shuf, &a, &b);
+        _mm256_storeu_si256((__m256i*)(u + x), a);
+        _mm256_storeu_si256((__m256i*)(v + x), b);
+    }
+    for (; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b8_uv_merge_avx2(uint8_t *uv, uint8_t *u, uint8_t *v, int n)
+{
+    __m256i lo, hi;
+    int x;
+    
+    for (x=0; x+32<=n; x+=32) {
+        b8_interleave(_mm256_loadu_si256((__m256i*)(u + x)),
+                      _mm256_loadu_si256((__m256i*)(v + x)), &lo, &hi);
+        _mm256_storeu_si256((__m256i*)(uv + 2*x     ), lo);
+        _mm256_storeu_si256((__m256i*)(uv + 2*x + 32), hi);
+    }
+    for (; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+static void b16_uv_split_avx2(uint16_t *u, uint16_t *v, uint16_t *uv, int n)
+{
+    const __m256i shuf = _mm256_setr_epi8(B16_EO_SHUF, B16_EO_SHUF);
+    __m256i a, b;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16) {
+        eo_split(_mm256_loadu_si256((__m256i*)(uv + 2*x     )),
+                 _mm256_loadu_si256((__m256i*)(uv + 2*x + 16)), shuf, &a, &b);
+        _mm256_storeu_si256((__m256i*)(u + x), a);
+        _mm256_storeu_si256((__m256i*)(v + x), b);
+    }
+    for (; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b16_uv_merge_avx2(uint16_t *uv, uint16_t *u, uint16_t *v, int n)
+{
+    __m256i lo, hi;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16) {
+        b16_interleave(_mm256_loadu_si256((__m256i*)(u + x)),
+                       _mm256_loadu_si256((__m256i*)(v + x)), &lo, &hi);
+        _mm256_storeu_si256((__m256i*)(uv + 2*x     ), lo);
+        _mm256_storeu_si256((__m256i*)(uv + 2*x + 16), hi);
+    }
+    for (; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+/**
+ *  yuyv/uyvy rows are split twice: even/odd samples give luma and
+ *  interleaved chroma, which splits again into u and v
+ */
+static void b8_yuyv_split_avx2(uint8_t *y, uint8_t *u, uint8_t *v, uint8_t *p, 
+                               int n, int yo)
+{
+    const __m256i shuf = _mm256_setr_epi8(B8_EO_SHUF, B8_EO_SHUF);
+    __m256i e0, o0, e1, o1, cu, cv;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+32<=n; x+=32, p+=128) {
+        eo_split(_mm256_loadu_si256((__m256i*)(p     )),
+                 _mm256_loadu_si256((__m256i*)(p + 32)), shuf, &e0, &o0);
+        eo_split(_mm256_loadu_si256((__m256i*)(p + 64)),
+                 _mm256_loadu_si256((__m256i*)(p + 96)), shuf, &e1, &o1);
+        if (yo) {
+            _mm256_storeu_si256((__m256i*)(y + 2*x     ), o0);
+            _mm256_storeu_si256((__m256i*)(y + 2*x + 32), o1);
+            eo_split(e0, e1, shuf, &cu, &cv);
+        } else {
+            _mm256_storeu_si256((__m256i*)(y + 2*x     ), e0);
+            _mm256_storeu_si256((__m256i*)(y + 2*x + 32), e1);
+            eo_split(o0, o1, shuf, &cu, &cv);
+        }
+        _mm256_storeu_si256((__m256i*)(u + x), cu);
+        _mm256_storeu_si256((__m256i*)(v + x), cv);
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b8_yuyv_split_sp_avx2(uint8_t *y, uint8_t *uv, uint8_t *p, int n, int yo)
+{
+    const __m256i shuf = _mm256_setr_epi8(B8_EO_SHUF, B8_EO_SHUF);
+    __m256i e0, o0;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16, p+=64) {
+        eo_split(_mm256_loadu_si256((__m256i*)(p     )),
+                 _mm256_loadu_si256((__m256i*)(p + 32)), shuf, &e0, &o0);
+        _mm256_storeu_si256((__m256i*)(y + 2*x), yo ? o0 : e0);
+        if (uv) {
+            _mm256_storeu_si256((__m256i*)(uv + 2*x), yo ? e0 : o0);
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b8_yuyv_merge_avx2(uint8_t *p, uint8_t *y, uint8_t *u, uint8_t *v, 
+                               int n, int yo)
+{
+    __m256i c0, c1, r0, r1;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+32<=n; x+=32, p+=128) {
+        __m256i y0 = _mm256_loadu_si256((__m256i*)(y + 2*x     ));
+        __m256i y1 = _mm256_loadu_si256((__m256i*)(y + 2*x + 32));
+        b8_interleave(_mm256_loadu_si256((__m256i*)(u + x)),
+                      _mm256_loadu_si256((__m256i*)(v + x)), &c0, &c1);
+        if (yo) {
+            b8_interleave(c0, y0, &r0, &r1);
+        } else {
+            b8_interleave(y0, c0, &r0, &r1);
+        }
+        _mm256_storeu_si256((__m256i*)(p     ), r0);
+        _mm256_storeu_si256((__m256i*)(p + 32), r1);
+        if (yo) {
+            b8_interleave(c1, y1, &r0, &r1);
+        } else {
+            b8_interleave(y1, c1, &r0, &r1);
+        }
+        _mm256_storeu_si256((__m256i*)(p + 64), r0);
+        _mm256_storeu_si256((__m256i*)(p + 96), r1);
+    }
+    for (; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+static void b16_yuyv_split_avx2(uint16_t *y, uint16_t *u, uint16_t *v, uint16_t *p, 
+                                int n, int yo)
+{
+    const __m256i shuf = _mm256_setr_epi8(B16_EO_SHUF, B16_EO_SHUF);
+    __m256i e0, o0, e1, o1, cu, cv;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16, p+=64) {
+        eo_split(_mm256_loadu_si256((__m256i*)(p     )),
+                 _mm256_loadu_si256((__m256i*)(p + 16)), shuf, &e0, &o0);
+        eo_split(_mm256_loadu_si256((__m256i*)(p + 32)),
+                 _mm256_loadu_si256((__m256i*)(p + 48)), shuf, &e1, &o1);
+        if (yo) {
+            _mm256_storeu_si256((__m256i*)(y + 2*x     ), o0);
+            _mm256_storeu_si256((__m256i*)(y + 2*x + 16), o1);
+            eo_split(e0, e1, shuf, &cu, &cv);
+        } else {
+            _mm256_storeu_si256((__m256i*)(y + 2*x     ), e0);
+            _mm256_storeu_si256((__m256i*)(y + 2*x + 16), e1);
+            eo_split(o0, o1, shuf, &cu, &cv);
+        }
+        _mm256_storeu_si256((__m256i*)(u + x), cu);
+        _mm256_storeu_si256((__m256i*)(v + x), cv);
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b16_yuyv_split_sp_avx2(uint16_t *y, uint16_t *uv, uint16_t *p, int n, int yo)
+{
+    const __m256i shuf = _mm256_setr_epi8(B16_EO_SHUF, B16_EO_SHUF);
+    __m256i e0, o0;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+8<=n; x+=8, p+=32) {
+        eo_split(_mm256_loadu_si256((__m256i*)(p     )),
+                 _mm256_loadu_si256((__m256i*)(p + 16)), shuf, &e0, &o0);
+        _mm256_storeu_si256((__m256i*)(y + 2*x), yo ? o0 : e0);
+        if (uv) {
+            _mm256_storeu_si256((__m256i*)(uv + 2*x), yo ? e0 : o0);
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b16_yuyv_merge_avx2(uint16_t *p, uint16_t *y, uint16_t *u, uint16_t *v, 
+                                int n, int yo)
+{
+    __m256i c0, c1, r0, r1;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16, p+=64) {
+        __m256i y0 = _mm256_loadu_si256((__m256i*)(y + 2*x     ));
+        __m256i y1 = _mm256_loadu_si256((__m256i*)(y + 2*x + 16));
+        b16_interleave(_mm256_loadu_si256((__m256i*)(u + x)),
+                       _mm256_loadu_si256((__m256i*)(v + x)), &c0, &c1);
+        if (yo) {
+            b16_interleave(c0, y0, &r0, &r1);
+        } else {
+            b16_interleave(y0, c0, &r0, &r1);
+        }
+        _mm256_storeu_si256((__m256i*)(p     ), r0);
+        _mm256_storeu_si256((__m256i*)(p + 16), r1);
+        if (yo) {
+            b16_interleave(c1, y1, &r0, &r1);
+        } else {
+            b16_interleave(y1, c1, &r0, &r1);
+        }
+        _mm256_storeu_si256((__m256i*)(p + 32), r0);
+        _mm256_storeu_si256((__m256i*)(p + 48), r1);
+    }
+    for (; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+/**
+ *  10-bit lte stream, see yuvkern_ssse3.c. Each 128-bit lane takes 10
+ *  bytes <-> 8 samples; a step is 32 samples, 40 bytes.
+ */
+#define B10_UNPACK_SHUF 0, 1, 1, 2, 2, 3, 3, 4,  5, 6, 6, 7, 7, 8, 8, 9
+#define B10_UNPACK_MUL  64, 16, 4, 1, 64, 16, 4, 1
+#define B10_PACK_SHUF   0, 1, 2, 3, 4, 8, 9,10,11,12, -1,-1,-1,-1,-1,-1
+
+static inline __m256i b10_unpack16(uint8_t *p)
+{
+    const __m256i shuf = _mm256_setr_epi8(B10_UNPACK_SHUF, B10_UNPACK_SHUF);
+    const __m256i mul  = _mm256_setr_epi16(B10_UNPACK_MUL, B10_UNPACK_MUL);
+    __m256i a = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)p)), 
+                    _mm_loadu_si128((__m128i*)(p + 10)), 1);
+    a = _mm256_shuffle_epi8(a, shuf);
+    return _mm256_srli_epi16(_mm256_mullo_epi16(a, mul), 6);
+}
+
+/**
+ *  16 samples -> 20 bytes at @p
+ */
+static inline void b10_pack16(uint8_t *p, __m256i a)
+{
+    const __m256i mask = _mm256_set1_epi16(0x3ff);
+    const __m256i madd = _mm256_set1_epi32(1 | (1<<26));
+    const __m256i lo32 = _mm256_set1_epi64x(0xffffffff);
+    const __m256i shuf = _mm256_setr_epi8(B10_PACK_SHUF, B10_PACK_SHUF);
+    __m128i l, h;
+    uint32_t tail;
+    
+    a = _mm256_madd_epi16(_mm256_and_si256(a, mask), madd);
+    a = _mm256_or_si256(_mm256_and_si256(a, lo32), 
+                        _mm256_slli_epi64(_mm256_srli_epi64(a, 32), 20));
+    a = _mm256_shuffle_epi8(a, shuf);
+    l = _mm256_castsi256_si128(a);
+    h = _mm256_extracti128_si256(a, 1);
+    _mm_storeu_si128((__m128i*)p, _mm_or_si128(l, _mm_slli_si128(h, 10)));
+    tail = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(h, 6));
+    memcpy(p + 16, &tail, 4);
+}
+
+/**
+ *  12-bit lte stream: each lane takes 12 bytes <-> 8 samples; a step is
+ *  32 samples, 48 bytes
+ */
+#define B12_UNPACK_SHUF 0, 1, 1, 2, 3, 4, 4, 5,  6, 7, 7, 8, 9,10,10,11
+#define B12_UNPACK_MUL  16, 1, 16, 1, 16, 1, 16, 1
+#define B12_PACK_SHUF   0, 1, 2, 4, 5, 6, 8, 9,10,12,13,14, -1,-1,-1,-1
+
+static inline __m256i b12_unpack16(uint8_t *p)
+{
+    const __m256i shuf = _mm256_setr_epi8(B12_UNPACK_SHUF, B12_UNPACK_SHUF);
+    const __m256i mul  = _mm256_setr_epi16(B12_UNPACK_MUL, B12_UNPACK_MUL);
+    __m256i a = _mm256_inserti128_si256(
+                    _mm256_castsi128_si256(_mm_loadu_si128((__m128i*)p)), 
+                    _mm_loadu_si128((__m128i*)(p + 12)), 1);
+    a = _mm256_shuffle_epi8(a, shuf);
+    return _mm256_srli_epi16(_mm256_mullo_epi16(a, mul), 4);
+}
+
+/**
+ *  16 samples -> 24 bytes at @p
+ */
+static inline void b12_pack16(uint8_t *p, __m256i a)
+{
+    const __m256i mask = _mm256_set1_epi16(0xfff);
+    const __m256i madd = _mm256_set1_epi32(1 | (1<<28));
+    const __m256i shuf = _mm256_setr_epi8(B12_PACK_SHUF, B12_PACK_SHUF);
+    __m128i l, h;
+    
+    a = _mm256_madd_epi16(_mm256_and_si256(a, mask), madd);
+    a = _mm256_shuffle_epi8(a, shuf);
+    l = _mm256_castsi256_si128(a);
+    h = _mm256_extracti128_si256(a, 1);
+    _mm_storeu_si128((__m128i*)p, _mm_or_si128(l, _mm_slli_si128(h, 12)));
+    _mm_storel_epi64((__m128i*)(p + 16), _mm_srli_si128(h, 4));
+}
+
+static void bn_unpack_avx2(void *bn, int n_byte, void *b16, int n16, int nbit)
+{
+    uint8_t  *pn  = (uint8_t  *)bn;
+    uint16_t *p16 = (uint16_t *)b16;
+    int x = 0, off = 0;
+    
+    /**
+     *  the last load reads 16 bytes from @off+30 (@off+36)
+     */
+    if (nbit == 10) {
+        for (; x+32<=n16 && off+46<=n_byte; x+=32, off+=40) {
+            _mm256_storeu_si256((__m256i*)(p16 + x     ), b10_unpack16(pn + off     ));
+            _mm256_storeu_si256((__m256i*)(p16 + x + 16), b10_unpack16(pn + off + 20));
+        }
+    } else if (nbit == 12) {
+        for (; x+32<=n16 && off+52<=n_byte; x+=32, off+=48) {
+            _mm256_storeu_si256((__m256i*)(p16 + x     ), b12_unpack16(pn + off     ));
+            _mm256_storeu_si256((__m256i*)(p16 + x + 16), b12_unpack16(pn + off + 24));
+        }
+    }
+    bn_linear_unpack_lte(pn + off, n_byte - off, p16 + x, n16 - x, nbit);
+}
+
+static void bn_pack_avx2(void *bn, int n_byte, void *b16, int n16, int nbit)
+{
+    uint8_t  *pn  = (uint8_t  *)bn;
+    uint16_t *p16 = (uint16_t *)b16;
+    int x = 0, off = 0;
+    
+    if (nbit == 10) {
+        for (; x+32<=n16 && off+40<=n_byte; x+=32, off+=40) {
+            b10_pack16(pn + off,      _mm256_loadu_si256((__m256i*)(p16 + x     )));
+            b10_pack16(pn + off + 20, _mm256_loadu_si256((__m256i*)(p16 + x + 16)));
+        }
+    } else if (nbit == 12) {
+        for (; x+32<=n16 && off+48<=n_byte; x+=32, off+=48) {
+            b12_pack16(pn + off,      _mm256_loadu_si256((__m256i*)(p16 + x     )));
+            b12_pack16(pn + off + 24, _mm256_loadu_si256((__m256i*)(p16 + x + 16)));
+        }
+    }
+    bn_linear_pack_lte(pn + off, n_byte - off, p16 + x, n16 - x, nbit);
+}
+
+/*****************************************************************************
+ *                          bit depth
+ ****************************************************************************/
+static inline __m256i bias_x4(const uint16_t bias[4])
+{
+    return _mm256_set1_epi64x((int64_t)bias[3] << 48 | (int64_t)bias[2] << 32 | 
+                              (int64_t)bias[1] << 16 | (int64_t)bias[0]);
+}
+
+static void b16_to_b8_avx2(uint8_t *dst, uint16_t *src, int n, int lshift,
+                           const uint16_t bias[4])
+{
+    const __m256i bs = bias_x4(bias);
+    const __m128i cl = _mm_cvtsi32_si128(lshift);
+    int x, v;
+    
+    for (x=0; x+32<=n; x+=32) {
+        __m256i a = _mm256_loadu_si256((__m256i*)(src + x     ));
+        __m256i b = _mm256_loadu_si256((__m256i*)(src + x + 16));
+        a = _mm256_srli_epi16(_mm256_adds_epu16(_mm256_sll_epi16(a, cl), bs), 8);
+        b = _mm256_srli_epi16(_mm256_adds_epu16(_mm256_sll_epi16(b, cl), bs), 8);
+        a = _mm256_permute4x64_epi64(_mm256_packus_epi16(a, b), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256((__m256i*)(dst + x), a);
+    }
+    for (; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint8_t)(MIN(v, 0xffff) >> 8);
+    }
+}
+
+static void b8_to_b16_avx2(uint16_t *dst, uint8_t *src, int n, int lshift)
+{
+    const __m128i cl = _mm_cvtsi32_si128(lshift);
+    int x;
+    
+    for (x=0; x+32<=n; x+=32) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x     ));
+        __m128i b = _mm_loadu_si128((__m128i*)(src + x + 16));
+        _mm256_storeu_si256((__m256i*)(dst + x     ), _mm256_sll_epi16(_mm256_cvtepu8_epi16(a), cl));
+        _mm256_storeu_si256((__m256i*)(dst + x + 16), _mm256_sll_epi16(_mm256_cvtepu8_epi16(b), cl));
+    }
+    for (; x<n; ++x) {
+        dst[x] = (uint16_t)(src[x] << lshift);
+    }
+}
+
+static void b16_shift_avx2(uint16_t *dst, uint16_t *src, int n, int lshift, int rshift,
+                           const uint16_t bias[4])
+{
+    const __m256i bs = bias_x4(bias);
+    const __m128i cl = _mm_cvtsi32_si128(lshift);
+    const __m128i cr = _mm_cvtsi32_si128(rshift);
+    int x, v;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m256i a = _mm256_loadu_si256((__m256i*)(src + x));
+        a = _mm256_srl_epi16(_mm256_adds_epu16(_mm256_sll_epi16(a, cl), bs), cr);
+        _mm256_storeu_si256((__m256i*)(dst + x), a);
+    }
+    for (; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint16_t)(MIN(v, 0xffff) >> rshift);
+    }
+}
+
+/*****************************************************************************
+ *                          vertical filter
+ ****************************************************************************/
+static void b8_vfilt_avx2(uint8_t *dst, uint8_t *r[4], const int16_t c[4], int n)
+{
+    const __m256i rnd = _mm256_set1_epi16(32);
+    __m256i cx[4], lo, hi;
+    int x, k, v;
+    
+    for (k=0; k<4; ++k) {
+        cx[k] = _mm256_set1_epi16(c[k]);
+    }
+    for (x=0; x+32<=n; x+=32) {
+        lo = hi = rnd;
+        for (k=0; k<4; ++k) {
+            __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r[k] + x     )));
+            __m256i b = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r[k] + x + 16)));
+            lo = _mm256_add_epi16(lo, _mm256_mullo_epi16(a, cx[k]));
+            hi = _mm256_add_epi16(hi, _mm256_mullo_epi16(b, cx[k]));
+        }
+        lo = _mm256_srai_epi16(lo, 6);
+        hi = _mm256_srai_epi16(hi, 6);
+        lo = _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256((__m256i*)(dst + x), lo);
+    }
+    for (; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+/**
+ *  as b16_vfilt_sse2(): signed samples, pmaddwd on tap pairs. Unpack and
+ *  packs both stay in lane, so the order comes back without a permute.
+ */
+static void b16_vfilt_avx2(uint16_t *dst, uint16_t *r[4], const int16_t c[4], int n, int max)
+{
+    const __m256i sgn = _mm256_set1_epi16((short)0x8000);
+    const __m256i rnd = _mm256_set1_epi32(32);
+    const __m256i top = _mm256_set1_epi16((short)(max - 32768));
+    const __m256i c01 = _mm256_set1_epi32((int)((uint32_t)(uint16_t)c[1] << 16 | (uint16_t)c[0]));
+    const __m256i c23 = _mm256_set1_epi32((int)((uint32_t)(uint16_t)c[3] << 16 | (uint16_t)c[2]));
+    int x, v;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m256i a = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[0] + x)), sgn);
+        __m256i b = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[1] + x)), sgn);
+        __m256i d = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[2] + x)), sgn);
+        __m256i e = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[3] + x)), sgn);
+        __m256i lo = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), c01),
+                                      _mm256_madd_epi16(_mm256_unpacklo_epi16(d, e), c23));
+        __m256i hi = _mm256_add_epi32(_mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), c01),
+                                      _mm256_madd_epi16(_mm256_unpackhi_epi16(d, e), c23));
+        lo = _mm256_srai_epi32(_mm256_add_epi32(lo, rnd), 6);
+        hi = _mm256_srai_epi32(_mm256_add_epi32(hi, rnd), 6);
+        a  = _mm256_min_epi16(_mm256_packs_epi32(lo, hi), top);
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(a, sgn));
+    }
+    for (; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint16_t)MIN(v, max);
+    }
+}
+
+/*****************************************************************************
+ *                          polyphase scaling
+ ****************************************************************************/
+static inline __m256i scale_tap_pair(const int16_t *c, int k, int nt)
+{
+    uint16_t c1 = (k + 1 < nt) ? (uint16_t)c[k+1] : 0;
+    return _mm256_set1_epi32((int)((uint32_t)c1 << 16 | (uint16_t)c[k]));
+}
+
+/**
+ *  the horizontal pass stays with SSE2: its loads gather a few taps per
+ *  output, which a wider register does not speed up
+ */
+static void b8_vscale_avx2(uint8_t *dst, uint8_t **r, const int16_t *c, int nt, int n)
+{
+    const __m256i rnd = _mm256_set1_epi32(1 << 13);
+    int x, k, v;
+    
+    for (x=0; x+32<=n; x+=32) {
+        __m256i s0 = rnd, s1 = rnd, s2 = rnd, s3 = rnd;
+        for (k=0; k<nt; k+=2) {
+            __m256i cc = scale_tap_pair(c, k, nt);
+            uint8_t *r0 = r[k] + x;
+            uint8_t *r1 = r[MIN(k+1, nt-1)] + x;
+            __m256i a  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r0     )));
+            __m256i b  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r1     )));
+            __m256i d  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r0 + 16)));
+            __m256i e  = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(r1 + 16)));
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), cc));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), cc));
+            s2 = _mm256_add_epi32(s2, _mm256_madd_epi16(_mm256_unpacklo_epi16(d, e), cc));
+            s3 = _mm256_add_epi32(s3, _mm256_madd_epi16(_mm256_unpackhi_epi16(d, e), cc));
+        }
+        s0 = _mm256_packs_epi32(_mm256_srai_epi32(s0, 14), _mm256_srai_epi32(s1, 14));
+        s2 = _mm256_packs_epi32(_mm256_srai_epi32(s2, 14), _mm256_srai_epi32(s3, 14));
+        s0 = _mm256_permute4x64_epi64(_mm256_packus_epi16(s0, s2), _MM_SHUFFLE(3,1,2,0));
+        _mm256_storeu_si256((__m256i*)(dst + x), s0);
+    }
+    for (; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * r[k][x];
+        }
+        v = v<0 ? 0 : v>>14;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+static void b16_vscale_avx2(uint16_t *dst, uint16_t **r, const int16_t *c, int nt, int n, int max)
+{
+    const __m256i sgn = _mm256_set1_epi16((short)0x8000);
+    const __m256i rnd = _mm256_set1_epi32(1 << 13);
+    const __m256i top = _mm256_set1_epi16((short)(max - 32768));
+    int x, k, v;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m256i s0 = rnd, s1 = rnd;
+        for (k=0; k<nt; k+=2) {
+            __m256i cc = scale_tap_pair(c, k, nt);
+            __m256i a  = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[k] + x)), sgn);
+            __m256i b  = _mm256_xor_si256(_mm256_loadu_si256((__m256i*)(r[MIN(k+1, nt-1)] + x)), sgn);
+            s0 = _mm256_add_epi32(s0, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), cc));
+            s1 = _mm256_add_epi32(s1, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), cc));
+        }
+        s0 = _mm256_packs_epi32(_mm256_srai_epi32(s0, 14), _mm256_srai_epi32(s1, 14));
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_xor_si256(_mm256_min_epi16(s0, top), sgn));
+    }
+    for (; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * (r[k][x] - 32768);
+        }
+        v = (v >> 14) + 32768;
+        dst[x] = (uint16_t)(v<0 ? 0 : MIN(v, max));
+    }
+}
+
+/**
+ *  in-lane pshufb mask of yuv_kern_t.b8_shuf4/b16_shuf4, groups never 
+ *  cross a lane
+ */
+static inline __m256i shuf4_mask(const uint8_t perm[4], int nbyte)
+{
+    uint8_t m[16];
+    int j, s;
+    for (j=0; j<16; ++j) {
+        s    = j / nbyte;
+        m[j] = (uint8_t)(((s & ~3) + perm[s & 3]) * nbyte + j % nbyte);
+    }
+    return _mm256_broadcastsi128_si256(_mm_loadu_si128((__m128i*)m));
+}
+
+static void b8_shuf4_avx2(uint8_t *dst, uint8_t *src, int n, const uint8_t perm[4])
+{
+    __m256i shuf = shuf4_mask(perm, 1);
+    int x = 0;
+    
+    for (; x+32<=n; x+=32) {
+        __m256i a = _mm256_loadu_si256((__m256i*)(src + x));
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_shuffle_epi8(a, shuf));
+    }
+    for (; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+static void b16_shuf4_avx2(uint16_t *dst, uint16_t *src, int n, const uint8_t perm[4])
+{
+    __m256i shuf = shuf4_mask(perm, 2);
+    int x = 0;
+    
+    for (; x+16<=n; x+=16) {
+        __m256i a = _mm256_loadu_si256((__m256i*)(src + x));
+        _mm256_storeu_si256((__m256i*)(dst + x), _mm256_shuffle_epi8(a, shuf));
+    }
+    for (; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+/*****************************************************************************
+ *                          sad / ssd
+ ****************************************************************************/
+
+#define DIFF_SPAN   4096    //!< vectors of 32-bit square sums, as in SSE2
+
+static inline uint64_t sum_epi64(__m256i a)
+{
+    uint64_t q[4];
+    _mm256_storeu_si256((__m256i*)q, a);
+    return q[0] + q[1] + q[2] + q[3];
+}
+
+static inline uint64_t max_epu8(__m256i a)
+{
+    uint8_t q[32];
+    int k, m = 0;
+    _mm256_storeu_si256((__m256i*)q, a);
+    for (k=0; k<32; ++k) {
+        m = MAX(m, q[k]);
+    }
+    return m;
+}
+
+static inline uint64_t max_epu16(__m256i a)
+{
+    uint16_t q[16];
+    int k, m = 0;
+    _mm256_storeu_si256((__m256i*)q, a);
+    for (k=0; k<16; ++k) {
+        m = MAX(m, q[k]);
+    }
+    return m;
+}
+
+static void b8_diff_avx2(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[3])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sad = zero, ssd = zero, mx = zero;
+    int x = 0, end, e;
+    
+    while (x+32<=n) {
+        __m256i sq = zero;
+        end = MIN(n, x + 32*DIFF_SPAN);
+        for (; x+32<=end; x+=32) {
+            __m256i va = _mm256_loadu_si256((__m256i*)(a + x));
+            __m256i vb = _mm256_loadu_si256((__m256i*)(b + x));
+            __m256i ve = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+            __m256i lo = _mm256_unpacklo_epi8(ve, zero);
+            __m256i hi = _mm256_unpackhi_epi8(ve, zero);
+            if (d) {
+                _mm256_storeu_si256((__m256i*)(d + x), ve);
+            }
+            mx  = _mm256_max_epu8(mx, ve);
+            sad = _mm256_add_epi64(sad, _mm256_sad_epu8(ve, zero));
+            sq  = _mm256_add_epi32(sq, _mm256_add_epi32(_mm256_madd_epi16(lo, lo), 
+                                                        _mm256_madd_epi16(hi, hi)));
+        }
+        ssd = _mm256_add_epi64(ssd, _mm256_unpacklo_epi32(sq, zero));
+        ssd = _mm256_add_epi64(ssd, _mm256_unpackhi_epi32(sq, zero));
+    }
+    sum[0] += sum_epi64(sad);
+    sum[1] += sum_epi64(ssd);
+    sum[2]  = MAX(sum[2], max_epu8(mx));
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint8_t)e;
+        }
+        sum[0] += e;
+        sum[1] += e*e;
+        sum[2]  = MAX(sum[2], (uint64_t)e);
+    }
+}
+
+static void b16_diff_avx2(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[3])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sad = zero, ssd = zero, mx = zero;
+    int x = 0, end, e;
+    
+    while (x+16<=n) {
+        __m256i ab = zero;
+        end = MIN(n, x + 16*DIFF_SPAN);
+        for (; x+16<=end; x+=16) {
+            __m256i va = _mm256_loadu_si256((__m256i*)(a + x));
+            __m256i vb = _mm256_loadu_si256((__m256i*)(b + x));
+            __m256i ve = _mm256_or_si256(_mm256_subs_epu16(va, vb), _mm256_subs_epu16(vb, va));
+            __m256i lo = _mm256_unpacklo_epi16(ve, zero);
+            __m256i hi = _mm256_unpackhi_epi16(ve, zero);
+            if (d) {
+                _mm256_storeu_si256((__m256i*)(d + x), ve);
+            }
+            mx  = _mm256_max_epu16(mx, ve);
+            ab  = _mm256_add_epi32(ab, _mm256_add_epi32(lo, hi));
+            ssd = _mm256_add_epi64(ssd, _mm256_mul_epu32(lo, lo));
+            ssd = _mm256_add_epi64(ssd, _mm256_mul_epu32(hi, hi));
+            lo  = _mm256_srli_epi64(lo, 32);
+            hi  = _mm256_srli_epi64(hi, 32);
+            ssd = _mm256_add_epi64(ssd, _mm256_mul_epu32(lo, lo));
+            ssd = _mm256_add_epi64(ssd, _mm256_mul_epu32(hi, hi));
+        }
+        sad = _mm256_add_epi64(sad, _mm256_unpacklo_epi32(ab, zero));
+        sad = _mm256_add_epi64(sad, _mm256_unpackhi_epi32(ab, zero));
+    }
+    sum[0] += sum_epi64(sad);
+    sum[1] += sum_epi64(ssd);
+    sum[2]  = MAX(sum[2], max_epu16(mx));
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint16_t)e;
+        }
+        sum[0] += e;
+        sum[1] += (uint64_t)e*e;
+        sum[2]  = MAX(sum[2], (uint64_t)e);
+    }
+}
+
+/**
+ *  as in SSE2: positions 0/2 in the even bytes, 1/3 in the odd ones
+ */
+static void b8_diff4_avx2(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[4][3])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i m8   = _mm256_set1_epi16(0x00ff);
+    const __m256i m16  = _mm256_set1_epi32(0xffff);
+    __m256i sad[4], ssd[4], mx[2] = {zero, zero};
+    uint16_t q[16];
+    int x = 0, end, e, k;
+    
+    for (k=0; k<4; ++k) {
+        sad[k] = ssd[k] = zero;
+    }
+    while (x+32<=n) {
+        __m256i ab[4] = {zero, zero, zero, zero};
+        __m256i sq[4] = {zero, zero, zero, zero};
+        end = MIN(n, x + 32*DIFF_SPAN);
+        for (; x+32<=end; x+=32) {
+            __m256i va  = _mm256_loadu_si256((__m256i*)(a + x));
+            __m256i vb  = _mm256_loadu_si256((__m256i*)(b + x));
+            __m256i ve  = _mm256_or_si256(_mm256_subs_epu8(va, vb), _mm256_subs_epu8(vb, va));
+            __m256i e02 = _mm256_and_si256(ve, m8);
+            __m256i e13 = _mm256_srli_epi16(ve, 8);
+            __m256i q02 = _mm256_mullo_epi16(e02, e02);
+            __m256i q13 = _mm256_mullo_epi16(e13, e13);
+            if (d) {
+                _mm256_storeu_si256((__m256i*)(d + x), ve);
+            }
+            mx[0] = _mm256_max_epi16(mx[0], e02);
+            mx[1] = _mm256_max_epi16(mx[1], e13);
+            ab[0] = _mm256_add_epi32(ab[0], _mm256_and_si256(e02, m16));
+            ab[1] = _mm256_add_epi32(ab[1], _mm256_and_si256(e13, m16));
+            ab[2] = _mm256_add_epi32(ab[2], _mm256_srli_epi32(e02, 16));
+            ab[3] = _mm256_add_epi32(ab[3], _mm256_srli_epi32(e13, 16));
+            sq[0] = _mm256_add_epi32(sq[0], _mm256_and_si256(q02, m16));
+            sq[1] = _mm256_add_epi32(sq[1], _mm256_and_si256(q13, m16));
+            sq[2] = _mm256_add_epi32(sq[2], _mm256_srli_epi32(q02, 16));
+            sq[3] = _mm256_add_epi32(sq[3], _mm256_srli_epi32(q13, 16));
+        }
+        for (k=0; k<4; ++k) {
+            sad[k] = _mm256_add_epi64(sad[k], _mm256_unpacklo_epi32(ab[k], zero));
+            sad[k] = _mm256_add_epi64(sad[k], _mm256_unpackhi_epi32(ab[k], zero));
+            ssd[k] = _mm256_add_epi64(ssd[k], _mm256_unpacklo_epi32(sq[k], zero));
+            ssd[k] = _mm256_add_epi64(ssd[k], _mm256_unpackhi_epi32(sq[k], zero));
+        }
+    }
+    for (k=0; k<4; ++k) {
+        sum[k][0] += sum_epi64(sad[k]);
+        sum[k][1] += sum_epi64(ssd[k]);
+    }
+    for (k=0; k<2; ++k) {
+        int j;
+        _mm256_storeu_si256((__m256i*)q, mx[k]);
+        for (j=0; j<16; ++j) {
+            sum[k + 2*(j & 1)][2] = MAX(sum[k + 2*(j & 1)][2], q[j]);
+        }
+    }
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint8_t)e;
+        }
+        sum[x & 3][0] += e;
+        sum[x & 3][1] += e*e;
+        sum[x & 3][2]  = MAX(sum[x & 3][2], (uint64_t)e);
+    }
+}
+
+/**
+ *  as in SSE2; the in-lane unpacks keep dword k of a lane at position k
+ */
+static void b16_diff4_avx2(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[4][3])
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i sad01 = zero, sad23 = zero, ssd02 = zero, ssd13 = zero, mx = zero;
+    uint64_t q64[4];
+    uint16_t q[16];
+    int x = 0, end, e, j;
+    
+    while (x+16<=n) {
+        __m256i ab = zero;
+        end = MIN(n, x + 16*DIFF_SPAN);
+        for (; x+16<=end; x+=16) {
+            __m256i va = _mm256_loadu_si256((__m256i*)(a + x));
+            __m256i vb = _mm256_loadu_si256((__m256i*)(b + x));
+            __m256i ve = _mm256_or_si256(_mm256_subs_epu16(va, vb), _mm256_subs_epu16(vb, va));
+            __m256i lo = _mm256_unpacklo_epi16(ve, zero);
+            __m256i hi = _mm256_unpackhi_epi16(ve, zero);
+            if (d) {
+                _mm256_storeu_si256((__m256i*)(d + x), ve);
+            }
+            mx    = _mm256_max_epu16(mx, ve);
+            ab    = _mm256_add_epi32(ab, _mm256_add_epi32(lo, hi));
+            ssd02 = _mm256_add_epi64(ssd02, _mm256_mul_epu32(lo, lo));
+            ssd02 = _mm256_add_epi64(ssd02, _mm256_mul_epu32(hi, hi));
+            lo    = _mm256_srli_epi64(lo, 32);
+            hi    = _mm256_srli_epi64(hi, 32);
+            ssd13 = _mm256_add_epi64(ssd13, _mm256_mul_epu32(lo, lo));
+            ssd13 = _mm256_add_epi64(ssd13, _mm256_mul_epu32(hi, hi));
+        }
+        sad01 = _mm256_add_epi64(sad01, _mm256_unpacklo_epi32(ab, zero));
+        sad23 = _mm256_add_epi64(sad23, _mm256_unpackhi_epi32(ab, zero));
+    }
+    _mm256_storeu_si256((__m256i*)q64, sad01);
+    sum[0][0] += q64[0] + q64[2];
+    sum[1][0] += q64[1] + q64[3];
+    _mm256_storeu_si256((__m256i*)q64, sad23);
+    sum[2][0] += q64[0] + q64[2];
+    sum[3][0] += q64[1] + q64[3];
+    _mm256_storeu_si256((__m256i*)q64, ssd02);
+    sum[0][1] += q64[0] + q64[2];
+    sum[2][1] += q64[1] + q64[3];
+    _mm256_storeu_si256((__m256i*)q64, ssd13);
+    sum[1][1] += q64[0] + q64[2];
+    sum[3][1] += q64[1] + q64[3];
+    _mm256_storeu_si256((__m256i*)q, mx);
+    for (j=0; j<16; ++j) {
+        sum[j & 3][2] = MAX(sum[j & 3][2], q[j]);
+    }
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint16_t)e;
+        }
+        sum[x & 3][0] += e;
+        sum[x & 3][1] += (uint64_t)e*e;
+        sum[x & 3][2]  = MAX(sum[x & 3][2], (uint64_t)e);
+    }
+}
+
+/*****************************************************************************
+ *                          ssim
+ ****************************************************************************/
+
+/**
+ *  4x4 sums of the four blocks in 16 16-bit columns of 4 rows, as in SSE2;
+ *  lane 0 yields blocks 0 and 1, lane 1 blocks 2 and 3. Stores s[0..@n).
+ */
+static inline void ssim_4x4x4(__m256i a[4], __m256i b[4], uint64_t (*s)[4], int n)
+{
+    const __m256i one = _mm256_set1_epi16(1);
+    __m256i s1  = _mm256_add_epi16(_mm256_add_epi16(a[0], a[1]), _mm256_add_epi16(a[2], a[3]));
+    __m256i s2  = _mm256_add_epi16(_mm256_add_epi16(b[0], b[1]), _mm256_add_epi16(b[2], b[3]));
+    __m256i ss  = _mm256_setzero_si256();
+    __m256i s12 = _mm256_setzero_si256();
+    __m256i t0, t1, t2, t3, u[2];
+    int y, k;
+    
+    for (y=0; y<4; ++y) {
+        ss  = _mm256_add_epi32(ss, _mm256_add_epi32(_mm256_madd_epi16(a[y], a[y]), 
+                                                    _mm256_madd_epi16(b[y], b[y])));
+        s12 = _mm256_add_epi32(s12, _mm256_madd_epi16(a[y], b[y]));
+    }
+    s1 = _mm256_madd_epi16(s1, one);
+    s2 = _mm256_madd_epi16(s2, one);
+    t0 = _mm256_unpacklo_epi32(s1, s2);
+    t1 = _mm256_unpackhi_epi32(s1, s2);
+    t2 = _mm256_unpacklo_epi32(ss, s12);
+    t3 = _mm256_unpackhi_epi32(ss, s12);
+    u[0] = _mm256_add_epi32(_mm256_unpacklo_epi64(t0, t2), _mm256_unpackhi_epi64(t0, t2));
+    u[1] = _mm256_add_epi32(_mm256_unpacklo_epi64(t1, t3), _mm256_unpackhi_epi64(t1, t3));
+    
+    for (k=0; k<n; ++k) {
+        __m128i v = (k < 2) ? _mm256_castsi256_si128(u[k]) : _mm256_extracti128_si256(u[k-2], 1);
+        _mm256_storeu_si256((__m256i*)s[k], _mm256_cvtepu32_epi64(v));
+    }
+}
+
+static void b8_ssim_4x4_avx2(uint8_t *a, int sa, uint8_t *b, int sb, int n, uint64_t (*s)[4])
+{
+    __m256i va[4], vb[4];
+    int32_t v;
+    int i = 0, y;
+    
+    for (; i+4<=n; i+=4) {
+        for (y=0; y<4; ++y) {
+            va[y] = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(a + y*sa + 4*i)));
+            vb[y] = _mm256_cvtepu8_epi16(_mm_loadu_si128((__m128i*)(b + y*sb + 4*i)));
+        }
+        ssim_4x4x4(va, vb, s + i, 4);
+    }
+    for (; i<n; i+=2) {
+        for (y=0; y<4; ++y) {
+            if (i+2<=n) {
+                va[y] = _mm256_cvtepu8_epi16(_mm_loadl_epi64((__m128i*)(a + y*sa + 4*i)));
+                vb[y] = _mm256_cvtepu8_epi16(_mm_loadl_epi64((__m128i*)(b + y*sb + 4*i)));
+            } else {
+                memcpy(&v, a + y*sa + 4*i, 4);
+                va[y] = _mm256_cvtepu8_epi16(_mm_cvtsi32_si128(v));
+                memcpy(&v, b + y*sb + 4*i, 4);
+                vb[y] = _mm256_cvtepu8_epi16(_mm_cvtsi32_si128(v));
+            }
+        }
+        ssim_4x4x4(va, vb, s + i, MIN(2, n - i));
+    }
+}
+
+void yuv_kern_set_avx2(yuv_kern_t *k)
+{
+    k->b8_uv_split  = b8_uv_split_avx2;
+    k->b8_uv_merge  = b8_uv_merge_avx2;
+    k->b16_uv_split = b16_uv_split_avx2;
+    k->b16_uv_merge = b16_uv_merge_avx2;
+    
+    k->b8_yuyv_split     = b8_yuyv_split_avx2;
+    k->b8_yuyv_merge     = b8_yuyv_merge_avx2;
+    k->b16_yuyv_split    = b16_yuyv_split_avx2;
+    k->b16_yuyv_merge    = b16_yuyv_merge_avx2;
+    k->b8_yuyv_split_sp  = b8_yuyv_split_sp_avx2;
+    k->b16_yuyv_split_sp = b16_yuyv_split_sp_avx2;
+    
+    k->b8_shuf4  = b8_shuf4_avx2;
+    k->b16_shuf4 = b16_shuf4_avx2;
+    
+    k->bn_unpack  = bn_unpack_avx2;
+    k->bn_pack    = bn_pack_avx2;
+    
+    k->b16_to_b8 = b16_to_b8_avx2;
+    k->b8_to_b16 = b8_to_b16_avx2;
+    k->b16_shift = b16_shift_avx2;
+    
+    k->b8_vfilt  = b8_vfilt_avx2;
+    k->b16_vfilt = b16_vfilt_avx2;
+    
+    k->b8_vscale  = b8_vscale_avx2;
+    k->b16_vscale = b16_vscale_avx2;
+    
+    k->b8_diff  = b8_diff_avx2;
+    k->b16_diff = b16_diff_avx2;
+    k->b8_diff4  = b8_diff4_avx2;
+    k->b16_diff4 = b16_diff4_avx2;
+    
+    k->b8_ssim_4x4 = b8_ssim_4x4_avx2;
+}
+
+#endif
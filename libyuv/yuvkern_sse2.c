@@ -0,0 +1,975 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvkern_sse2.c
+ *  @brief SSE2 row kernels, registered by yuv_kern_init() for CPU_SSE2 and
+ *      up. Loads and stores are unaligned, rows of any width finish in C.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <emmintrin.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+static void b8_uv_split_sse2(uint8_t *u, uint8_t *v, uint8_t *uv, int n)
+{
+    const __m128i lo = _mm_set1_epi16(0x00ff);
+    int x;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m128i a = _mm_loadu_si128((__m128i*)(uv + 2*x     ));
+        __m128i b = _mm_loadu_si128((__m128i*)(uv + 2*x + 16));
+        _mm_storeu_si128((__m128i*)(u + x), 
+            _mm_packus_epi16(_mm_and_si128(a, lo), _mm_and_si128(b, lo)));
+        _mm_storeu_si128((__m128i*)(v + x), 
+            _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8)));
+    }
+    for (; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b8_uv_merge_sse2(uint8_t *uv, uint8_t *u, uint8_t *v, int n)
+{
+    int x;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m128i a = _mm_loadu_si128((__m128i*)(u + x));
+        __m128i b = _mm_loadu_si128((__m128i*)(v + x));
+        _mm_storeu_si128((__m128i*)(uv + 2*x     ), _mm_unpacklo_epi8(a, b));
+        _mm_storeu_si128((__m128i*)(uv + 2*x + 16), _mm_unpackhi_epi8(a, b));
+    }
+    for (; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+/**
+ *  u0 v0 u1 v1 u2 v2 u3 v3 -> u0 u1 u2 u3 v0 v1 v2 v3
+ */
+static inline __m128i b16_deinterleave(__m128i a)
+{
+    a = _mm_shufflelo_epi16(a, _MM_SHUFFLE(3,1,2,0));
+    a = _mm_shufflehi_epi16(a, _MM_SHUFFLE(3,1,2,0));
+    return _mm_shuffle_epi32(a, _MM_SHUFFLE(3,1,2,0));
+}
+
+static void b16_uv_split_sse2(uint16_t *u, uint16_t *v, uint16_t *uv, int n)
+{
+    int x;
+    
+    for (x=0; x+8<=n; x+=8) {
+        __m128i a = b16_deinterleave(_mm_loadu_si128((__m128i*)(uv + 2*x    )));
+        __m128i b = b16_deinterleave(_mm_loadu_si128((__m128i*)(uv + 2*x + 8)));
+        _mm_storeu_si128((__m128i*)(u + x), _mm_unpacklo_epi64(a, b));
+        _mm_storeu_si128((__m128i*)(v + x), _mm_unpackhi_epi64(a, b));
+    }
+    for (; x<n; ++x) {
+        u[x] = uv[2*x  ];
+        v[x] = uv[2*x+1];
+    }
+}
+
+static void b16_uv_merge_sse2(uint16_t *uv, uint16_t *u, uint16_t *v, int n)
+{
+    int x;
+    
+    for (x=0; x+8<=n; x+=8) {
+        __m128i a = _mm_loadu_si128((__m128i*)(u + x));
+        __m128i b = _mm_loadu_si128((__m128i*)(v + x));
+        _mm_storeu_si128((__m128i*)(uv + 2*x    ), _mm_unpacklo_epi16(a, b));
+        _mm_storeu_si128((__m128i*)(uv + 2*x + 8), _mm_unpackhi_epi16(a, b));
+    }
+    for (; x<n; ++x) {
+        uv[2*x  ] = u[x];
+        uv[2*x+1] = v[x];
+    }
+}
+
+/**
+ *  yuyv/uyvy rows: 4 samples per group, luma at @yo and @yo+2.
+ *  @y, @c get 16 (8-bit) or 8 (16-bit) luma and interleaved chroma
+ *  samples out of the 32 bytes of @a, @b
+ */
+static inline void b8_yc_split(__m128i a, __m128i b, int yo, __m128i *y, __m128i *c)
+{
+    const __m128i lo = _mm_set1_epi16(0x00ff);
+    __m128i e = _mm_packus_epi16(_mm_and_si128(a, lo), _mm_and_si128(b, lo));
+    __m128i o = _mm_packus_epi16(_mm_srli_epi16(a, 8), _mm_srli_epi16(b, 8));
+    *y = yo ? o : e;
+    *c = yo ? e : o;
+}
+
+static inline void b16_yc_split(__m128i a, __m128i b, int yo, __m128i *y, __m128i *c)
+{
+    __m128i e, o;
+    a = b16_deinterleave(a);
+    b = b16_deinterleave(b);
+    e = _mm_unpacklo_epi64(a, b);
+    o = _mm_unpackhi_epi64(a, b);
+    *y = yo ? o : e;
+    *c = yo ? e : o;
+}
+
+static void b8_yuyv_split_sse2(uint8_t *y, uint8_t *u, uint8_t *v, uint8_t *p, 
+                               int n, int yo)
+{
+    const __m128i lo = _mm_set1_epi16(0x00ff);
+    __m128i y0, y1, c0, c1;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16, p+=64) {
+        b8_yc_split(_mm_loadu_si128((__m128i*)(p     )), 
+                    _mm_loadu_si128((__m128i*)(p + 16)), yo, &y0, &c0);
+        b8_yc_split(_mm_loadu_si128((__m128i*)(p + 32)), 
+                    _mm_loadu_si128((__m128i*)(p + 48)), yo, &y1, &c1);
+        _mm_storeu_si128((__m128i*)(y + 2*x     ), y0);
+        _mm_storeu_si128((__m128i*)(y + 2*x + 16), y1);
+        _mm_storeu_si128((__m128i*)(u + x), 
+            _mm_packus_epi16(_mm_and_si128(c0, lo), _mm_and_si128(c1, lo)));
+        _mm_storeu_si128((__m128i*)(v + x), 
+            _mm_packus_epi16(_mm_srli_epi16(c0, 8), _mm_srli_epi16(c1, 8)));
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b8_yuyv_split_sp_sse2(uint8_t *y, uint8_t *uv, uint8_t *p, int n, int yo)
+{
+    __m128i y0, c0;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+8<=n; x+=8, p+=32) {
+        b8_yc_split(_mm_loadu_si128((__m128i*)(p     )), 
+                    _mm_loadu_si128((__m128i*)(p + 16)), yo, &y0, &c0);
+        _mm_storeu_si128((__m128i*)(y + 2*x), y0);
+        if (uv) {
+            _mm_storeu_si128((__m128i*)(uv + 2*x), c0);
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b8_yuyv_merge_sse2(uint8_t *p, uint8_t *y, uint8_t *u, uint8_t *v, 
+                               int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+16<=n; x+=16, p+=64) {
+        __m128i y0 = _mm_loadu_si128((__m128i*)(y + 2*x     ));
+        __m128i y1 = _mm_loadu_si128((__m128i*)(y + 2*x + 16));
+        __m128i u0 = _mm_loadu_si128((__m128i*)(u + x));
+        __m128i v0 = _mm_loadu_si128((__m128i*)(v + x));
+        __m128i c0 = _mm_unpacklo_epi8(u0, v0);
+        __m128i c1 = _mm_unpackhi_epi8(u0, v0);
+        if (yo) {
+            _mm_storeu_si128((__m128i*)(p     ), _mm_unpacklo_epi8(c0, y0));
+            _mm_storeu_si128((__m128i*)(p + 16), _mm_unpackhi_epi8(c0, y0));
+            _mm_storeu_si128((__m128i*)(p + 32), _mm_unpacklo_epi8(c1, y1));
+            _mm_storeu_si128((__m128i*)(p + 48), _mm_unpackhi_epi8(c1, y1));
+        } else {
+            _mm_storeu_si128((__m128i*)(p     ), _mm_unpacklo_epi8(y0, c0));
+            _mm_storeu_si128((__m128i*)(p + 16), _mm_unpackhi_epi8(y0, c0));
+            _mm_storeu_si128((__m128i*)(p + 32), _mm_unpacklo_epi8(y1, c1));
+            _mm_storeu_si128((__m128i*)(p + 48), _mm_unpackhi_epi8(y1, c1));
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+static void b16_yuyv_split_sse2(uint16_t *y, uint16_t *u, uint16_t *v, uint16_t *p, 
+                                int n, int yo)
+{
+    __m128i y0, y1, c0, c1;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+8<=n; x+=8, p+=32) {
+        b16_yc_split(_mm_loadu_si128((__m128i*)(p     )), 
+                     _mm_loadu_si128((__m128i*)(p +  8)), yo, &y0, &c0);
+        b16_yc_split(_mm_loadu_si128((__m128i*)(p + 16)), 
+                     _mm_loadu_si128((__m128i*)(p + 24)), yo, &y1, &c1);
+        _mm_storeu_si128((__m128i*)(y + 2*x    ), y0);
+        _mm_storeu_si128((__m128i*)(y + 2*x + 8), y1);
+        c0 = b16_deinterleave(c0);
+        c1 = b16_deinterleave(c1);
+        _mm_storeu_si128((__m128i*)(u + x), _mm_unpacklo_epi64(c0, c1));
+        _mm_storeu_si128((__m128i*)(v + x), _mm_unpackhi_epi64(c0, c1));
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        u[x]     = p[uo  ];
+        v[x]     = p[uo+2];
+    }
+}
+
+static void b16_yuyv_split_sp_sse2(uint16_t *y, uint16_t *uv, uint16_t *p, int n, int yo)
+{
+    __m128i y0, c0;
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+4<=n; x+=4, p+=16) {
+        b16_yc_split(_mm_loadu_si128((__m128i*)(p    )), 
+                     _mm_loadu_si128((__m128i*)(p + 8)), yo, &y0, &c0);
+        _mm_storeu_si128((__m128i*)(y + 2*x), y0);
+        if (uv) {
+            _mm_storeu_si128((__m128i*)(uv + 2*x), c0);
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        y[2*x  ] = p[yo  ];
+        y[2*x+1] = p[yo+2];
+        if (uv) {
+            uv[2*x  ] = p[uo  ];
+            uv[2*x+1] = p[uo+2];
+        }
+    }
+}
+
+static void b16_yuyv_merge_sse2(uint16_t *p, uint16_t *y, uint16_t *u, uint16_t *v, 
+                                int n, int yo)
+{
+    int uo = 1 - yo;
+    int x;
+    
+    for (x=0; x+8<=n; x+=8, p+=32) {
+        __m128i y0 = _mm_loadu_si128((__m128i*)(y + 2*x    ));
+        __m128i y1 = _mm_loadu_si128((__m128i*)(y + 2*x + 8));
+        __m128i u0 = _mm_loadu_si128((__m128i*)(u + x));
+        __m128i v0 = _mm_loadu_si128((__m128i*)(v + x));
+        __m128i c0 = _mm_unpacklo_epi16(u0, v0);
+        __m128i c1 = _mm_unpackhi_epi16(u0, v0);
+        if (yo) {
+            _mm_storeu_si128((__m128i*)(p     ), _mm_unpacklo_epi16(c0, y0));
+            _mm_storeu_si128((__m128i*)(p +  8), _mm_unpackhi_epi16(c0, y0));
+            _mm_storeu_si128((__m128i*)(p + 16), _mm_unpacklo_epi16(c1, y1));
+            _mm_storeu_si128((__m128i*)(p + 24), _mm_unpackhi_epi16(c1, y1));
+        } else {
+            _mm_storeu_si128((__m128i*)(p     ), _mm_unpacklo_epi16(y0, c0));
+            _mm_storeu_si128((__m128i*)(p +  8), _mm_unpackhi_epi16(y0, c0));
+            _mm_storeu_si128((__m128i*)(p + 16), _mm_unpacklo_epi16(y1, c1));
+            _mm_storeu_si128((__m128i*)(p + 24), _mm_unpackhi_epi16(y1, c1));
+        }
+    }
+    for (; x<n; ++x, p+=4) {
+        p[yo  ] = y[2*x  ];
+        p[yo+2] = y[2*x+1];
+        p[uo  ] = u[x];
+        p[uo+2] = v[x];
+    }
+}
+
+/*****************************************************************************
+ *                          bit depth
+ ****************************************************************************/
+static inline __m128i bias_x4(const uint16_t bias[4])
+{
+    return _mm_set1_epi64x((int64_t)bias[3] << 48 | (int64_t)bias[2] << 32 | 
+                           (int64_t)bias[1] << 16 | (int64_t)bias[0]);
+}
+
+static void b16_to_b8_sse2(uint8_t *dst, uint16_t *src, int n, int lshift,
+                           const uint16_t bias[4])
+{
+    const __m128i bs = bias_x4(bias);
+    const __m128i cl = _mm_cvtsi32_si128(lshift);
+    int x, v;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x    ));
+        __m128i b = _mm_loadu_si128((__m128i*)(src + x + 8));
+        a = _mm_srli_epi16(_mm_adds_epu16(_mm_sll_epi16(a, cl), bs), 8);
+        b = _mm_srli_epi16(_mm_adds_epu16(_mm_sll_epi16(b, cl), bs), 8);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(a, b));
+    }
+    for (; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint8_t)(MIN(v, 0xffff) >> 8);
+    }
+}
+
+static void b8_to_b16_sse2(uint16_t *dst, uint8_t *src, int n, int lshift)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i cl   = _mm_cvtsi32_si128(lshift);
+    int x;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x));
+        _mm_storeu_si128((__m128i*)(dst + x    ), _mm_sll_epi16(_mm_unpacklo_epi8(a, zero), cl));
+        _mm_storeu_si128((__m128i*)(dst + x + 8), _mm_sll_epi16(_mm_unpackhi_epi8(a, zero), cl));
+    }
+    for (; x<n; ++x) {
+        dst[x] = (uint16_t)(src[x] << lshift);
+    }
+}
+
+static void b16_shift_sse2(uint16_t *dst, uint16_t *src, int n, int lshift, int rshift,
+                           const uint16_t bias[4])
+{
+    const __m128i bs = bias_x4(bias);
+    const __m128i cl = _mm_cvtsi32_si128(lshift);
+    const __m128i cr = _mm_cvtsi32_si128(rshift);
+    int x, v;
+    
+    for (x=0; x+8<=n; x+=8) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x));
+        a = _mm_srl_epi16(_mm_adds_epu16(_mm_sll_epi16(a, cl), bs), cr);
+        _mm_storeu_si128((__m128i*)(dst + x), a);
+    }
+    for (; x<n; ++x) {
+        v = (uint16_t)(src[x] << lshift) + bias[x&3];
+        dst[x] = (uint16_t)(MIN(v, 0xffff) >> rshift);
+    }
+}
+
+/*****************************************************************************
+ *                          vertical filter
+ ****************************************************************************/
+static void b8_vfilt_sse2(uint8_t *dst, uint8_t *r[4], const int16_t c[4], int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rnd  = _mm_set1_epi16(32);
+    __m128i cx[4], lo, hi, a;
+    int x, k, v;
+    
+    for (k=0; k<4; ++k) {
+        cx[k] = _mm_set1_epi16(c[k]);
+    }
+    for (x=0; x+16<=n; x+=16) {
+        lo = hi = rnd;
+        for (k=0; k<4; ++k) {
+            a  = _mm_loadu_si128((__m128i*)(r[k] + x));
+            lo = _mm_add_epi16(lo, _mm_mullo_epi16(_mm_unpacklo_epi8(a, zero), cx[k]));
+            hi = _mm_add_epi16(hi, _mm_mullo_epi16(_mm_unpackhi_epi8(a, zero), cx[k]));
+        }
+        lo = _mm_srai_epi16(lo, 6);
+        hi = _mm_srai_epi16(hi, 6);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(lo, hi));
+    }
+    for (; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+/**
+ *  samples are taken as signed (x - 32768), so pmaddwd sums tap pairs in
+ *  32 bits; with the taps summing to 64, the offset comes back as 32768
+ *  after the shift, and packs + xor saturates to [0, 65535].
+ */
+static void b16_vfilt_sse2(uint16_t *dst, uint16_t *r[4], const int16_t c[4], int n, int max)
+{
+    const __m128i sgn = _mm_set1_epi16((short)0x8000);
+    const __m128i rnd = _mm_set1_epi32(32);
+    const __m128i top = _mm_set1_epi16((short)(max - 32768));
+    const __m128i c01 = _mm_set1_epi32((int)((uint32_t)(uint16_t)c[1] << 16 | (uint16_t)c[0]));
+    const __m128i c23 = _mm_set1_epi32((int)((uint32_t)(uint16_t)c[3] << 16 | (uint16_t)c[2]));
+    int x, v;
+    
+    for (x=0; x+8<=n; x+=8) {
+        __m128i a = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[0] + x)), sgn);
+        __m128i b = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[1] + x)), sgn);
+        __m128i d = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[2] + x)), sgn);
+        __m128i e = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[3] + x)), sgn);
+        __m128i lo = _mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(a, b), c01),
+                                   _mm_madd_epi16(_mm_unpacklo_epi16(d, e), c23));
+        __m128i hi = _mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(a, b), c01),
+                                   _mm_madd_epi16(_mm_unpackhi_epi16(d, e), c23));
+        lo = _mm_srai_epi32(_mm_add_epi32(lo, rnd), 6);
+        hi = _mm_srai_epi32(_mm_add_epi32(hi, rnd), 6);
+        a  = _mm_min_epi16(_mm_packs_epi32(lo, hi), top);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(a, sgn));
+    }
+    for (; x<n; ++x) {
+        v = c[0]*r[0][x] + c[1]*r[1][x] + c[2]*r[2][x] + c[3]*r[3][x] + 32;
+        v = v<0 ? 0 : v>>6;
+        dst[x] = (uint16_t)MIN(v, max);
+    }
+}
+
+/*****************************************************************************
+ *                          polyphase scaling
+ ****************************************************************************/
+
+/**
+ *  taps k, k+1 paired for pmaddwd; an odd last tap pairs with 0
+ */
+static inline __m128i scale_tap_pair(const int16_t *c, int k, int nt)
+{
+    uint16_t c1 = (k + 1 < nt) ? (uint16_t)c[k+1] : 0;
+    return _mm_set1_epi32((int)((uint32_t)c1 << 16 | (uint16_t)c[k]));
+}
+
+static void b8_vscale_sse2(uint8_t *dst, uint8_t **r, const int16_t *c, int nt, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rnd  = _mm_set1_epi32(1 << 13);
+    int x, k, v;
+    
+    for (x=0; x+16<=n; x+=16) {
+        __m128i s0 = rnd, s1 = rnd, s2 = rnd, s3 = rnd;
+        for (k=0; k<nt; k+=2) {
+            __m128i cc = scale_tap_pair(c, k, nt);
+            __m128i a  = _mm_loadu_si128((__m128i*)(r[k] + x));
+            __m128i b  = _mm_loadu_si128((__m128i*)(r[MIN(k+1, nt-1)] + x));
+            __m128i lo = _mm_unpacklo_epi8(a, b);
+            __m128i hi = _mm_unpackhi_epi8(a, b);
+            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi8(lo, zero), cc));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi8(lo, zero), cc));
+            s2 = _mm_add_epi32(s2, _mm_madd_epi16(_mm_unpacklo_epi8(hi, zero), cc));
+            s3 = _mm_add_epi32(s3, _mm_madd_epi16(_mm_unpackhi_epi8(hi, zero), cc));
+        }
+        s0 = _mm_packs_epi32(_mm_srai_epi32(s0, 14), _mm_srai_epi32(s1, 14));
+        s2 = _mm_packs_epi32(_mm_srai_epi32(s2, 14), _mm_srai_epi32(s3, 14));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(s0, s2));
+    }
+    for (; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * r[k][x];
+        }
+        v = v<0 ? 0 : v>>14;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+/**
+ *  signed samples as in b16_vfilt_sse2(), the taps summing to 1<<14
+ */
+static void b16_vscale_sse2(uint16_t *dst, uint16_t **r, const int16_t *c, int nt, int n, int max)
+{
+    const __m128i sgn = _mm_set1_epi16((short)0x8000);
+    const __m128i rnd = _mm_set1_epi32(1 << 13);
+    const __m128i top = _mm_set1_epi16((short)(max - 32768));
+    int x, k, v;
+    
+    for (x=0; x+8<=n; x+=8) {
+        __m128i s0 = rnd, s1 = rnd;
+        for (k=0; k<nt; k+=2) {
+            __m128i cc = scale_tap_pair(c, k, nt);
+            __m128i a  = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[k] + x)), sgn);
+            __m128i b  = _mm_xor_si128(_mm_loadu_si128((__m128i*)(r[MIN(k+1, nt-1)] + x)), sgn);
+            s0 = _mm_add_epi32(s0, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), cc));
+            s1 = _mm_add_epi32(s1, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), cc));
+        }
+        s0 = _mm_packs_epi32(_mm_srai_epi32(s0, 14), _mm_srai_epi32(s1, 14));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_xor_si128(_mm_min_epi16(s0, top), sgn));
+    }
+    for (; x<n; ++x) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * (r[k][x] - 32768);
+        }
+        v = (v >> 14) + 32768;
+        dst[x] = (uint16_t)(v<0 ? 0 : MIN(v, max));
+    }
+}
+
+/**
+ *  two output samples of 4 taps a register, the pmaddwd pairs of 4 
+ *  outputs summed by a transposing shuffle
+ */
+static inline __m128i hscale_sum4(__m128i s01, __m128i s23)
+{
+    __m128 a = _mm_castsi128_ps(s01);
+    __m128 b = _mm_castsi128_ps(s23);
+    return _mm_add_epi32(_mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(2,0,2,0))),
+                         _mm_castps_si128(_mm_shuffle_ps(a, b, _MM_SHUFFLE(3,1,3,1))));
+}
+
+static inline __m128i b8_load4(const uint8_t *p)
+{
+    int32_t v;
+    memcpy(&v, p, 4);
+    return _mm_cvtsi32_si128(v);
+}
+
+static inline __m128i tap_load8(const int16_t *c0, const int16_t *c1)
+{
+    return _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)c0), _mm_loadl_epi64((__m128i*)c1));
+}
+
+static void b8_hscale_sse2(uint8_t *dst, uint8_t *src, const int32_t *pos, const int16_t *c,
+                           int nt, int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i rnd  = _mm_set1_epi32(1 << 13);
+    int x, k, v;
+    
+    for (x=0; x+4<=n; x+=4, c+=4*nt) {
+        __m128i s01 = zero, s23 = zero;
+        for (k=0; k<nt; k+=4) {
+            __m128i a01 = _mm_unpacklo_epi32(b8_load4(src + pos[x  ] + k), b8_load4(src + pos[x+1] + k));
+            __m128i a23 = _mm_unpacklo_epi32(b8_load4(src + pos[x+2] + k), b8_load4(src + pos[x+3] + k));
+            s01 = _mm_add_epi32(s01, _mm_madd_epi16(_mm_unpacklo_epi8(a01, zero), 
+                                                    tap_load8(c + k, c + nt + k)));
+            s23 = _mm_add_epi32(s23, _mm_madd_epi16(_mm_unpacklo_epi8(a23, zero), 
+                                                    tap_load8(c + 2*nt + k, c + 3*nt + k)));
+        }
+        s01 = _mm_srai_epi32(_mm_add_epi32(hscale_sum4(s01, s23), rnd), 14);
+        s01 = _mm_packs_epi32(s01, s01);
+        v   = _mm_cvtsi128_si32(_mm_packus_epi16(s01, s01));
+        memcpy(dst + x, &v, 4);
+    }
+    for (; x<n; ++x, c+=nt) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * src[pos[x] + k];
+        }
+        v = v<0 ? 0 : v>>14;
+        dst[x] = (uint8_t)MIN(v, 255);
+    }
+}
+
+static void b16_hscale_sse2(uint16_t *dst, uint16_t *src, const int32_t *pos, const int16_t *c,
+                            int nt, int n, int max)
+{
+    const __m128i sgn = _mm_set1_epi16((short)0x8000);
+    const __m128i rnd = _mm_set1_epi32(1 << 13);
+    const __m128i top = _mm_set1_epi16((short)(max - 32768));
+    int x, k, v;
+    
+    for (x=0; x+4<=n; x+=4, c+=4*nt) {
+        __m128i s01 = _mm_setzero_si128(), s23 = _mm_setzero_si128();
+        for (k=0; k<nt; k+=4) {
+            __m128i a01 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)(src + pos[x  ] + k)),
+                                             _mm_loadl_epi64((__m128i*)(src + pos[x+1] + k)));
+            __m128i a23 = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)(src + pos[x+2] + k)),
+                                             _mm_loadl_epi64((__m128i*)(src + pos[x+3] + k)));
+            s01 = _mm_add_epi32(s01, _mm_madd_epi16(_mm_xor_si128(a01, sgn), 
+                                                    tap_load8(c + k, c + nt + k)));
+            s23 = _mm_add_epi32(s23, _mm_madd_epi16(_mm_xor_si128(a23, sgn), 
+                                                    tap_load8(c + 2*nt + k, c + 3*nt + k)));
+        }
+        s01 = _mm_srai_epi32(_mm_add_epi32(hscale_sum4(s01, s23), rnd), 14);
+        s01 = _mm_min_epi16(_mm_packs_epi32(s01, s01), top);
+        _mm_storel_epi64((__m128i*)(dst + x), _mm_xor_si128(s01, sgn));
+    }
+    for (; x<n; ++x, c+=nt) {
+        v = 1 << 13;
+        for (k=0; k<nt; ++k) {
+            v += c[k] * (src[pos[x] + k] - 32768);
+        }
+        v = (v >> 14) + 32768;
+        dst[x] = (uint16_t)(v<0 ? 0 : MIN(v, max));
+    }
+}
+
+/*****************************************************************************
+ *                          sad / ssd
+ ****************************************************************************/
+
+/**
+ *  32-bit square sums are widened to 64 bits once per span of vectors,
+ *  before the lanes can wrap
+ */
+#define DIFF_SPAN   4096
+
+static inline uint64_t sum_epi64(__m128i a)
+{
+    uint64_t q[2];
+    _mm_storeu_si128((__m128i*)q, a);
+    return q[0] + q[1];
+}
+
+static inline uint64_t max_epu8(__m128i a)
+{
+    uint8_t q[16];
+    int k, m = 0;
+    _mm_storeu_si128((__m128i*)q, a);
+    for (k=0; k<16; ++k) {
+        m = MAX(m, q[k]);
+    }
+    return m;
+}
+
+static inline uint64_t max_epu16(__m128i a)
+{
+    uint16_t q[8];
+    int k, m = 0;
+    _mm_storeu_si128((__m128i*)q, a);
+    for (k=0; k<8; ++k) {
+        m = MAX(m, q[k]);
+    }
+    return m;
+}
+
+/**
+ *  |a-b| as saturated subtractions both ways, summed by psadbw and squared
+ *  by pmaddwd
+ */
+static void b8_diff_sse2(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[3])
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sad = zero, ssd = zero, mx = zero;
+    int x = 0, end, e;
+    
+    while (x+16<=n) {
+        __m128i sq = zero;
+        end = MIN(n, x + 16*DIFF_SPAN);
+        for (; x+16<=end; x+=16) {
+            __m128i va = _mm_loadu_si128((__m128i*)(a + x));
+            __m128i vb = _mm_loadu_si128((__m128i*)(b + x));
+            __m128i ve = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            __m128i lo = _mm_unpacklo_epi8(ve, zero);
+            __m128i hi = _mm_unpackhi_epi8(ve, zero);
+            if (d) {
+                _mm_storeu_si128((__m128i*)(d + x), ve);
+            }
+            mx  = _mm_max_epu8(mx, ve);
+            sad = _mm_add_epi64(sad, _mm_sad_epu8(ve, zero));
+            sq  = _mm_add_epi32(sq, _mm_add_epi32(_mm_madd_epi16(lo, lo), _mm_madd_epi16(hi, hi)));
+        }
+        ssd = _mm_add_epi64(ssd, _mm_unpacklo_epi32(sq, zero));
+        ssd = _mm_add_epi64(ssd, _mm_unpackhi_epi32(sq, zero));
+    }
+    sum[0] += sum_epi64(sad);
+    sum[1] += sum_epi64(ssd);
+    sum[2]  = MAX(sum[2], max_epu8(mx));
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint8_t)e;
+        }
+        sum[0] += e;
+        sum[1] += e*e;
+        sum[2]  = MAX(sum[2], (uint64_t)e);
+    }
+}
+
+/**
+ *  |a-b| of 16 bits squares past 32 bits, so pmuludq takes the even and
+ *  odd lanes into 64-bit sums
+ */
+static void b16_diff_sse2(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[3])
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sad = zero, ssd = zero, mx = zero;
+    int x = 0, end, e;
+    
+    while (x+8<=n) {
+        __m128i ab = zero;
+        end = MIN(n, x + 8*DIFF_SPAN);
+        for (; x+8<=end; x+=8) {
+            __m128i va = _mm_loadu_si128((__m128i*)(a + x));
+            __m128i vb = _mm_loadu_si128((__m128i*)(b + x));
+            __m128i ve = _mm_or_si128(_mm_subs_epu16(va, vb), _mm_subs_epu16(vb, va));
+            __m128i lo = _mm_unpacklo_epi16(ve, zero);
+            __m128i hi = _mm_unpackhi_epi16(ve, zero);
+            if (d) {
+                _mm_storeu_si128((__m128i*)(d + x), ve);
+            }
+            mx  = _mm_adds_epu16(_mm_subs_epu16(mx, ve), ve);
+            ab  = _mm_add_epi32(ab, _mm_add_epi32(lo, hi));
+            ssd = _mm_add_epi64(ssd, _mm_mul_epu32(lo, lo));
+            ssd = _mm_add_epi64(ssd, _mm_mul_epu32(hi, hi));
+            lo  = _mm_srli_epi64(lo, 32);
+            hi  = _mm_srli_epi64(hi, 32);
+            ssd = _mm_add_epi64(ssd, _mm_mul_epu32(lo, lo));
+            ssd = _mm_add_epi64(ssd, _mm_mul_epu32(hi, hi));
+        }
+        sad = _mm_add_epi64(sad, _mm_unpacklo_epi32(ab, zero));
+        sad = _mm_add_epi64(sad, _mm_unpackhi_epi32(ab, zero));
+    }
+    sum[0] += sum_epi64(sad);
+    sum[1] += sum_epi64(ssd);
+    sum[2]  = MAX(sum[2], max_epu16(mx));
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint16_t)e;
+        }
+        sum[0] += e;
+        sum[1] += (uint64_t)e*e;
+        sum[2]  = MAX(sum[2], (uint64_t)e);
+    }
+}
+
+/**
+ *  even and odd bytes of |a-b| as words, squared by pmullw within 16 bits;
+ *  the low and high word of a dword then hold positions 0/2, or 1/3
+ */
+static void b8_diff4_sse2(uint8_t *a, uint8_t *b, uint8_t *d, int n, uint64_t sum[4][3])
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i m8   = _mm_set1_epi16(0x00ff);
+    const __m128i m16  = _mm_set1_epi32(0xffff);
+    __m128i sad[4], ssd[4], mx[2] = {zero, zero};
+    uint16_t q[8];
+    int x = 0, end, e, k;
+    
+    for (k=0; k<4; ++k) {
+        sad[k] = ssd[k] = zero;
+    }
+    while (x+16<=n) {
+        __m128i ab[4] = {zero, zero, zero, zero};
+        __m128i sq[4] = {zero, zero, zero, zero};
+        end = MIN(n, x + 16*DIFF_SPAN);
+        for (; x+16<=end; x+=16) {
+            __m128i va  = _mm_loadu_si128((__m128i*)(a + x));
+            __m128i vb  = _mm_loadu_si128((__m128i*)(b + x));
+            __m128i ve  = _mm_or_si128(_mm_subs_epu8(va, vb), _mm_subs_epu8(vb, va));
+            __m128i e02 = _mm_and_si128(ve, m8);
+            __m128i e13 = _mm_srli_epi16(ve, 8);
+            __m128i q02 = _mm_mullo_epi16(e02, e02);
+            __m128i q13 = _mm_mullo_epi16(e13, e13);
+            if (d) {
+                _mm_storeu_si128((__m128i*)(d + x), ve);
+            }
+            mx[0] = _mm_max_epi16(mx[0], e02);
+            mx[1] = _mm_max_epi16(mx[1], e13);
+            ab[0] = _mm_add_epi32(ab[0], _mm_and_si128(e02, m16));
+            ab[1] = _mm_add_epi32(ab[1], _mm_and_si128(e13, m16));
+            ab[2] = _mm_add_epi32(ab[2], _mm_srli_epi32(e02, 16));
+            ab[3] = _mm_add_epi32(ab[3], _mm_srli_epi32(e13, 16));
+            sq[0] = _mm_add_epi32(sq[0], _mm_and_si128(q02, m16));
+            sq[1] = _mm_add_epi32(sq[1], _mm_and_si128(q13, m16));
+            sq[2] = _mm_add_epi32(sq[2], _mm_srli_epi32(q02, 16));
+            sq[3] = _mm_add_epi32(sq[3], _mm_srli_epi32(q13, 16));
+        }
+        for (k=0; k<4; ++k) {
+            sad[k] = _mm_add_epi64(sad[k], _mm_unpacklo_epi32(ab[k], zero));
+            sad[k] = _mm_add_epi64(sad[k], _mm_unpackhi_epi32(ab[k], zero));
+            ssd[k] = _mm_add_epi64(ssd[k], _mm_unpacklo_epi32(sq[k], zero));
+            ssd[k] = _mm_add_epi64(ssd[k], _mm_unpackhi_epi32(sq[k], zero));
+        }
+    }
+    for (k=0; k<4; ++k) {
+        sum[k][0] += sum_epi64(sad[k]);
+        sum[k][1] += sum_epi64(ssd[k]);
+    }
+    for (k=0; k<2; ++k) {
+        int j;
+        _mm_storeu_si128((__m128i*)q, mx[k]);
+        for (j=0; j<8; ++j) {
+            sum[k + 2*(j & 1)][2] = MAX(sum[k + 2*(j & 1)][2], q[j]);
+        }
+    }
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint8_t)e;
+        }
+        sum[x & 3][0] += e;
+        sum[x & 3][1] += e*e;
+        sum[x & 3][2]  = MAX(sum[x & 3][2], (uint64_t)e);
+    }
+}
+
+/**
+ *  |a-b| widened to dwords, dword k of either half at position k; 
+ *  pmuludq squares positions 0/2, and 1/3 after a shift
+ */
+static void b16_diff4_sse2(uint16_t *a, uint16_t *b, uint16_t *d, int n, uint64_t sum[4][3])
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i sad01 = zero, sad23 = zero, ssd02 = zero, ssd13 = zero, mx = zero;
+    uint64_t q64[2];
+    uint16_t q[8];
+    int x = 0, end, e, j;
+    
+    while (x+8<=n) {
+        __m128i ab = zero;
+        end = MIN(n, x + 8*DIFF_SPAN);
+        for (; x+8<=end; x+=8) {
+            __m128i va = _mm_loadu_si128((__m128i*)(a + x));
+            __m128i vb = _mm_loadu_si128((__m128i*)(b + x));
+            __m128i ve = _mm_or_si128(_mm_subs_epu16(va, vb), _mm_subs_epu16(vb, va));
+            __m128i lo = _mm_unpacklo_epi16(ve, zero);
+            __m128i hi = _mm_unpackhi_epi16(ve, zero);
+            if (d) {
+                _mm_storeu_si128((__m128i*)(d + x), ve);
+            }
+            mx    = _mm_adds_epu16(_mm_subs_epu16(mx, ve), ve);
+            ab    = _mm_add_epi32(ab, _mm_add_epi32(lo, hi));
+            ssd02 = _mm_add_epi64(ssd02, _mm_mul_epu32(lo, lo));
+            ssd02 = _mm_add_epi64(ssd02, _mm_mul_epu32(hi, hi));
+            lo    = _mm_srli_epi64(lo, 32);
+            hi    = _mm_srli_epi64(hi, 32);
+            ssd13 = _mm_add_epi64(ssd13, _mm_mul_epu32(lo, lo));
+            ssd13 = _mm_add_epi64(ssd13, _mm_mul_epu32(hi, hi));
+        }
+        sad01 = _mm_add_epi64(sad01, _mm_unpacklo_epi32(ab, zero));
+        sad23 = _mm_add_epi64(sad23, _mm_unpackhi_epi32(ab, zero));
+    }
+    _mm_storeu_si128((__m128i*)q64, sad01);
+    sum[0][0] += q64[0];
+    sum[1][0] += q64[1];
+    _mm_storeu_si128((__m128i*)q64, sad23);
+    sum[2][0] += q64[0];
+    sum[3][0] += q64[1];
+    _mm_storeu_si128((__m128i*)q64, ssd02);
+    sum[0][1] += q64[0];
+    sum[2][1] += q64[1];
+    _mm_storeu_si128((__m128i*)q64, ssd13);
+    sum[1][1] += q64[0];
+    sum[3][1] += q64[1];
+    _mm_storeu_si128((__m128i*)q, mx);
+    for (j=0; j<8; ++j) {
+        sum[j & 3][2] = MAX(sum[j & 3][2], q[j]);
+    }
+    for (; x<n; ++x) {
+        e = (int)a[x] - (int)b[x];
+        e = e>0 ? e : -e;
+        if (d) {
+            d[x] = (uint16_t)e;
+        }
+        sum[x & 3][0] += e;
+        sum[x & 3][1] += (uint64_t)e*e;
+        sum[x & 3][2]  = MAX(sum[x & 3][2], (uint64_t)e);
+    }
+}
+
+/*****************************************************************************
+ *                          ssim
+ ****************************************************************************/
+
+/**
+ *  4x4 sums of the two blocks in 8 16-bit columns of 4 rows: pmaddwd adds
+ *  column pairs, which are added and transposed into s[0..@n), n <= 2
+ */
+static inline void ssim_4x4x2(__m128i a[4], __m128i b[4], uint64_t (*s)[4], int n)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i one  = _mm_set1_epi16(1);
+    __m128i s1  = _mm_add_epi16(_mm_add_epi16(a[0], a[1]), _mm_add_epi16(a[2], a[3]));
+    __m128i s2  = _mm_add_epi16(_mm_add_epi16(b[0], b[1]), _mm_add_epi16(b[2], b[3]));
+    __m128i ss  = zero;
+    __m128i s12 = zero;
+    __m128i t0, t1, t2, t3, u;
+    int y;
+    
+    for (y=0; y<4; ++y) {
+        ss  = _mm_add_epi32(ss, _mm_add_epi32(_mm_madd_epi16(a[y], a[y]), 
+                                              _mm_madd_epi16(b[y], b[y])));
+        s12 = _mm_add_epi32(s12, _mm_madd_epi16(a[y], b[y]));
+    }
+    s1 = _mm_madd_epi16(s1, one);
+    s2 = _mm_madd_epi16(s2, one);
+    t0 = _mm_unpacklo_epi32(s1, s2);
+    t1 = _mm_unpackhi_epi32(s1, s2);
+    t2 = _mm_unpacklo_epi32(ss, s12);
+    t3 = _mm_unpackhi_epi32(ss, s12);
+    
+    u = _mm_add_epi32(_mm_unpacklo_epi64(t0, t2), _mm_unpackhi_epi64(t0, t2));
+    _mm_storeu_si128((__m128i*)(s[0]    ), _mm_unpacklo_epi32(u, zero));
+    _mm_storeu_si128((__m128i*)(s[0] + 2), _mm_unpackhi_epi32(u, zero));
+    if (n > 1) {
+        u = _mm_add_epi32(_mm_unpacklo_epi64(t1, t3), _mm_unpackhi_epi64(t1, t3));
+        _mm_storeu_si128((__m128i*)(s[1]    ), _mm_unpacklo_epi32(u, zero));
+        _mm_storeu_si128((__m128i*)(s[1] + 2), _mm_unpackhi_epi32(u, zero));
+    }
+}
+
+static void b8_ssim_4x4_sse2(uint8_t *a, int sa, uint8_t *b, int sb, int n, uint64_t (*s)[4])
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i lo[2][4], hi[2][4];
+    int i = 0, y;
+    
+    for (; i+4<=n; i+=4) {
+        for (y=0; y<4; ++y) {
+            __m128i va = _mm_loadu_si128((__m128i*)(a + y*sa + 4*i));
+            __m128i vb = _mm_loadu_si128((__m128i*)(b + y*sb + 4*i));
+            lo[0][y] = _mm_unpacklo_epi8(va, zero);
+            hi[0][y] = _mm_unpackhi_epi8(va, zero);
+            lo[1][y] = _mm_unpacklo_epi8(vb, zero);
+            hi[1][y] = _mm_unpackhi_epi8(vb, zero);
+        }
+        ssim_4x4x2(lo[0], lo[1], s + i,     2);
+        ssim_4x4x2(hi[0], hi[1], s + i + 2, 2);
+    }
+    for (; i<n; i+=2) {
+        for (y=0; y<4; ++y) {
+            __m128i va = (i+2<=n) ? _mm_loadl_epi64((__m128i*)(a + y*sa + 4*i)) 
+                                  : b8_load4(a + y*sa + 4*i);
+            __m128i vb = (i+2<=n) ? _mm_loadl_epi64((__m128i*)(b + y*sb + 4*i)) 
+                                  : b8_load4(b + y*sb + 4*i);
+            lo[0][y] = _mm_unpacklo_epi8(va, zero);
+            lo[1][y] = _mm_unpacklo_epi8(vb, zero);
+        }
+        ssim_4x4x2(lo[0], lo[1], s + i, MIN(2, n - i));
+    }
+}
+
+void yuv_kern_set_sse2(yuv_kern_t *k)
+{
+    k->b8_uv_split  = b8_uv_split_sse2;
+    k->b8_uv_merge  = b8_uv_merge_sse2;
+    k->b16_uv_split = b16_uv_split_sse2;
+    k->b16_uv_merge = b16_uv_merge_sse2;
+    
+    k->b8_yuyv_split     = b8_yuyv_split_sse2;
+    k->b8_yuyv_merge     = b8_yuyv_merge_sse2;
+    k->b16_yuyv_split    = b16_yuyv_split_sse2;
+    k->b16_yuyv_merge    = b16_yuyv_merge_sse2;
+    k->b8_yuyv_split_sp  = b8_yuyv_split_sp_sse2;
+    k->b16_yuyv_split_sp = b16_yuyv_split_sp_sse2;
+    
+    k->b16_to_b8 = b16_to_b8_sse2;
+    k->b8_to_b16 = b8_to_b16_sse2;
+    k->b16_shift = b16_shift_sse2;
+    
+    k->b8_vfilt  = b8_vfilt_sse2;
+    k->b16_vfilt = b16_vfilt_sse2;
+    
+    k->b8_vscale  = b8_vscale_sse2;
+    k->b16_vscale = b16_vscale_sse2;
+    k->b8_hscale  = b8_hscale_sse2;
+    k->b16_hscale = b16_hscale_sse2;
+    
+    k->b8_diff  = b8_diff_sse2;
+    k->b16_diff = b16_diff_sse2;
+    k->b8_diff4  = b8_diff4_sse2;
+    k->b16_diff4 = b16_diff4_sse2;
+    
+    k->b8_ssim_4x4 = b8_ssim_4x4_sse2;
+}
+
+#endif
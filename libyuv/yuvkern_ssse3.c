@@ -0,0 +1,428 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvkern_ssse3.c
+ *  @brief SSSE3 row kernels, registered by yuv_kern_init() for CPU_SSSE3
+ *      and up. pshufb does the byte gathers SSE2 cannot.
+ */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+#include <string.h>
+#include <tmmintrin.h>
+
+#include "yuvdef.h"
+#include "yuvcvt.h"
+
+
+/**
+ *  10-bit lte stream: sample k sits at bit 10k, LSB first. 8 samples
+ *  take 10 bytes, 16 samples take 5 whole words, so the vector loops
+ *  step 16 samples and leave the rest of the row to the C version from
+ *  a word boundary, where its state is empty; the result is the same
+ *  as the C version on the whole row.
+ */
+#define B10_UNPACK_SHUF 0, 1, 1, 2, 2, 3, 3, 4,  5, 6, 6, 7, 7, 8, 8, 9
+#define B10_UNPACK_MUL  64, 16, 4, 1, 64, 16, 4, 1
+#define B10_PACK_SHUF   0, 1, 2, 3, 4, 8, 9,10,11,12, -1,-1,-1,-1,-1,-1
+
+/**
+ *  10 bytes at @p -> 8 samples
+ */
+static inline __m128i b10_unpack8(uint8_t *p)
+{
+    const __m128i shuf = _mm_setr_epi8(B10_UNPACK_SHUF);
+    const __m128i mul  = _mm_setr_epi16(B10_UNPACK_MUL);
+    __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)p), shuf);
+    return _mm_srli_epi16(_mm_mullo_epi16(a, mul), 6);
+}
+
+/**
+ *  8 samples -> 10 bytes at the low end
+ */
+static inline __m128i b10_pack8(__m128i a)
+{
+    const __m128i mask = _mm_set1_epi16(0x3ff);
+    const __m128i madd = _mm_setr_epi16(1, 1<<10, 1, 1<<10, 1, 1<<10, 1, 1<<10);
+    const __m128i lo32 = _mm_set_epi32(0, -1, 0, -1);
+    const __m128i shuf = _mm_setr_epi8(B10_PACK_SHUF);
+    
+    a = _mm_madd_epi16(_mm_and_si128(a, mask), madd);          // 20 bits per dword
+    a = _mm_or_si128(_mm_and_si128(a, lo32), 
+                     _mm_slli_epi64(_mm_srli_epi64(a, 32), 20)); // 40 bits per qword
+    return _mm_shuffle_epi8(a, shuf);
+}
+
+/**
+ *  12-bit lte stream: 8 samples take 12 bytes, sample 2k in bytes 3k,3k+1
+ *  at bit 0, sample 2k+1 in bytes 3k+1,3k+2 at bit 4
+ */
+#define B12_UNPACK_SHUF 0, 1, 1, 2, 3, 4, 4, 5,  6, 7, 7, 8, 9,10,10,11
+#define B12_UNPACK_MUL  16, 1, 16, 1, 16, 1, 16, 1
+#define B12_PACK_SHUF   0, 1, 2, 4, 5, 6, 8, 9,10,12,13,14, -1,-1,-1,-1
+
+/**
+ *  12 bytes at @p -> 8 samples
+ */
+static inline __m128i b12_unpack8(uint8_t *p)
+{
+    const __m128i shuf = _mm_setr_epi8(B12_UNPACK_SHUF);
+    const __m128i mul  = _mm_setr_epi16(B12_UNPACK_MUL);
+    __m128i a = _mm_shuffle_epi8(_mm_loadu_si128((__m128i*)p), shuf);
+    return _mm_srli_epi16(_mm_mullo_epi16(a, mul), 4);
+}
+
+/**
+ *  8 samples -> 12 bytes at the low end
+ */
+static inline __m128i b12_pack8(__m128i a)
+{
+    const __m128i mask = _mm_set1_epi16(0xfff);
+    const __m128i madd = _mm_setr_epi16(1, 1<<12, 1, 1<<12, 1, 1<<12, 1, 1<<12);
+    const __m128i shuf = _mm_setr_epi8(B12_PACK_SHUF);
+    
+    a = _mm_madd_epi16(_mm_and_si128(a, mask), madd);          // 24 bits per dword
+    return _mm_shuffle_epi8(a, shuf);
+}
+
+static void bn_unpack_ssse3(void *bn, int n_byte, void *b16, int n16, int nbit)
+{
+    uint8_t  *pn  = (uint8_t  *)bn;
+    uint16_t *p16 = (uint16_t *)b16;
+    int x = 0, off = 0;
+    
+    /**
+     *  the second load reads 16 bytes from @off+10 (@off+12)
+     */
+    if (nbit == 10) {
+        for (; x+16<=n16 && off+26<=n_byte; x+=16, off+=20) {
+            _mm_storeu_si128((__m128i*)(p16 + x    ), b10_unpack8(pn + off     ));
+            _mm_storeu_si128((__m128i*)(p16 + x + 8), b10_unpack8(pn + off + 10));
+        }
+    } else if (nbit == 12) {
+        for (; x+16<=n16 && off+28<=n_byte; x+=16, off+=24) {
+            _mm_storeu_si128((__m128i*)(p16 + x    ), b12_unpack8(pn + off     ));
+            _mm_storeu_si128((__m128i*)(p16 + x + 8), b12_unpack8(pn + off + 12));
+        }
+    }
+    bn_linear_unpack_lte(pn + off, n_byte - off, p16 + x, n16 - x, nbit);
+}
+
+/**
+ *  @a, @b: 8 samples each -> 20 bytes at @p
+ */
+static inline void b10_store20(uint8_t *p, __m128i a, __m128i b)
+{
+    uint32_t tail;
+    a = b10_pack8(a);
+    b = b10_pack8(b);
+    _mm_storeu_si128((__m128i*)p, _mm_or_si128(a, _mm_slli_si128(b, 10)));
+    tail = (uint32_t)_mm_cvtsi128_si32(_mm_srli_si128(b, 6));
+    memcpy(p + 16, &tail, 4);
+}
+
+/**
+ *  @a, @b: 8 samples each -> 24 bytes at @p
+ */
+static inline void b12_store24(uint8_t *p, __m128i a, __m128i b)
+{
+    a = b12_pack8(a);
+    b = b12_pack8(b);
+    _mm_storeu_si128((__m128i*)p, _mm_or_si128(a, _mm_slli_si128(b, 12)));
+    _mm_storel_epi64((__m128i*)(p + 16), _mm_srli_si128(b, 4));
+}
+
+static void bn_pack_ssse3(void *bn, int n_byte, void *b16, int n16, int nbit)
+{
+    uint8_t  *pn  = (uint8_t  *)bn;
+    uint16_t *p16 = (uint16_t *)b16;
+    int x = 0, off = 0;
+    
+    if (nbit == 10) {
+        for (; x+16<=n16 && off+20<=n_byte; x+=16, off+=20) {
+            b10_store20(pn + off, _mm_loadu_si128((__m128i*)(p16 + x    )),
+                                  _mm_loadu_si128((__m128i*)(p16 + x + 8)));
+        }
+    } else if (nbit == 12) {
+        for (; x+16<=n16 && off+24<=n_byte; x+=16, off+=24) {
+            b12_store24(pn + off, _mm_loadu_si128((__m128i*)(p16 + x    )),
+                                  _mm_loadu_si128((__m128i*)(p16 + x + 8)));
+        }
+    }
+    bn_linear_pack_lte(pn + off, n_byte - off, p16 + x, n16 - x, nbit);
+}
+
+/**
+ *  3x4 tiles of 16 bytes: raster row y of a tile is samples y, y+4, y+8.
+ *  One pshufb gathers rows 0,1 (rows 2,3) as 16-bit lanes, each shifted
+ *  by 0..6 bits; the multiply + shift aligns them as in b10_unpack8().
+ */
+#define B10T_UNPACK_SHUF01  0, 1,  5, 6, 10,11,  1, 2,  6, 7, 11,12,  -1,-1,-1,-1
+#define B10T_UNPACK_SHUF23  2, 3,  7, 8, 12,13,  3, 4,  8, 9, 13,14,  -1,-1,-1,-1
+#define B10T_UNPACK_MUL01   64, 64, 64, 16, 16, 16, 0, 0
+#define B10T_UNPACK_MUL23    4,  4,  4,  1,  1,  1, 0, 0
+
+/**
+ *  rows a = {r0[0..3], r1[0..3]}, b = {r2[0..3], r3[0..3]} -> samples
+ *  0..7 in tile order; samples 8..11 are column 2
+ */
+#define B10T_PACK_SHUF_A0   0, 1,  8, 9, -1,-1, -1,-1,  2, 3, 10,11, -1,-1, -1,-1
+#define B10T_PACK_SHUF_B0  -1,-1, -1,-1,  0, 1,  8, 9, -1,-1, -1,-1,  2, 3, 10,11
+#define B10T_PACK_SHUF_A1   4, 5, 12,13, -1,-1, -1,-1, -1,-1, -1,-1, -1,-1, -1,-1
+#define B10T_PACK_SHUF_B1  -1,-1, -1,-1,  4, 5, 12,13, -1,-1, -1,-1, -1,-1, -1,-1
+
+#define ROW16(r, s, y)  ((uint16_t*)((uint8_t*)(r) + (y)*(s)))
+
+/**
+ *  8x4 tiles of 48 bytes: the tile is a 12-bit stream in column order,
+ *  so each 12 bytes are columns 2g,2g+1 and a 4x8 transpose gives the
+ *  rows. The last group loads from byte 32 to stay inside the tile.
+ */
+static inline void b12_tile_unpack8x4(uint8_t *t, uint16_t *r, int s)
+{
+    __m128i v0 = b12_unpack8(t);
+    __m128i v1 = b12_unpack8(t + 12);
+    __m128i v2 = b12_unpack8(t + 24);
+    __m128i v3 = _mm_srli_epi16(_mm_mullo_epi16(
+                    _mm_shuffle_epi8(_mm_srli_si128(_mm_loadu_si128((__m128i*)(t + 32)), 4), 
+                                     _mm_setr_epi8(B12_UNPACK_SHUF)),
+                    _mm_setr_epi16(B12_UNPACK_MUL)), 4);
+    __m128i a0 = _mm_unpacklo_epi16(v0, v1);    // c0 c2 of rows 0..3
+    __m128i a1 = _mm_unpackhi_epi16(v0, v1);    // c1 c3
+    __m128i b0 = _mm_unpacklo_epi16(v2, v3);    // c4 c6
+    __m128i b1 = _mm_unpackhi_epi16(v2, v3);    // c5 c7
+    __m128i lo = _mm_unpacklo_epi16(a0, a1);    // c0..c3 of rows 0,1
+    __m128i hi = _mm_unpackhi_epi16(a0, a1);    // c0..c3 of rows 2,3
+    a0 = _mm_unpacklo_epi16(b0, b1);            // c4..c7 of rows 0,1
+    a1 = _mm_unpackhi_epi16(b0, b1);            // c4..c7 of rows 2,3
+    _mm_storeu_si128((__m128i*)ROW16(r, s, 0), _mm_unpacklo_epi64(lo, a0));
+    _mm_storeu_si128((__m128i*)ROW16(r, s, 1), _mm_unpackhi_epi64(lo, a0));
+    _mm_storeu_si128((__m128i*)ROW16(r, s, 2), _mm_unpacklo_epi64(hi, a1));
+    _mm_storeu_si128((__m128i*)ROW16(r, s, 3), _mm_unpackhi_epi64(hi, a1));
+}
+
+static inline void b12_tile_pack8x4(uint8_t *t, uint16_t *r, int s)
+{
+    __m128i r0 = _mm_loadu_si128((__m128i*)ROW16(r, s, 0));
+    __m128i r1 = _mm_loadu_si128((__m128i*)ROW16(r, s, 1));
+    __m128i r2 = _mm_loadu_si128((__m128i*)ROW16(r, s, 2));
+    __m128i r3 = _mm_loadu_si128((__m128i*)ROW16(r, s, 3));
+    __m128i t0 = _mm_unpacklo_epi16(r0, r1);    // rows 0,1 of c0..c3
+    __m128i t1 = _mm_unpackhi_epi16(r0, r1);    // rows 0,1 of c4..c7
+    __m128i t2 = _mm_unpacklo_epi16(r2, r3);    // rows 2,3 of c0..c3
+    __m128i t3 = _mm_unpackhi_epi16(r2, r3);    // rows 2,3 of c4..c7
+    __m128i p0 = b12_pack8(_mm_unpacklo_epi32(t0, t2));
+    __m128i p1 = b12_pack8(_mm_unpackhi_epi32(t0, t2));
+    __m128i p2 = b12_pack8(_mm_unpacklo_epi32(t1, t3));
+    __m128i p3 = b12_pack8(_mm_unpackhi_epi32(t1, t3));
+    _mm_storeu_si128((__m128i*)(t     ), _mm_or_si128(p0, _mm_slli_si128(p1, 12)));
+    _mm_storeu_si128((__m128i*)(t + 16), _mm_or_si128(_mm_srli_si128(p1, 4), _mm_slli_si128(p2, 8)));
+    _mm_storeu_si128((__m128i*)(t + 32), _mm_or_si128(_mm_srli_si128(p2, 8), _mm_slli_si128(p3, 4)));
+}
+
+/**
+ *  the 3x4 vector tiles store (load) 4 samples per row, one past the tile;
+ *  the next tile rewrites (owns) it, so they stop a tile before the end
+ *  of a row that has no room
+ */
+static void bn_tile_unpack_ssse3(uint8_t *t, int tw, int th, int tsz, 
+                                 uint16_t *r, int w, int h, int s, int nbit)
+{
+    const __m128i shuf01 = _mm_setr_epi8(B10T_UNPACK_SHUF01);
+    const __m128i shuf23 = _mm_setr_epi8(B10T_UNPACK_SHUF23);
+    const __m128i mul01  = _mm_setr_epi16(B10T_UNPACK_MUL01);
+    const __m128i mul23  = _mm_setr_epi16(B10T_UNPACK_MUL23);
+    int x = 0;
+    
+    if (nbit == 10 && tw == 3 && th == 4 && tsz == 16 && h == 4) {
+        for (; x+4<=w; x+=3, t+=16) {
+            __m128i a = _mm_loadu_si128((__m128i*)t);
+            __m128i b = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(a, shuf23), mul23), 6);
+            a = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(a, shuf01), mul01), 6);
+            _mm_storel_epi64((__m128i*)(ROW16(r, s, 0) + x), a);
+            _mm_storel_epi64((__m128i*)(ROW16(r, s, 1) + x), _mm_srli_si128(a, 6));
+            _mm_storel_epi64((__m128i*)(ROW16(r, s, 2) + x), b);
+            _mm_storel_epi64((__m128i*)(ROW16(r, s, 3) + x), _mm_srli_si128(b, 6));
+        }
+    } else if (nbit == 12 && tw == 8 && th == 4 && tsz == 48 && h == 4) {
+        for (; x+8<=w; x+=8, t+=48) {
+            b12_tile_unpack8x4(t, r + x, s);
+        }
+    }
+    bn_tile_row_unpack(t, tw, th, tsz, r + x, w - x, h, s, nbit);
+}
+
+static void bn_tile_pack_ssse3(uint8_t *t, int tw, int th, int tsz, 
+                               uint16_t *r, int w, int h, int s, int nbit)
+{
+    const __m128i shuf_a0 = _mm_setr_epi8(B10T_PACK_SHUF_A0);
+    const __m128i shuf_b0 = _mm_setr_epi8(B10T_PACK_SHUF_B0);
+    const __m128i shuf_a1 = _mm_setr_epi8(B10T_PACK_SHUF_A1);
+    const __m128i shuf_b1 = _mm_setr_epi8(B10T_PACK_SHUF_B1);
+    int x = 0;
+    
+    if (nbit == 10 && tw == 3 && th == 4 && tsz == 16 && h == 4) {
+        for (; x+4<=w; x+=3, t+=16) {
+            __m128i a = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)(ROW16(r, s, 0) + x)),
+                                           _mm_loadl_epi64((__m128i*)(ROW16(r, s, 1) + x)));
+            __m128i b = _mm_unpacklo_epi64(_mm_loadl_epi64((__m128i*)(ROW16(r, s, 2) + x)),
+                                           _mm_loadl_epi64((__m128i*)(ROW16(r, s, 3) + x)));
+            __m128i c0 = _mm_or_si128(_mm_shuffle_epi8(a, shuf_a0), _mm_shuffle_epi8(b, shuf_b0));
+            __m128i c1 = _mm_or_si128(_mm_shuffle_epi8(a, shuf_a1), _mm_shuffle_epi8(b, shuf_b1));
+            
+            /**
+             *  15 bytes of samples, the 16th packs zero lanes
+             */
+            _mm_storeu_si128((__m128i*)t, 
+                _mm_or_si128(b10_pack8(c0), _mm_slli_si128(b10_pack8(c1), 10)));
+        }
+    } else if (nbit == 12 && tw == 8 && th == 4 && tsz == 48 && h == 4) {
+        for (; x+8<=w; x+=8, t+=48) {
+            b12_tile_pack8x4(t, r + x, s);
+        }
+    }
+    bn_tile_row_pack(t, tw, th, tsz, r + x, w - x, h, s, nbit);
+}
+
+/**
+ *  pshufb mask of yuv_kern_t.b8_shuf4/b16_shuf4 for samples of @nbyte
+ */
+static inline __m128i shuf4_mask(const uint8_t perm[4], int nbyte)
+{
+    uint8_t m[16];
+    int j, s;
+    for (j=0; j<16; ++j) {
+        s    = j / nbyte;
+        m[j] = (uint8_t)(((s & ~3) + perm[s & 3]) * nbyte + j % nbyte);
+    }
+    return _mm_loadu_si128((__m128i*)m);
+}
+
+static void b8_shuf4_ssse3(uint8_t *dst, uint8_t *src, int n, const uint8_t perm[4])
+{
+    __m128i shuf = shuf4_mask(perm, 1);
+    int x = 0;
+    
+    for (; x+16<=n; x+=16) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_shuffle_epi8(a, shuf));
+    }
+    for (; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+static void b16_shuf4_ssse3(uint16_t *dst, uint16_t *src, int n, const uint8_t perm[4])
+{
+    __m128i shuf = shuf4_mask(perm, 2);
+    int x = 0;
+    
+    for (; x+8<=n; x+=8) {
+        __m128i a = _mm_loadu_si128((__m128i*)(src + x));
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_shuffle_epi8(a, shuf));
+    }
+    for (; x<n; ++x) {
+        dst[x] = src[(x & ~3) + perm[x & 3]];
+    }
+}
+
+/**
+ *  v210, 16 bytes per block: each sample is the 16-bit lane of its 2 bytes
+ *  shifted by 0, 2 or 4 bits (word bit 0, 10, 20), aligned by the multiply
+ *  as in b10_unpack8(). One pshufb gathers 6 luma, one the 3 u and 3 v.
+ */
+#define V210_UNPACK_SHUF_Y   1, 2,  4, 5,  6, 7,  9,10, 12,13, 14,15, -1,-1, -1,-1
+#define V210_UNPACK_MUL_Y   16, 64,  4, 16, 64,  4,  0,  0
+#define V210_UNPACK_SHUF_UV  0, 1,  5, 6, 10,11, -1,-1,  2, 3,  8, 9, 13,14, -1,-1
+#define V210_UNPACK_MUL_UV  64, 16,  4,  0,  4, 64, 16,  0
+
+/**
+ *  y = {y0..y5}, uv = {u0..u2, -, v0..v2, -} -> samples at bit 0 (a), 
+ *  10 (b), 20 (c) of the 4 words, as zero-extended dwords
+ */
+#define V210_PACK_SHUF_AY   -1,-1,-1,-1,  2, 3,-1,-1, -1,-1,-1,-1,  8, 9,-1,-1
+#define V210_PACK_SHUF_AUV   0, 1,-1,-1, -1,-1,-1,-1, 10,11,-1,-1, -1,-1,-1,-1
+#define V210_PACK_SHUF_BY    0, 1,-1,-1, -1,-1,-1,-1,  6, 7,-1,-1, -1,-1,-1,-1
+#define V210_PACK_SHUF_BUV  -1,-1,-1,-1,  2, 3,-1,-1, -1,-1,-1,-1, 12,13,-1,-1
+#define V210_PACK_SHUF_CY   -1,-1,-1,-1,  4, 5,-1,-1, -1,-1,-1,-1, 10,11,-1,-1
+#define V210_PACK_SHUF_CUV   8, 9,-1,-1, -1,-1,-1,-1,  4, 5,-1,-1, -1,-1,-1,-1
+
+/**
+ *  a block stores (loads) 8 luma and 4 u, v samples, 2 and 1 past it; 
+ *  the next block rewrites (owns) them, so the loops stop where a row has
+ *  no room and leave the rest to the C version
+ */
+static void v210_unpack_ssse3(uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w)
+{
+    const __m128i shuf_y  = _mm_setr_epi8(V210_UNPACK_SHUF_Y);
+    const __m128i shuf_uv = _mm_setr_epi8(V210_UNPACK_SHUF_UV);
+    const __m128i mul_y   = _mm_setr_epi16(V210_UNPACK_MUL_Y);
+    const __m128i mul_uv  = _mm_setr_epi16(V210_UNPACK_MUL_UV);
+    int x = 0;
+    
+    for (; x+8<=w; x+=6, p+=16) {
+        __m128i a  = _mm_loadu_si128((__m128i*)p);
+        __m128i uv = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(a, shuf_uv), mul_uv), 6);
+        a = _mm_srli_epi16(_mm_mullo_epi16(_mm_shuffle_epi8(a, shuf_y), mul_y), 6);
+        _mm_storeu_si128((__m128i*)(y + x),   a);
+        _mm_storel_epi64((__m128i*)(u + x/2), uv);
+        _mm_storel_epi64((__m128i*)(v + x/2), _mm_srli_si128(uv, 8));
+    }
+    v210_row_unpack(p, y + x, u + x/2, v + x/2, w - x);
+}
+
+static void v210_pack_ssse3(uint8_t *p, uint16_t *y, uint16_t *u, uint16_t *v, int w)
+{
+    const __m128i mask    = _mm_set1_epi16(0x3ff);
+    const __m128i shuf_ay = _mm_setr_epi8(V210_PACK_SHUF_AY);
+    const __m128i shuf_au = _mm_setr_epi8(V210_PACK_SHUF_AUV);
+    const __m128i shuf_by = _mm_setr_epi8(V210_PACK_SHUF_BY);
+    const __m128i shuf_bu = _mm_setr_epi8(V210_PACK_SHUF_BUV);
+    const __m128i shuf_cy = _mm_setr_epi8(V210_PACK_SHUF_CY);
+    const __m128i shuf_cu = _mm_setr_epi8(V210_PACK_SHUF_CUV);
+    int x = 0;
+    
+    for (; x+8<=w; x+=6, p+=16) {
+        __m128i ly = _mm_and_si128(_mm_loadu_si128((__m128i*)(y + x)), mask);
+        __m128i uv = _mm_and_si128(_mm_unpacklo_epi64(
+                        _mm_loadl_epi64((__m128i*)(u + x/2)),
+                        _mm_loadl_epi64((__m128i*)(v + x/2))), mask);
+        __m128i a  = _mm_or_si128(_mm_shuffle_epi8(ly, shuf_ay), _mm_shuffle_epi8(uv, shuf_au));
+        __m128i b  = _mm_or_si128(_mm_shuffle_epi8(ly, shuf_by), _mm_shuffle_epi8(uv, shuf_bu));
+        __m128i c  = _mm_or_si128(_mm_shuffle_epi8(ly, shuf_cy), _mm_shuffle_epi8(uv, shuf_cu));
+        a = _mm_or_si128(a, _mm_or_si128(_mm_slli_epi32(b, 10), _mm_slli_epi32(c, 20)));
+        _mm_storeu_si128((__m128i*)p, a);
+    }
+    v210_row_pack(p, y + x, u + x/2, v + x/2, w - x);
+}
+
+void yuv_kern_set_ssse3(yuv_kern_t *k)
+{
+    k->b8_shuf4   = b8_shuf4_ssse3;
+    k->b16_shuf4  = b16_shuf4_ssse3;
+    
+    k->bn_unpack  = bn_unpack_ssse3;
+    k->bn_pack    = bn_pack_ssse3;
+    
+    k->bn_tile_unpack = bn_tile_unpack_ssse3;
+    k->bn_tile_pack   = bn_tile_pack_ssse3;
+    
+    k->v210_unpack = v210_unpack_ssse3;
+    k->v210_pack   = v210_pack_ssse3;
+}
+
+#endif
@@ -0,0 +1,221 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+/**
+ *  @file yuvthr.c
+ *  @brief Worker pool for running one frame's stage in parallel bands,
+ *      and the queues between the threads of the frame pipeline.
+ */
+
+#include <assert.h>
+#include <errno.h>
+#include <string.h>
+#include <malloc.h>
+#include <stdio.h>
+
+#include "yuvdef.h"
+#include "yuvthr.h"
+
+
+/**
+ *  take jobs until none is left. Called and returns with pool->mutex held.
+ */
+static void thr_pool_work(thr_pool_t *pool)
+{
+    while (pool->next_job < pool->n_job) 
+    {
+        int job = pool->next_job++;
+        
+        pthread_mutex_unlock(&pool->mutex);
+        pool->fp(pool->arg, job);
+        pthread_mutex_lock(&pool->mutex);
+        
+        if (++pool->n_done == pool->n_job) {
+            pthread_cond_broadcast(&pool->cond_done);
+        }
+    }
+}
+
+static void *thr_worker(void *arg)
+{
+    thr_pool_t *pool = (thr_pool_t *)arg;
+    unsigned    gen;
+    
+    pthread_mutex_lock(&pool->mutex);
+    gen = pool->gen;
+    while (1) 
+    {
+        while (!pool->b_exit && pool->gen == gen) {
+            pthread_cond_wait(&pool->cond_job, &pool->mutex);
+        }
+        if (pool->b_exit) {
+            break;
+        }
+        gen = pool->gen;
+        thr_pool_work(pool);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    
+    return 0;
+}
+
+/**
+ *  @param [in] n_thread total threads, the caller included
+ *  @return 0 on success. On failure the pool is left single-threaded.
+ */
+int thr_pool_init(thr_pool_t *pool, int n_thread)
+{
+    int i;
+    
+    memset(pool, 0, sizeof(thr_pool_t));
+    pool->n_thread = 1;
+    if (n_thread <= 1) {
+        return 0;
+    }
+    
+    pool->tid = (pthread_t *)malloc(sizeof(pthread_t) * (n_thread - 1));
+    if (!pool->tid) {
+        xerr("@thr>> malloc for %d threads failed\n", n_thread);
+        return -1;
+    }
+    pthread_mutex_init(&pool->mutex, 0);
+    pthread_cond_init (&pool->cond_job, 0);
+    pthread_cond_init (&pool->cond_done, 0);
+    
+    for (i=0; i<n_thread-1; ++i) {
+        if (pthread_create(&pool->tid[i], 0, thr_worker, pool)) {
+            xerr("@thr>> pthread_create() failed at #%d\n", i);
+            break;
+        }
+        pool->n_thread++;
+    }
+    
+    return (pool->n_thread == n_thread) ? 0 : -1;
+}
+
+/**
+ *  run fp(arg, job) for every job in [0, n_job), and return when all done
+ */
+void thr_pool_run(thr_pool_t *pool, thr_job_fp fp, void *arg, int n_job)
+{
+    int job;
+    
+    if (pool->n_thread <= 1 || n_job <= 1) {
+        for (job=0; job<n_job; ++job) {
+            fp(arg, job);
+        }
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->fp        = fp;
+    pool->arg       = arg;
+    pool->n_job     = n_job;
+    pool->next_job  = 0;
+    pool->n_done    = 0;
+    pool->gen++;
+    pthread_cond_broadcast(&pool->cond_job);
+    
+    thr_pool_work(pool);
+    while (pool->n_done < pool->n_job) {
+        pthread_cond_wait(&pool->cond_done, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+void thr_pool_free(thr_pool_t *pool)
+{
+    int i;
+    
+    if (!pool->tid) {
+        return;
+    }
+    
+    pthread_mutex_lock(&pool->mutex);
+    pool->b_exit = 1;
+    pthread_cond_broadcast(&pool->cond_job);
+    pthread_mutex_unlock(&pool->mutex);
+    
+    for (i=0; i<pool->n_thread-1; ++i) {
+        pthread_join(pool->tid[i], 0);
+    }
+    pthread_cond_destroy (&pool->cond_done);
+    pthread_cond_destroy (&pool->cond_job);
+    pthread_mutex_destroy(&pool->mutex);
+    free(pool->tid);
+    
+    pool->tid      = 0;
+    pool->n_thread = 1;
+}
+
+/**
+ *  @param [in] size capacity, rounded up to a power of 2
+ */
+int spsc_init(spsc_queue_t *q, unsigned size)
+{
+    memset(q, 0, sizeof(spsc_queue_t));
+    
+    q->size = 1;
+    while (q->size < size) {
+        q->size <<= 1;
+    }
+    q->item = (void **)malloc(sizeof(void *) * q->size);
+    if (!q->item) {
+        xerr("@thr>> malloc for queue of %d failed\n", q->size);
+        return -1;
+    }
+    sem_init(&q->sem, 0, 0);
+    
+    return 0;
+}
+
+void spsc_push(spsc_queue_t *q, void *item)
+{
+    unsigned tail = q->tail;
+    
+    assert(tail - __atomic_load_n(&q->head, __ATOMIC_ACQUIRE) < q->size);
+    
+    q->item[tail & (q->size - 1)] = item;
+    __atomic_store_n(&q->tail, tail + 1, __ATOMIC_RELEASE);
+    sem_post(&q->sem);
+}
+
+/**
+ *  @return the oldest item, blocking while the queue is empty
+ */
+void *spsc_pop(spsc_queue_t *q)
+{
+    unsigned head = q->head;
+    void    *item;
+    
+    while (sem_wait(&q->sem) && errno == EINTR) {
+    }
+    assert(head != __atomic_load_n(&q->tail, __ATOMIC_ACQUIRE));
+    
+    item = q->item[head & (q->size - 1)];
+    __atomic_store_n(&q->head, head + 1, __ATOMIC_RELEASE);
+    
+    return item;
+}
+
+void spsc_free(spsc_queue_t *q)
+{
+    if (q->item) {
+        sem_destroy(&q->sem);
+        free(q->item);
+        q->item = 0;
+    }
+}
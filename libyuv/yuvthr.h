@@ -0,0 +1,73 @@
+/*****************************************************************************
+ * Copyright 2014 Jeff <ggjogh@gmail.com>
+ *****************************************************************************
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+*****************************************************************************/
+
+#ifndef __YUVTHR_H__
+#define __YUVTHR_H__
+
+#include <pthread.h>
+#include <semaphore.h>
+
+typedef void (*thr_job_fp)(void *arg, int job);
+
+/**
+ *  fixed set of worker threads running jobs [0, n_job) of one call at a
+ *  time. The calling thread takes jobs as well, so a pool of n_thread
+ *  spawns (n_thread - 1) workers.
+ */
+typedef struct _thr_pool
+{
+    int             n_thread;
+    pthread_t      *tid;
+    pthread_mutex_t mutex;
+    pthread_cond_t  cond_job;
+    pthread_cond_t  cond_done;
+    
+    int             b_exit;
+    unsigned        gen;        //!< bumped for every thr_pool_run()
+    thr_job_fp      fp;
+    void           *arg;
+    int             n_job;
+    int             next_job;
+    int             n_done;
+    
+} thr_pool_t;
+
+int  thr_pool_init(thr_pool_t *pool, int n_thread);
+void thr_pool_run (thr_pool_t *pool, thr_job_fp fp, void *arg, int n_job);
+void thr_pool_free(thr_pool_t *pool);
+
+/**
+ *  single-producer/single-consumer ring of pointers. head and tail are
+ *  only advanced by their own side, the semaphore just parks an empty
+ *  consumer. The producer must never hold more than @size items in it.
+ */
+typedef struct _spsc_queue
+{
+    void          **item;
+    unsigned        size;       //!< power of 2
+    unsigned        head;       //!< written by the consumer only
+    unsigned        tail;       //!< written by the producer only
+    sem_t           sem;        //!< items available
+    
+} spsc_queue_t;
+
+int   spsc_init(spsc_queue_t *q, unsigned size);
+void  spsc_push(spsc_queue_t *q, void *item);
+void *spsc_pop (spsc_queue_t *q);
+void  spsc_free(spsc_queue_t *q);
+
+
+#endif  // __YUVTHR_H__